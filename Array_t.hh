@@ -59,6 +59,8 @@ public:
   void set_all( const T t );
 
   bool insert( const unsigned i, const T t );
+  bool insert( const unsigned i, const unsigned n, const T t );
+  bool insert( const unsigned i, const Array_t& a );
   bool push( const T t );
 
   bool pop( T& t ) { return 0<v.size() ? remove( v.size()-1, t ) : false; }
@@ -191,6 +193,30 @@ bool Array_t<T>::insert( const unsigned i, const T t )
   return false;
 }
 
+// Insert n copies of t at i
+template <class T>
+bool Array_t<T>::insert( const unsigned i, const unsigned n, const T t )
+{
+  if( i<=v.size() )
+  {
+    v.insert( v.begin() + i, n, t );
+    return true;
+  }
+  return false;
+}
+
+// Insert all of a at i
+template <class T>
+bool Array_t<T>::insert( const unsigned i, const Array_t& a )
+{
+  if( i<=v.size() && this != &a )
+  {
+    v.insert( v.begin() + i, a.v.begin(), a.v.end() );
+    return true;
+  }
+  return false;
+}
+
 template <class T>
 bool Array_t<T>::push( const T t )
 {
@@ -223,12 +249,10 @@ bool Array_t<T>::remove( const unsigned i, T& t )
 template <class T>
 bool Array_t<T>::remove_n( const unsigned i, const unsigned num )
 {
-  if( i+num<v.size() )
+  if( i+num<=v.size() )
   {
-    for( unsigned k=0; k<i; k++ )
-    {
-      v.erase( v.begin() + i );
-    }
+    v.erase( v.begin() + i, v.begin() + i + num );
+
     return true;
   }
   return false;
@@ -73,6 +73,7 @@ void ChangeHist::Undo( View& rV )
       else if( ct ==  Insert_Text ) Undo_InsertChar_Diff( plc, rV );
       else if( ct ==  Remove_Text ) Undo_RemoveChar_Diff( plc, rV );
       else if( ct == Replace_Text ) Undo_Set_Diff       ( plc, rV );
+      else if( ct == Insert_Block ) Undo_InsertBlock_Diff( plc, rV );
       else {
       }
     }
@@ -82,6 +83,7 @@ void ChangeHist::Undo( View& rV )
       else if( ct ==  Insert_Text ) Undo_InsertChar( plc, rV );
       else if( ct ==  Remove_Text ) Undo_RemoveChar( plc, rV );
       else if( ct == Replace_Text ) Undo_Set       ( plc, rV );
+      else if( ct == Insert_Block ) Undo_InsertBlock( plc, rV );
     }
     m_vis.ReturnLineChange( plc );
   }
@@ -207,6 +209,19 @@ void ChangeHist::Save_SwapLines( const unsigned l_num_1
 {
 }
 
+void ChangeHist::Save_InsertBlock( const unsigned l_num
+                                 , const unsigned c_pos
+                                 , const Line&    text )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  LineChange* lc = m_vis.BorrowLineChange( Insert_Block, l_num, c_pos );
+
+  lc->line.copy( text );
+
+  changes.push( lc );
+}
+
 void ChangeHist::Undo_Set( LineChange* plc, View& rV )
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -287,6 +302,36 @@ void ChangeHist::Undo_RemoveChar( LineChange* plc, View& rV )
   m_fb.Update();
 }
 
+// Returns the position just past the end of the text of an Insert_Block
+CrsPos InsertBlock_End( const LineChange* plc )
+{
+  CrsPos end = { plc->lnum, plc->cpos };
+
+  const unsigned LEN = plc->line.len();
+
+  for( unsigned k=0; k<LEN; k++ )
+  {
+    if( '\n' == plc->line.get(k) ) { end.crsLine++; end.crsChar = 0; }
+    else                              end.crsChar++;
+  }
+  return end;
+}
+
+void ChangeHist::Undo_InsertBlock( LineChange* plc, View& rV )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const CrsPos st  = { plc->lnum, plc->cpos };
+  const CrsPos end = InsertBlock_End( plc );
+
+  // Undo inserted block by removing the whole block at once
+  m_fb.RemoveText( st, end );
+
+  rV.GoToCrsPos_NoWrite( plc->lnum, plc->cpos );
+
+  m_fb.Update();
+}
+
 void ChangeHist::Undo_Set_Diff( LineChange* plc, View& rV )
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -395,3 +440,41 @@ void ChangeHist::Undo_RemoveChar_Diff( LineChange* plc, View& rV )
   if( !rDiff.ReDiff() ) rDiff.Update();
 }
 
+void ChangeHist::Undo_InsertBlock_Diff( LineChange* plc, View& rV )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const CrsPos   end     = InsertBlock_End( plc );
+  const unsigned NUM_REM = end.crsLine - plc->lnum;
+
+  Diff& rDiff = m_vis.GetDiff();
+
+  // Save the text following the block on its last line:
+  const Line& last = m_fb.GetLine( end.crsLine );
+  Line tail;
+  for( unsigned k=end.crsChar; k<last.len(); k++ ) tail.push( last.get(k) );
+
+  // Remove the inserted lines one at a time, so the diff can follow along:
+  for( unsigned k=0; k<NUM_REM; k++ )
+  {
+    m_fb.RemoveLine( plc->lnum+1 );
+
+    const unsigned NUM_LINES = m_fb.NumLines();
+    const unsigned LINE_NUM  = plc->lnum+1 < NUM_LINES ? plc->lnum+1 : NUM_LINES-1;
+
+    rDiff.Patch_Diff_Info_Deleted( &rV, rDiff.DiffLine( &rV, LINE_NUM ) );
+  }
+  // Replace the block on the first line with the saved tail:
+  const CrsPos st = { plc->lnum, plc->cpos };
+  const CrsPos fn = { plc->lnum, m_fb.LineLen( plc->lnum ) };
+  m_fb.RemoveText( st, fn );
+  m_fb.AppendLineToLine( plc->lnum, tail );
+
+  const int DL = rDiff.DiffLine( &rV, plc->lnum );
+  rDiff.Patch_Diff_Info_Changed( &rV, DL );
+
+  rDiff.GoToCrsPos_NoWrite( DL, plc->cpos );
+
+  if( !rDiff.ReDiff() ) rDiff.Update();
+}
+
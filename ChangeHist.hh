@@ -73,18 +73,23 @@ public:
                       , const uint8_t  old_C );
   void Save_SwapLines( const unsigned l_num_1
                      , const unsigned l_num_2 );
+  void Save_InsertBlock( const unsigned l_num
+                       , const unsigned c_pos
+                       , const Line&    text );
 private:
   void Undo_InsertLine( LineChange* plc, View& rV );
   void Undo_RemoveLine( LineChange* plc, View& rV );
   void Undo_InsertChar( LineChange* plc, View& rV );
   void Undo_RemoveChar( LineChange* plc, View& rV );
   void Undo_Set       ( LineChange* plc, View& rV );
+  void Undo_InsertBlock( LineChange* plc, View& rV );
 
   void Undo_InsertLine_Diff( LineChange* plc, View& rV );
   void Undo_RemoveLine_Diff( LineChange* plc, View& rV );
   void Undo_InsertChar_Diff( LineChange* plc, View& rV );
   void Undo_RemoveChar_Diff( LineChange* plc, View& rV );
   void Undo_Set_Diff       ( LineChange* plc, View& rV );
+  void Undo_InsertBlock_Diff( LineChange* plc, View& rV );
 
   LineChange* BorrowLineChange( const ChangeType type
                               , const unsigned   lnum
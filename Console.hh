@@ -53,6 +53,8 @@ public:
   static unsigned Num_Cols();
 
   static char KeyIn();
+  static bool In_Paste();
+  static void Get_Paste( Line& text );
 
   static void Set_Normal();
   static void NewLine();
@@ -24,9 +24,12 @@
 #include <errno.h>
 #include <stdio.h>     // memcpy, memset
 #include <string.h>    // memcpy, memset
-#include <unistd.h>    // write, ioctl[unix], read
+#include <unistd.h>    // write, ioctl[unix], read, pipe
+#include <fcntl.h>     // fcntl
+#include <poll.h>      // poll
 #include <signal.h>
 #include <stdarg.h>    // va_list, va_start, va_end
+#include <stdint.h>    // uint64_t
 #include <sys/ioctl.h> // ioctl
 
 #include <termios.h>  // struct termios
@@ -36,10 +39,14 @@
 #include "Vis.hh"
 #include "View.hh"
 #include "Console.hh"
+#include "Shell.hh"
+#include "Perf.hh"
+#include "Highlight_Base.hh"
 
 extern MemLog<MEM_LOG_BUF_SIZE> Log;
 
 static termios m_origTTyState;
+static int     m_winch_fd[2] = { -1, -1 }; // SIGWINCH handler writes to [1]
 
 unsigned gl_bytes_out = 0;
 
@@ -103,15 +110,25 @@ const char* const STR_BG_BB_CYAN    = "\E[46;1m";
 const char* const STR_BG_BB_WHITE   = "\E[47;1m";
 const char* const STR_BG_BB_DEFAULT = "\E[49;1m";
 
+const char* const STR_SCROLL_REGION = "\E[%u;%ur"; // "\E[t;br" scroll only rows t to b
+const char* const STR_SCROLL_RESET  = "\E[r";      // Scroll entire screen, and move cursor home
+const char* const STR_INSERT_LINES  = "\E[%uL";    // Insert lines at cursor row, inside scroll region
+const char* const STR_DELETE_LINES  = "\E[%uM";    // Delete lines at cursor row, inside scroll region
+
 const char* const STR_SCREEN_SAVE    = "\E[?47h";
 const char* const STR_SCREEN_RESTORE = "\E[?47l";
 
+const char* const STR_PASTE_ON  = "\E[?2004h"; // Terminal brackets pasted text with paste_begin and paste_end
+const char* const STR_PASTE_OFF = "\E[?2004l";
+
 const char* const up____arrow = "\E[A";
 const char* const down__arrow = "\E[B";
 const char* const right_arrow = "\E[C";
 const char* const left__arrow = "\E[D";
 const char* const page_up     = "\E[5~";
 const char* const page_down   = "\E[6~";
+const char* const paste_begin = "\E[200~";
+const char* const paste_end   = "\E[201~";
 
 const uint8_t LEN_CLEAR       = strlen( STR_CLEAR );
 const uint8_t LEN_HOME        = strlen( STR_HOME  );
@@ -165,6 +182,11 @@ const uint8_t LEN_BG_BB_WHITE   = strlen( STR_BG_BB_WHITE   );
 const uint8_t LEN_SCREEN_SAVE    = strlen( STR_SCREEN_SAVE );
 const uint8_t LEN_SCREEN_RESTORE = strlen( STR_SCREEN_RESTORE );
 
+const uint8_t LEN_PASTE_ON    = strlen( STR_PASTE_ON  );
+const uint8_t LEN_PASTE_OFF   = strlen( STR_PASTE_OFF );
+const uint8_t LEN_PASTE_BEGIN = strlen( paste_begin );
+const uint8_t LEN_PASTE_END   = strlen( paste_end   );
+
 Color NORMAL_FG = White;     Color RV_NORMAL_FG = Black;
 Color NORMAL_BG = Black;     Color RV_NORMAL_BG = White;
 
@@ -241,12 +263,40 @@ Color DIFF_VISUAL_BG = Red;
 Color DIFF_DELETED_FG = White;
 Color DIFF_DELETED_BG = Red;
 
-static LinesList* lines__p = 0; // list of screen lines  pending to be written.
-static LinesList* lines__w = 0; // list of screen lines  already written.
-static LinesList* styles_p = 0; // list of screen styles pending to be written.
-static LinesList* styles_w = 0; // list of screen styles already written.
-static Line*      touched  = 0; // list of screen lines that have been changed.
-static Line*      out_buf  = 0; // output buffer to reduce number of write calls.
+// Screen cell.  Cells of a row are contiguous, so rows can be
+// compared several cells at a time:
+struct Cell
+{
+  uint8_t C; // char
+  uint8_t S; // style
+};
+typedef Array_t<Cell> CellList;
+
+static CellList* cells_p  = 0; // screen cells pending to be written, row by row.
+static CellList* cells_w  = 0; // screen cells already written, row by row.
+static unsList*  dirty_st = 0; // first changed col of each row.
+static unsList*  dirty_fn = 0; // one past last changed col of each row, 0 if row unchanged.
+static Line*     out_buf  = 0; // output buffer to reduce number of write calls.
+static unsList*  hash_w   = 0; // hash of each written screen line, 0 if unknown.
+static unsList*  hash_p   = 0; // hash of each changed pending screen line.
+static Line*     in_buf   = 0; // input read but not yet returned by KeyIn.
+
+static unsigned in_pos      = 0; // Next byte of in_buf to return
+static unsigned in_paste_st = 0; // First pasted byte of in_buf
+static unsigned in_paste_fn = 0; // One past last pasted byte of in_buf
+
+static unsigned m_crs_row   = ~0; // Terminal cursor row, ~0 if unknown
+static unsigned m_crs_col   = ~0; // Terminal cursor col, ~0 if unknown
+static uint8_t  m_crs_style = S_UNKNOWN; // Style last sent to terminal
+
+// While typed keys are queued, output is held so that the queued commands
+// run back to back, and the screen is drawn once when the queue drains:
+const double FRAME_TIME = 0.016; // seconds, longest time output is held
+
+static bool     m_hold_output = false;
+static double   m_hold_time   = 0;  // Time output started being held
+static unsigned m_hold_row    = ~0; // Cursor row requested while held
+static unsigned m_hold_col    = ~0; // Cursor col requested while held
 
 #if defined( SUNOS )
 uint8_t Byte2out( uint8_t C )
@@ -318,17 +368,45 @@ uint8_t Byte2out( uint8_t C )
 //}
 #endif
 
+// Write out everything held back while input was queued:
+void Release_Output()
+{
+  if( m_hold_output )
+  {
+    m_hold_output = false;
+
+    Console::Update();
+
+    if( m_hold_row < m_num_rows && m_hold_col < m_num_cols )
+    {
+      Console::Move_2_Row_Col( m_hold_row, m_hold_col );
+    }
+    m_hold_row = ~0;
+    m_hold_col = ~0;
+
+    Console::Flush();
+  }
+}
+
 void Screen_Save()
 {
   for( unsigned k=0; k<LEN_SCREEN_SAVE; k++ )
   {
     out_buf->push( STR_SCREEN_SAVE[k] );
   }
+  for( unsigned k=0; k<LEN_PASTE_ON; k++ )
+  {
+    out_buf->push( STR_PASTE_ON[k] );
+  }
   Console::Flush();
 }
 
 void Screen_Restore()
 {
+  for( unsigned k=0; k<LEN_PASTE_OFF; k++ )
+  {
+    out_buf->push( STR_PASTE_OFF[k] );
+  }
   for( unsigned k=0; k<LEN_SCREEN_RESTORE; k++ )
   {
     out_buf->push( STR_SCREEN_RESTORE[k] );
@@ -363,6 +441,78 @@ void Move_2_Home()
   }
 }
 
+void Out_Str( const char* str, const unsigned LEN )
+{
+  for( unsigned k=0; k<LEN; k++ )
+  {
+    out_buf->push( str[k] );
+  }
+}
+
+// Put decimal digits of num into buf, and return number of digits
+unsigned Fmt_Num( char* buf, unsigned num )
+{
+  char tmp[16];
+  unsigned len = 0;
+  do {
+    tmp[len++] = '0' + num%10;
+    num /= 10;
+  } while( num );
+
+  for( unsigned k=0; k<len; k++ ) buf[k] = tmp[len-1-k];
+
+  return len;
+}
+
+// Put "\E[<num><F>" into buf, leaving out num if it is 1,
+// and return length put into buf
+unsigned Fmt_CSI( char* buf, const unsigned num, const char F )
+{
+  unsigned len = 0;
+  buf[len++] = '\E';
+  buf[len++] = '[';
+  if( 1 != num ) len += Fmt_Num( buf+len, num );
+  buf[len++] = F;
+  return len;
+}
+
+// Put into buf the shortest sequence moving the terminal cursor
+// to ROW, COL, and return length put into buf
+unsigned Fmt_Move( char* buf, const unsigned ROW, const unsigned COL )
+{
+  // Absolute move:
+  unsigned len = 0;
+  buf[len++] = '\E';
+  buf[len++] = '[';
+  if( 0 < ROW || 0 < COL ) len += Fmt_Num( buf+len, ROW+1 );
+  if( 0 < COL ) { buf[len++] = ';'; len += Fmt_Num( buf+len, COL+1 ); }
+  buf[len++] = 'H';
+
+  if( m_crs_row < m_num_rows && m_crs_col < m_num_cols )
+  {
+    // Relative move, if shorter:
+    char     rel[32];
+    unsigned rel_len = 0;
+
+    if     ( ROW < m_crs_row ) rel_len += Fmt_CSI( rel+rel_len, m_crs_row-ROW, 'A' );
+    else if( m_crs_row < ROW ) rel_len += Fmt_CSI( rel+rel_len, ROW-m_crs_row, 'B' );
+
+    if( COL < m_crs_col )
+    {
+      if( 0 == COL ) rel[rel_len++] = '\r';
+      else           rel_len += Fmt_CSI( rel+rel_len, m_crs_col-COL, 'D' );
+    }
+    else if( m_crs_col < COL ) rel_len += Fmt_CSI( rel+rel_len, COL-m_crs_col, 'C' );
+
+    if( rel_len < len )
+    {
+      memcpy( buf, rel, rel_len );
+      len = rel_len;
+    }
+  }
+  return len;
+}
+
 int Background_2_Code( const Color BG )
 {
   int code = 49;
@@ -397,19 +547,6 @@ int Foreground_2_Code( const Color FG )
   return code;
 }
 
-void Set_Style( const Color BG, const Color FG, const bool BB )
-{
-  char s[32];
-  const unsigned LEN = sprintf( s, "\E[%i;%i;%im"
-                                 , BB ? 1 : 0
-                                 , Background_2_Code( BG )
-                                 , Foreground_2_Code( FG ) );
-  for( unsigned k=0; k<LEN; k++ )
-  {
-    out_buf->push( s[k] );
-  }
-}
-
 Color Style_2_BG( const uint8_t S )
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -523,6 +660,67 @@ bool Style_2_BB( const uint8_t S )
   return true;
 }
 
+// Terminal codes of each Style, rebuilt when the colors change:
+struct StyleSGR
+{
+  int      bb, bg, fg;
+  char     str[16]; // Escape sequence setting all of bb, bg and fg
+  unsigned len;
+};
+static StyleSGR m_sgr[ S_UNKNOWN ];
+static bool     m_sgr_built = false;
+
+void Build_SGR_Table()
+{
+  for( unsigned S=0; S<S_UNKNOWN; S++ )
+  {
+    StyleSGR& t = m_sgr[S];
+
+    t.bb = Style_2_BB( S ) ? 1 : 0;
+    t.bg = Background_2_Code( Style_2_BG( S ) );
+    t.fg = Foreground_2_Code( Style_2_FG( S ) );
+
+    t.len = 0;
+    t.str[t.len++] = '\E';
+    t.str[t.len++] = '[';
+    t.len += Fmt_Num( t.str+t.len, t.bb ); t.str[t.len++] = ';';
+    t.len += Fmt_Num( t.str+t.len, t.bg ); t.str[t.len++] = ';';
+    t.len += Fmt_Num( t.str+t.len, t.fg ); t.str[t.len++] = 'm';
+  }
+  m_sgr_built = true;
+}
+
+// Change terminal style to S, only sending the parts of S
+// that differ from the current terminal style:
+void Set_Style( const uint8_t S )
+{
+  if( !m_sgr_built ) Build_SGR_Table();
+
+  const StyleSGR& t = m_sgr[S];
+
+  if( S_UNKNOWN == m_crs_style
+   || t.bb != m_sgr[m_crs_style].bb ) // Bold off resets colors
+  {
+    Out_Str( t.str, t.len );
+  }
+  else {
+    const StyleSGR& t_old = m_sgr[m_crs_style];
+
+    char     s[16];
+    unsigned len = 0;
+    s[len++] = '\E';
+    s[len++] = '[';
+    if( t.bg != t_old.bg ) { len += Fmt_Num( s+len, t.bg ); s[len++] = ';'; }
+    if( t.fg != t_old.fg ) { len += Fmt_Num( s+len, t.fg ); s[len++] = ';'; }
+    if( 2 < len )
+    {
+      s[len-1] = 'm'; // Replace last ';' with 'm'
+      Out_Str( s, len );
+    }
+  }
+  m_crs_style = S;
+}
+
 void Reset_tty()
 {
   int err = tcsetattr( STDIN_FILENO, TCSAFLUSH, &m_origTTyState );
@@ -540,6 +738,16 @@ void Sig_Handle_SIGINT( int signo )
   mp_vis->CmdLineMessage("Ignoring SIGINT.  To exit type ':qa'");
 }
 
+// Received when the window is resized.  Wakes up KeyIn():
+void Sig_Handle_SIGWINCH( int )
+{
+  const char C = 0;
+
+  // If the pipe is full, KeyIn() is already woken up, so the result
+  // does not matter:
+  (void)!write( m_winch_fd[1], &C, 1 );
+}
+
 void Sig_Handle_HW( int signo )
 {
   if     ( SIGBUS  == signo ) Log.Log("Received SIGBUS \n");
@@ -556,6 +764,7 @@ void Sig_Handle_HW( int signo )
 
   Trace  ::Cleanup();
   Console::Cleanup();
+  Highlight_Base::Cleanup();
 
   MemClean();
   Log.Dump();
@@ -565,30 +774,35 @@ void Sig_Handle_HW( int signo )
 
 void Console::Allocate()
 {
-  if( 0 == lines__p )
+  if( 0 == cells_p )
   {
-    lines__p = new(__FILE__,__LINE__) LinesList;
-    lines__w = new(__FILE__,__LINE__) LinesList;
-    styles_p = new(__FILE__,__LINE__) LinesList;
-    styles_w = new(__FILE__,__LINE__) LinesList;
-    touched  = new(__FILE__,__LINE__) Line();
+    cells_p  = new(__FILE__,__LINE__) CellList;
+    cells_w  = new(__FILE__,__LINE__) CellList;
+    dirty_st = new(__FILE__,__LINE__) unsList;
+    dirty_fn = new(__FILE__,__LINE__) unsList;
     out_buf  = new(__FILE__,__LINE__) Line( 16385 );
+    hash_w   = new(__FILE__,__LINE__) unsList;
+    hash_p   = new(__FILE__,__LINE__) unsList;
+    in_buf   = new(__FILE__,__LINE__) Line( 1024 );
   }
   Screen_Save();
 }
 
 void Console::Cleanup()
 {
+  Release_Output();
   Screen_Restore();
 
-  if( 0 != lines__p )
+  if( 0 != cells_p )
   {
-    MemMark(__FILE__,__LINE__); delete lines__p; lines__p = 0;
-    MemMark(__FILE__,__LINE__); delete lines__w; lines__w = 0;
-    MemMark(__FILE__,__LINE__); delete styles_p; styles_p = 0;
-    MemMark(__FILE__,__LINE__); delete styles_w; styles_w = 0;
-    MemMark(__FILE__,__LINE__); delete touched ; touched  = 0;
+    MemMark(__FILE__,__LINE__); delete cells_p ; cells_p  = 0;
+    MemMark(__FILE__,__LINE__); delete cells_w ; cells_w  = 0;
+    MemMark(__FILE__,__LINE__); delete dirty_st; dirty_st = 0;
+    MemMark(__FILE__,__LINE__); delete dirty_fn; dirty_fn = 0;
     MemMark(__FILE__,__LINE__); delete out_buf ; out_buf  = 0;
+    MemMark(__FILE__,__LINE__); delete hash_w  ; hash_w   = 0;
+    MemMark(__FILE__,__LINE__); delete hash_p  ; hash_p   = 0;
+    MemMark(__FILE__,__LINE__); delete in_buf  ; in_buf   = 0;
   }
 }
 
@@ -611,7 +825,7 @@ bool Console::Set_tty()
     memcpy( &m_origTTyState, &t, sizeof(t) );
 
     t.c_cc[VMIN ] = 0;
-    t.c_cc[VTIME] = 1;   // reads time out after 100 ms
+    t.c_cc[VTIME] = 0;   // reads return at once, KeyIn() waits in poll()
 
     t.c_lflag &= ~( ICANON | ECHO | ECHONL | PENDIN );
     t.c_lflag |= ECHOK ;
@@ -641,6 +855,13 @@ void Console::SetSignals()
 {
 //signal( SIGCONT, Sig_Handle_SIGCONT );
   signal( SIGINT , Sig_Handle_SIGINT ); // ^C
+  if( 0 == pipe( m_winch_fd ) )
+  {
+    fcntl( m_winch_fd[0], F_SETFL, O_NONBLOCK );
+    fcntl( m_winch_fd[1], F_SETFL, O_NONBLOCK );
+
+    signal( SIGWINCH, Sig_Handle_SIGWINCH );
+  }
   signal( SIGBUS , Sig_Handle_HW );
   signal( SIGIOT , Sig_Handle_HW );
   signal( SIGTRAP, Sig_Handle_HW );
@@ -653,49 +874,277 @@ void Console::SetVis( Vis* p_vis )
   mp_vis = p_vis;
 }
 
+// Returns pointer to first pending cell of row
+Cell* Row_P( const unsigned row )
+{
+  return &(*cells_p)[ row*m_num_cols ];
+}
+
+// Returns pointer to first written cell of row
+Cell* Row_W( const unsigned row )
+{
+  return &(*cells_w)[ row*m_num_cols ];
+}
+
+bool Same_Cell( const Cell& a, const Cell& b )
+{
+  return a.C == b.C && a.S == b.S;
+}
+
+// Returns first col in [col,fn) where pending cell differs from
+// written cell, or fn if there is none.  Unchanged cells are
+// skipped four at a time by comparing them as one 64 bit word.
+unsigned Next_Changed_Col( const Cell* P, const Cell* W
+                         , unsigned col, const unsigned fn )
+{
+  for( ; col+4 <= fn; col += 4 )
+  {
+    uint64_t p4; memcpy( &p4, P+col, sizeof(p4) );
+    uint64_t w4; memcpy( &w4, W+col, sizeof(w4) );
+    if( p4 != w4 ) break;
+  }
+  while( col<fn && Same_Cell( P[col], W[col] ) ) col++;
+
+  return col;
+}
+
+// Mark cols [st,fn) of row as changed
+void Set_Dirty( const unsigned row, const unsigned st, const unsigned fn )
+{
+  if( st < (*dirty_st)[row] ) (*dirty_st)[row] = st;
+  if( (*dirty_fn)[row] < fn ) (*dirty_fn)[row] = fn;
+}
+
+bool Row_Dirty( const unsigned row )
+{
+  return (*dirty_st)[row] < (*dirty_fn)[row];
+}
+
+// Mark all written cells of row as unknown, so the row is re-written
+void Set_Row_Unknown( const unsigned row )
+{
+  Cell* W = Row_W( row );
+
+  for( unsigned col=0; col<m_num_cols; col++ ) W[col].S = S_UNKNOWN;
+
+  (*hash_w)[row] = 0;
+  Set_Dirty( row, 0, m_num_cols );
+}
+
+// Returns a hash of the chars and styles of cells of a row,
+// or 0 if any of the styles are unknown
+unsigned Row_Hash( const Cell* R )
+{
+  unsigned h = 2166136261u;
+
+  for( unsigned col=0; col<m_num_cols; col++ )
+  {
+    if( R[col].S == S_UNKNOWN ) return 0;
+
+    h = ( h ^ R[col].C ) * 16777619u;
+    h = ( h ^ R[col].S ) * 16777619u;
+  }
+  return h ? h : 1;
+}
+
+// Returns number of cells in row that differ between pending and written
+unsigned Row_Changed_Cells( const unsigned row )
+{
+  const Cell* P = Row_P( row );
+  const Cell* W = Row_W( row );
+
+  unsigned changed = 0;
+
+  for( unsigned col=0; col<m_num_cols; col++ )
+  {
+    if( !Same_Cell( P[col], W[col] ) ) changed++;
+  }
+  return changed;
+}
+
+// Shift written rows [top,bot] up by num rows if 0<num, or down by -num
+// rows if num<0, and mark the rows exposed by the shift as unknown.
+void Shift_Written_Rows( const unsigned top, const unsigned bot, const int num )
+{
+  const unsigned N    = 0<num ? num : -num;
+  const unsigned KEEP = bot-top+1-N; // Rows moved
+
+  const unsigned dst = 0<num ? top   : top+N;
+  const unsigned src = 0<num ? top+N : top;
+
+  memmove( Row_W( dst ), Row_W( src ), KEEP*m_num_cols*sizeof(Cell) );
+
+  if( 0<num ) for( unsigned k=0; k<KEEP; k++ ) (*hash_w)[dst+k] = (*hash_w)[src+k];
+  else        for( unsigned k=KEEP; 0<k; k-- ) (*hash_w)[dst+k-1] = (*hash_w)[src+k-1];
+
+  const unsigned exp_st = 0<num ? bot-N+1 : top;
+
+  for( unsigned r=exp_st; r<exp_st+N; r++ ) Set_Row_Unknown( r );
+}
+
+// If a block of pending rows is a block of written rows moved up or
+// down, as happens when scrolling a window, move the block on the
+// terminal by deleting or inserting lines inside a scroll region,
+// instead of re-writing every row of the block.
+void Scroll_Shifted_Rows()
+{
+  // Bottom row is never scrolled, since its last cell is never written:
+  const int N = m_num_rows-1;
+  const int MIN_GAIN = 2; // Fewest re-written rows saved worth scrolling for
+
+  int num_changed = 0;
+  for( int r=0; r<N; r++ )
+  {
+    if( Row_Dirty( r ) )
+    {
+      (*hash_p)[r] = Row_Hash( Row_P( r ) );
+      if( (*hash_p)[r] != (*hash_w)[r] ) num_changed++;
+    }
+    else (*hash_p)[r] = (*hash_w)[r];
+  }
+  if( num_changed < MIN_GAIN ) return;
+
+  const unsigned* HP = &(*hash_p)[0];
+  const unsigned* HW = &(*hash_w)[0];
+
+  int best_d = 0; // Pending row r is written row r+best_d
+  int best_a = 0; // First pending row of moved block
+  int best_b = 0; // Last  pending row of moved block
+  int best_gain = MIN_GAIN-1;
+
+  for( int d=1-N; d<N; d++ )
+  {
+    if( 0 == d ) continue;
+
+    const int END = d<0 ? N : N-d;
+
+    for( int r=( d<0 ? -d : 0 ); r<END; )
+    {
+      if( !HW[r+d] || HP[r] != HW[r+d] ) { r++; continue; }
+
+      const int a = r;
+      int gain = 0;
+      for( ; r<END && HW[r+d] && HP[r] == HW[r+d]; r++ )
+      {
+        if( HP[r] != HW[r] ) gain++;
+      }
+      const int b = r-1;
+
+      if( best_gain < gain )
+      {
+        // Rows exposed by the move will have to be re-written:
+        const int exp_st = 0<d ? b+1 : a+d;
+        const int exp_fn = 0<d ? b+d : a-1;
+        for( int e=exp_st; e<=exp_fn; e++ )
+        {
+          if( HW[e] && HP[e] == HW[e] ) gain--;
+        }
+        if( best_gain < gain )
+        {
+          best_gain = gain;
+          best_d = d; best_a = a; best_b = b;
+        }
+      }
+    }
+  }
+  if( best_d )
+  {
+    const unsigned top = 0<best_d ? best_a : best_a+best_d;
+    const unsigned bot = 0<best_d ? best_b+best_d : best_b;
+    const unsigned num = 0<best_d ? best_d : -best_d;
+
+    // Hashes can collide, so make sure the moved rows really match,
+    // since rows not dirty are not re-written after the move:
+    for( int r=best_a; r<=best_b; r++ )
+    {
+      if( 0 != memcmp( Row_P( r ), Row_W( r+best_d )
+                     , m_num_cols*sizeof(Cell) ) ) return;
+    }
+    // Only scroll if it saves writing more cells than it costs, since
+    // rows that only partly changed are cheap to update in place:
+    unsigned cells_in_place = 0;
+    for( unsigned r=top; r<=bot; r++ ) cells_in_place += Row_Changed_Cells( r );
+
+    if( cells_in_place <= (num+1)*m_num_cols ) return;
+
+    char     buf[64];
+    unsigned len = sprintf( buf, STR_SCROLL_REGION, top+1, bot+1 );
+    len += sprintf( buf+len, STR_ROW_COL, top+1, 1 );
+    len += sprintf( buf+len, 0<best_d ? STR_DELETE_LINES : STR_INSERT_LINES, num );
+    len += sprintf( buf+len, "%s", STR_SCROLL_RESET );
+    Out_Str( buf, len );
+
+    // Resetting scroll region moves cursor home:
+    m_crs_row = 0;
+    m_crs_col = 0;
+
+    Shift_Written_Rows( top, bot, best_d );
+  }
+}
+
 bool Console::Update()
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
+  // Leave cells pending, to be written when output is released:
+  if( m_hold_output ) return false;
+
+  Perf_Timer perf( PERF_CON_UPDATE );
+
+  Scroll_Shifted_Rows();
+
   bool output_something = false;
-  unsigned crs_row = ~0; // Cursor row
-  unsigned crs_col = ~0; // Cursor col
-  static uint8_t crs_style = S_UNKNOWN;
 
   for( unsigned row=0; row<m_num_rows; row++ )
   {
-    if( touched->get( row ) )
-    for( unsigned col=0; col<m_num_cols; col++ )
+    if( Row_Dirty( row ) )
     {
-      // Dont print bottom right cell of screen:
-      if( row == m_num_rows-1 && col == m_num_cols-1 ) continue;
+      const Cell* P = Row_P( row );
+            Cell* W = Row_W( row );
 
-      const uint8_t c_p = ((*lines__p)[row])->get( col ); // char pending
-      const uint8_t c_w = ((*lines__w)[row])->get( col ); // char written
-      const uint8_t s_p = ((*styles_p)[row])->get( col ); // style pending
-      const uint8_t s_w = ((*styles_w)[row])->get( col ); // style written
+      // Dont print bottom right cell of screen:
+      const unsigned FN = row < m_num_rows-1 ? (*dirty_fn)[row]
+                                             : Min( (*dirty_fn)[row], m_num_cols-1 );
 
-      if( c_p != c_w || s_p != s_w || s_w == S_UNKNOWN )
+      for( unsigned col = Next_Changed_Col( P, W, (*dirty_st)[row], FN )
+         ; col < FN
+         ; col = Next_Changed_Col( P, W, col+1, FN ) )
       {
-        if( crs_row != row || crs_col != col )
+        if( m_crs_row != row || m_crs_col != col )
         {
-          Move_2_Row_Col( row, col );
-          crs_row = row;
-          crs_col = col;
+          char buf[32];
+          const unsigned LEN = Fmt_Move( buf, row, col );
+
+          // If cursor is a few unchanged cells to the left, with the
+          // current style, re-printing those cells is cheaper than moving:
+          bool reprint = m_crs_row == row && m_crs_col < col
+                      && col - m_crs_col < LEN;
+          for( unsigned k=m_crs_col; reprint && k<col; k++ )
+          {
+            reprint = P[k].S == m_crs_style;
+          }
+          if( reprint )
+          {
+            for( unsigned k=m_crs_col; k<col; k++ ) PrintC( P[k].C );
+          }
+          else Out_Str( buf, LEN );
+
+          m_crs_row = row;
+          m_crs_col = col;
         }
-        if( crs_style != s_p )
-        {
-          Set_Style( Style_2_BG(s_p), Style_2_FG(s_p), Style_2_BB(s_p) );
-          crs_style = s_p;
-        }
-        PrintC( c_p );
-        ((*lines__w)[row])->set( col, c_p );
-        ((*styles_w)[row])->set( col, s_p );
-        crs_col++;
+        if( m_crs_style != P[col].S ) Set_Style( P[col].S );
+
+        PrintC( P[col].C );
+        W[col] = P[col];
+        // After writing the last column, the cursor position
+        // depends on the terminal, so consider it unknown:
+        m_crs_col = col+1 < m_num_cols ? col+1 : ~0;
         output_something = true;
       }
+      (*hash_w)[row] = row < m_num_rows-1 ? (*hash_p)[row] : 0;
+      (*dirty_st)[row] = m_num_cols;
+      (*dirty_fn)[row] = 0;
     }
-    touched->set( row, 0 );
   }
   return output_something;
 }
@@ -718,24 +1167,29 @@ void Console::Invalidate()
   // Invalidate all written styles:
   for( unsigned row=0; row<m_num_rows; row++ )
   {
-    touched->set( row, 1 );
-    for( unsigned col=0; col<m_num_cols; col++ )
-    {
-      ((*styles_w)[row])->set( col, S_UNKNOWN );
-    }
+    Set_Row_Unknown( row );
   }
+  m_crs_row   = ~0;
+  m_crs_col   = ~0;
+  m_crs_style = S_UNKNOWN;
 }
 
 void Console::Flush()
 {
+  if( m_hold_output ) return;
+
   // Needed only by UNIX
   const unsigned LEN = out_buf->len();
 
   if( 0<LEN )
   {
+    Perf_Timer perf( PERF_CON_FLUSH );
+
     gl_bytes_out += write( STDOUT_FILENO, out_buf->c_str(0), LEN );
 
     out_buf->clear();
+
+    Perf::Painted( LEN );
   }
 }
 
@@ -754,36 +1208,31 @@ bool Console::GetWindowSize()
   else {
     bool changed_size = m_num_rows != ws.ws_row
                      || m_num_cols != ws.ws_col
-                     || m_num_rows != lines__p->len();
+                     || m_num_rows*m_num_cols != cells_p->len();
 
     m_num_rows = ws.ws_row;
     m_num_cols = ws.ws_col;
 
     if( changed_size )
     {
-      while( lines__p->len() < m_num_rows )
-      {
-        lines__p->push( mp_vis->BorrowLine(__FILE__,__LINE__) );
-        lines__w->push( mp_vis->BorrowLine(__FILE__,__LINE__) );
-        styles_p->push( mp_vis->BorrowLine(__FILE__,__LINE__) );
-        styles_w->push( mp_vis->BorrowLine(__FILE__,__LINE__) );
-      }
-      while( m_num_rows < lines__p->len() )
-      {
-        Line* lp = 0;
-        lines__p->pop( lp ); mp_vis->ReturnLine( lp );
-        lines__w->pop( lp ); mp_vis->ReturnLine( lp );
-        styles_p->pop( lp ); mp_vis->ReturnLine( lp );
-        styles_w->pop( lp ); mp_vis->ReturnLine( lp );
-      }
+      const Cell BLANK = { 0, S_NORMAL };
+
+      cells_p->set_len( m_num_rows*m_num_cols );
+      cells_w->set_len( m_num_rows*m_num_cols );
+      cells_p->set_all( BLANK );
+      cells_w->set_all( BLANK );
+
+      dirty_st->set_len( m_num_rows );
+      dirty_fn->set_len( m_num_rows );
+      hash_w  ->set_len( m_num_rows );
+      hash_p  ->set_len( m_num_rows );
+
       for( unsigned k=0; k<m_num_rows; k++ )
       {
-        (*lines__p)[k]->set_len( m_num_cols );
-        (*lines__w)[k]->set_len( m_num_cols );
-        (*styles_p)[k]->set_len( m_num_cols );
-        (*styles_w)[k]->set_len( m_num_cols );
+        (*dirty_st)[k] = m_num_cols;
+        (*dirty_fn)[k] = 0;
+        Set_Row_Unknown( k );
       }
-      touched->set_len( m_num_rows );
     }
   }
   return true;
@@ -835,60 +1284,336 @@ unsigned Console::Num_Cols()
 // Returns non-zero if a single character,
 // or a sequence of characters that maps to a single character,
 // was read, else zero
+// Find paste_end in in_buf, starting at st.
+// Returns true and sets end to its position if found.
+bool Find_Paste_End( const unsigned st, unsigned& end )
+{
+  const unsigned LEN = in_buf->len();
+
+  for( unsigned k=st; k+LEN_PASTE_END<=LEN; k++ )
+  {
+    if( ESC == in_buf->get( k )
+     && 0 == strncmp( in_buf->c_str( k ), paste_end, LEN_PASTE_END ) )
+    {
+      end = k;
+      return true;
+    }
+  }
+  return false;
+}
+
+// Read a bracketed paste onto the end of in_buf, given the first LEN bytes
+// read of it, which start with paste_begin.  The whole paste is read at
+// once, in large reads, until paste_end is read or input stops.
+void Read_Paste( const char* str, const unsigned LEN )
+{
+  in_paste_st = in_buf->len();
+
+  for( unsigned k=LEN_PASTE_BEGIN; k<LEN; k++ ) in_buf->push( str[k] );
+
+  unsigned end = 0;
+  bool found = Find_Paste_End( in_paste_st, end );
+
+  char buf[4096];
+  while( !found )
+  {
+    pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+
+    if( poll( &pfd, 1, 100 ) <= 0 ) break; // Nothing to read in 100 ms
+
+    const ssize_t bytes_read = read( STDIN_FILENO, buf, sizeof(buf) );
+
+    if( bytes_read <= 0 ) break;
+
+    const unsigned OLD_LEN = in_buf->len();
+
+    in_buf->inc_cap( OLD_LEN + bytes_read );
+    for( unsigned k=0; k<bytes_read; k++ ) in_buf->push( buf[k] );
+
+    // paste_end may have started at the end of the last read:
+    const unsigned st = in_paste_st + LEN_PASTE_END < OLD_LEN
+                      ? OLD_LEN - LEN_PASTE_END : in_paste_st;
+
+    found = Find_Paste_End( st, end );
+  }
+  in_paste_fn = in_buf->len();
+
+  if( found )
+  {
+    // Remove paste_end, keeping any keys typed after it:
+    Line typed;
+    for( unsigned k=end+LEN_PASTE_END; k<in_buf->len(); k++ )
+    {
+      typed.push( in_buf->get( k ) );
+    }
+    in_buf->set_len( end );
+    in_buf->append( typed );
+
+    in_paste_fn = end;
+  }
+}
+
+// Returns the length of the escape sequence starting with ESC '[' or
+// ESC 'O' at str, or 0 if it is not complete in LEN bytes.
+// A CSI sequence ends with a byte in '@'-'~', and a malformed one
+// ends before its first byte that cannot be part of it.
+unsigned Esc_Seq_Len( const char* str, const unsigned LEN )
+{
+  if( LEN < 3 ) return 0;
+
+  if( 'O' == str[1] ) return 3;
+
+  for( unsigned k=2; k<LEN; k++ )
+  {
+    const char C = str[k];
+
+    if( '@' <= C && C <= '~' ) return k+1;
+    if( C < ' ' || '?' < C ) return k;
+  }
+  return 0;
+}
+
+// Returns the key for the escape sequence of LEN bytes at str,
+// or 0 if it is unknown.
+char Esc_Seq_Key( const char* str, const unsigned LEN )
+{
+  if( 3 == LEN )
+  {
+    if     ( 0 == strncmp( str, up____arrow, 3 ) ) return 'k';
+    else if( 0 == strncmp( str, down__arrow, 3 ) ) return 'j';
+    else if( 0 == strncmp( str, right_arrow, 3 ) ) return 'l';
+    else if( 0 == strncmp( str, left__arrow, 3 ) ) return 'h';
+  }
+  else if( 4 == LEN )
+  {
+    if     ( 0 == strncmp( str, page_up  , 4 ) ) return 'B';
+    else if( 0 == strncmp( str, page_down, 4 ) ) return 'F';
+  }
+  return 0;
+}
+
+// If the LEN bytes read into str end part way through an escape
+// sequence, read the rest of it, one byte at a time, while it is
+// arriving and there is room in SIZE. Returns the new length.
+unsigned Complete_Esc_Seq( char* str, unsigned LEN, const unsigned SIZE )
+{
+  while( LEN < SIZE )
+  {
+    unsigned q = LEN; // Last ESC in str
+    for( unsigned k=LEN; q == LEN && 0<k; k-- )
+    {
+      if( ESC == str[k-1] ) q = k-1;
+    }
+    if( LEN == q ) break;
+
+    const bool lone = q+1 == LEN;
+
+    if( !lone && ( ('[' != str[q+1] && 'O' != str[q+1])
+                 || 0 < Esc_Seq_Len( str+q, LEN-q ) ) ) break;
+
+    // A lone ESC is usually the ESC key, so do not wait for more:
+    pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+
+    if( poll( &pfd, 1, lone ? 0 : 10 ) <= 0 ) break;
+
+    if( read( STDIN_FILENO, str+LEN, 1 ) <= 0 ) break;
+
+    LEN++;
+  }
+  return LEN;
+}
+
+// Push the LEN keys read into str onto in_buf, replacing the escape
+// sequences of arrow and page keys with their keys.
+// Unknown and incomplete escape sequences are ignored.
+void Decode_Keys( const char* str, const unsigned LEN )
+{
+  for( unsigned p=0; p<LEN; )
+  {
+    if( ESC == str[p] && p+1 < LEN && ('[' == str[p+1] || 'O' == str[p+1]) )
+    {
+      const unsigned SEQ_LEN = Esc_Seq_Len( str+p, LEN-p );
+
+      if( 0 == SEQ_LEN ) break;
+
+      const char C = Esc_Seq_Key( str+p, SEQ_LEN );
+
+      if( 0 != C ) in_buf->push( C );
+
+      p += SEQ_LEN;
+    }
+    else {
+      in_buf->push( str[p++] );
+    }
+  }
+}
+
 char read_char()
 {
+  // Return input already read first:
+  if( in_pos < in_buf->len() ) return in_buf->get( in_pos++ );
+
+  in_buf->clear();
+  in_pos      = 0;
+  in_paste_st = 0;
+  in_paste_fn = 0;
+
   char C_in = 0;
 
-  // Ignore read errors, and escaped keys.
-  // Return the first single char read.
-  char str[16]; // Maximum F1-F12 and arrow key interpretation
-  memset( str, 0, 16 );
+  // Ignore read errors, and unknown escaped keys.
+  // Keys typed faster than they are read, like a held down arrow key,
+  // arrive together, so leave room to complete a split escape sequence.
+  const unsigned SIZE = 64;
+  char str[SIZE];
   // Returns number of bytes read, 0 if EOF, -1 on error:
-  const size_t bytes_read = read( STDIN_FILENO, str, 16 );
+  const ssize_t bytes_read = read( STDIN_FILENO, str, SIZE-16 );
 
-  if( 1 == bytes_read )
+  if( 0 < bytes_read )
   {
-  //Log.Log("read(%c)\n", str[0] );
-    C_in = str[0];
+    const unsigned LEN = Complete_Esc_Seq( str, bytes_read, SIZE );
+
+    // A key typed just before a paste can be read along with it:
+    unsigned p = 0;
+    while( p+LEN_PASTE_BEGIN <= LEN
+        && 0 != strncmp( str+p, paste_begin, LEN_PASTE_BEGIN ) ) p++;
+
+    if( p+LEN_PASTE_BEGIN <= LEN )
+    {
+      Decode_Keys( str, p );
+
+      Read_Paste( str+p, LEN-p );
+    }
+    else {
+      Decode_Keys( str, LEN );
+    }
+    // Return the keys one at a time:
+    if( in_pos < in_buf->len() ) C_in = in_buf->get( in_pos++ );
   }
-  else if( 1 < bytes_read )
+  return C_in;
+}
+
+// Returns true if there is user input waiting to be read, else false
+bool Input_Pending()
+{
+  if( in_pos < in_buf->len() ) return true;
+
+  pollfd pfd = { STDIN_FILENO, POLLIN, 0 };
+
+  return 0 < poll( &pfd, 1, 0 );
+}
+
+// Use idle time to highlight beyond what is displayed, in small slices,
+// stopping as soon as there is user input or IDLE_BUDGET is used up.
+// Returns true if there is more look ahead to do.
+bool Idle_Look_Ahead( Vis& vis )
+{
+  const double IDLE_BUDGET = 0.050; // seconds
+
+  const double t_st = GetTimeSeconds();
+
+  bool more = true;
+
+  while( more
+      && !Input_Pending()
+      && GetTimeSeconds() - t_st < IDLE_BUDGET )
+  {
+    more = vis.Idle_Look_Ahead();
+  }
+  return more;
+}
+
+// Tasks KeyIn() runs every period seconds while waiting for input:
+struct Periodic_Task
+{
+  double period;
+  double due; // Time of next run
+  void (Vis::*run)();
+};
+
+static Periodic_Task m_tasks[] =
+{
+  { 1.0, 0, &Vis::CheckFileModTime },
+  { 2.0, 0, &Vis::CheckWindowSize  }, // In case SIGWINCH was missed
+};
+const unsigned NUM_TASKS = sizeof( m_tasks )/sizeof( Periodic_Task );
+
+// Sleep in poll() until there is user input, shell output,
+// a window resize, or a periodic task is due, and handle it.
+// If busy, only handle what is ready, without waiting.
+void Wait_4_Event( Vis& vis, const bool busy )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  double now  = GetTimeSeconds();
+  double wait = 0;
+
+  // Time shell output, held back to limit redraws, should be drawn:
+  const double draw = vis.Shell_Draw_Time();
+
+  if( !busy )
   {
-  //for( size_t k=0; k<bytes_read; k++ )
-  //{
-  //  Log.Log("read(%u, %i)\n", k, static_cast<int>(str[k]) );
-  //}
-    if( 3 == bytes_read )
+    wait = m_tasks[0].due - now;
+    for( unsigned k=1; k<NUM_TASKS; k++ )
     {
-      if     ( 0 == strncmp( str, up____arrow, 3 ) ) C_in = 'k';
-      else if( 0 == strncmp( str, down__arrow, 3 ) ) C_in = 'j';
-      else if( 0 == strncmp( str, right_arrow, 3 ) ) C_in = 'l';
-      else if( 0 == strncmp( str, left__arrow, 3 ) ) C_in = 'h';
+      if( m_tasks[k].due - now < wait ) wait = m_tasks[k].due - now;
     }
-    else if( 4 == bytes_read )
+    if( 0 < draw && draw - now < wait ) wait = draw - now;
+    if( wait < 0 ) wait = 0;
+  }
+  // Negative fds are ignored by poll():
+  pollfd fds[2+MAX_JOBS] = { { STDIN_FILENO , POLLIN, 0 }
+                           , { m_winch_fd[0], POLLIN, 0 } };
+  for( unsigned k=0; k<MAX_JOBS; k++ )
+  {
+    fds[2+k].fd     = vis.Shell_Fd( k );
+    fds[2+k].events = POLLIN;
+  }
+  const int ready = poll( fds, 2+MAX_JOBS, int( wait*1000 + 0.5 ) );
+
+  bool shell_ready = false;
+  for( unsigned k=0; 0 < ready && k<MAX_JOBS; k++ )
+  {
+    if( fds[2+k].revents ) shell_ready = true;
+  }
+
+  if( 0 < ready && fds[1].revents )
+  {
+    char buf[16];
+    while( 0 < read( m_winch_fd[0], buf, sizeof(buf) ) ) ;
+
+    vis.CheckWindowSize();
+  }
+  now = GetTimeSeconds();
+
+  if( shell_ready || (0 < draw && draw <= now) ) vis.Update_Shell();
+
+  for( unsigned k=0; k<NUM_TASKS; k++ )
+  {
+    if( m_tasks[k].due <= now )
     {
-      if     ( 0 == strncmp( str, page_up  , 4 ) ) C_in = 'B';
-      else if( 0 == strncmp( str, page_down, 4 ) ) C_in = 'F';
+      (vis.*m_tasks[k].run)();
+      m_tasks[k].due = now + m_tasks[k].period;
     }
   }
-  return C_in;
 }
 
 char Console::KeyIn()
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  static Vis&     vis   = *mp_vis;
-  static unsigned count = 0;
+  static Vis& vis = *mp_vis;
 
+  Perf::Key_Done();
+
+  if( m_hold_output
+   && ( !Input_Pending() || FRAME_TIME < GetTimeSeconds() - m_hold_time ) )
+  {
+    Release_Output();
+  }
   char C_in = read_char();
 
   while( 0 == C_in )
   {
-    // Try to use less CPU time while waiting:
-    if( 0==count ) vis.CheckWindowSize(); // If window has resized, update window
-    if( 4==count ) vis.CheckFileModTime();
-    if( vis.Shell_Running() ) vis.Update_Shell();
-
     bool updated_sts_line = vis.Update_Status_Lines();
     bool updated_chg_sts  = vis.Update_Change_Statuses();
 
@@ -897,36 +1622,79 @@ char Console::KeyIn()
       Console::Update();
       vis.PrintCursor();
     }
-    count++;
-    if( 8==count ) count=0;
+    Perf::Idle();
+
+    const bool busy = Idle_Look_Ahead( vis );
+
+    Wait_4_Event( vis, busy );
 
     C_in = read_char();
   }
+  // More keys are queued, so hold output until they are handled:
+  if( !m_hold_output && Input_Pending() )
+  {
+    m_hold_output = true;
+    m_hold_time   = GetTimeSeconds();
+  }
+  Perf::Key_Arrived();
+
   return C_in;
 }
 
+// Returns true if the last key returned by KeyIn() was pasted
+bool Console::In_Paste()
+{
+  return in_paste_st < in_pos && in_pos <= in_paste_fn;
+}
+
+// Append the rest of the pasted keys to text, so they are not
+// returned by KeyIn()
+void Console::Get_Paste( Line& text )
+{
+  text.inc_cap( text.len() + in_paste_fn - in_pos );
+
+  for( ; in_pos < in_paste_fn; in_pos++ )
+  {
+    text.push( in_buf->get( in_pos ) );
+  }
+}
+
 void Console::Set_Normal()
 {
+  Release_Output();
+
   for( unsigned k=0; k<LEN_NORMAL; k++ )
   {
     out_buf->push( STR_NORMAL[k] );
   }
+  m_crs_style = S_UNKNOWN;
 }
 
 void Console::NewLine()
 {
+  Release_Output();
+
   PrintC('\n');
+
+  m_crs_row = ~0;
+  m_crs_col = ~0;
 }
 
 void Console::Move_2_Row_Col( const unsigned ROW, const unsigned COL )
 {
-  char buf[32];
-  const unsigned LEN = sprintf( buf, STR_ROW_COL, ROW+1, COL+1 );
-
-  for( unsigned k=0; k<LEN; k++ )
+  if( m_hold_output )
   {
-    out_buf->push( buf[k] );
+    m_hold_row = ROW;
+    m_hold_col = COL;
+    return;
   }
+  char buf[32];
+  const unsigned LEN = Fmt_Move( buf, ROW, COL );
+
+  Out_Str( buf, LEN );
+
+  m_crs_row = ROW;
+  m_crs_col = COL;
 }
 
 void Console::Set( const unsigned ROW
@@ -934,9 +1702,17 @@ void Console::Set( const unsigned ROW
                  , const uint8_t  C
                  , const Style    S )
 {
-  ((*lines__p)[ ROW ])->set( COL, C );
-  ((*styles_p)[ ROW ])->set( COL, S );
-  touched->set( ROW, 1 );
+  if( ROW < m_num_rows && COL < m_num_cols )
+  {
+    Cell& cell = Row_P( ROW )[ COL ];
+
+    if( cell.C != C || cell.S != S )
+    {
+      cell.C = C;
+      cell.S = S;
+      Set_Dirty( ROW, COL, COL+1 );
+    }
+  }
 }
 
 void Console::SetS( const unsigned ROW
@@ -995,6 +1771,7 @@ void Console::Set_Color_Scheme_1()
   DIFF_VARTYPE_FG   = Green  ;  DIFF_VARTYPE_BG   = Blue   ;
   DIFF_VISUAL_FG    = Blue   ;  DIFF_VISUAL_BG    = Red    ;
 
+  Build_SGR_Table();
   Refresh();
 }
 
@@ -1006,6 +1783,7 @@ void Console::Set_Color_Scheme_2()
 
   EMPTY_BG = Gray;
 
+  Build_SGR_Table();
   Refresh();
 }
 
@@ -1052,6 +1830,7 @@ void Console::Set_Color_Scheme_3()
   DIFF_VARTYPE_FG   = Green  ;  DIFF_VARTYPE_BG   = Blue   ;
   DIFF_VISUAL_FG    = Blue   ;  DIFF_VISUAL_BG    = Red    ;
 
+  Build_SGR_Table();
   Refresh();
 }
 
@@ -1063,6 +1842,7 @@ void Console::Set_Color_Scheme_4()
 
   EMPTY_BG = Black;
 
+  Build_SGR_Table();
   Refresh();
 }
 
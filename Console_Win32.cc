@@ -995,3 +995,14 @@ char Console::KeyIn()
   return c;
 }
 
+bool Console::In_Paste()
+{
+  // Bracketed paste is only used by UNIX
+  return false;
+}
+
+void Console::Get_Paste( Line& text )
+{
+  // Bracketed paste is only used by UNIX
+}
+
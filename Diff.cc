@@ -33,10 +33,18 @@
 #include "Utilities.hh"
 #include "Console.hh"
 #include "Line.hh"
+#include "Perf.hh"
+#include "Hash.hh"
+#include "Diff_Engine.hh"
+#include "Dir_Cmp.hh"
 #include "Diff.hh"
 
 extern MemLog<MEM_LOG_BUF_SIZE> Log;
 
+// Diff areas that would take more than this many line compares to
+// pair up similar lines the exact way are paired using an index:
+static const unsigned SIMI_INDEX_MIN_COMPARES = 100*1000;
+
 enum Diff_Type
 {
   DT_UNKN0WN,
@@ -100,7 +108,15 @@ struct SameArea
 //  void Set( const SameLineSec& a );
 //};
 
-typedef Array_t<Diff_Type> LineInfo;
+// Run of chars on a changed line with the same Diff_Type
+struct Char_Span
+{
+  Diff_Type diff_type; // DT_SAME, DT_CHANGED or DT_INSERTED
+  unsigned  nbytes;    // Number of consecutive chars
+};
+
+// Spans covering all the chars of a changed line, in order
+typedef Array_t<Char_Span> LineInfo;
 
 struct SimLines // Similar lines
 {
@@ -131,6 +147,14 @@ const char* Diff_Type_2_Str( const Diff_Type dt )
   return s;
 }
 
+// Differences between lines that the diff can ignore, set by :diffignore=
+enum Diff_Ignore
+{
+  IGN_SPACE = 1, // All white space, not just at the ends of lines
+  IGN_BLANK = 2, // Blank lines
+  IGN_CASE  = 4, // Upper and lower case
+};
+
 struct Diff::Data
 {
   Diff&      diff;
@@ -145,6 +169,9 @@ struct Diff::Data
   double     mod_time_l;
   unsigned   diff_ms;
   bool       printed_diff_ms;
+  Diff_Algo  algo;
+  unsigned   ignore;     // Diff_Ignore bits
+  String     ignore_str; // ignore as given to Set_Ignore()
 
   unsigned topLine;   // top  of buffer view line number.
   unsigned leftChar;  // left of buffer view character number.
@@ -169,12 +196,25 @@ struct Diff::Data
   Array_t<Diff_Info> DI_List_S;
   Array_t<Diff_Info> DI_List_L;
   unsigned DI_L_ins_idx;
+  bool     DI_L_staged; // ReDiff collects new Diff_Info's, then splices them in
+  Array_t<Diff_Info> DI_Stage_S;
+  Array_t<Diff_Info> DI_Stage_L;
+
+  bool     realign;    // Lines were inserted or deleted since last diff
+  unsigned realign_st; // First diff line touched
+  unsigned realign_fn; // Last  diff line touched
 
   Array_t<SimLines> simiList;
   Array_t<LineInfo*> line_info_cache;
 
-  const unsigned max_files_added_per_diff = 10;
-        unsigned num_files_added_this_diff = 0;
+  Line_Ids  line_ids;
+  Char_Diff char_diff;
+
+  Array_t<char>     norm_chars; // Lines with ignored differences taken out
+  Array_t<unsigned> norm_ends;  // End of each line in norm_chars
+
+  Dir_Cmp           dir_cmp;       // Compares files not in memory, when diffing directories
+  Array_t<unsigned> dir_cmp_lines; // Short line number of each dir_cmp pair
 
   Data( Diff& diff, Vis& vis, Key& key, LinesList& reg );
   ~Data();
@@ -193,6 +233,9 @@ Diff::Data::Data( Diff& diff, Vis& vis, Key& key, LinesList& reg )
   , mod_time_l( 0 )
   , diff_ms( 0 )
   , printed_diff_ms( false )
+  , algo( DA_PATIENCE )
+  , ignore( 0 )
+  , ignore_str("none")
   , topLine( 0 )
   , leftChar( 0 )
   , crsRow( 0 )
@@ -211,8 +254,20 @@ Diff::Data::Data( Diff& diff, Vis& vis, Key& key, LinesList& reg )
   , DI_List_S()
   , DI_List_L()
   , DI_L_ins_idx(0)
+  , DI_L_staged( false )
+  , DI_Stage_S()
+  , DI_Stage_L()
+  , realign( false )
+  , realign_st( 0 )
+  , realign_fn( 0 )
   , simiList()
   , line_info_cache()
+  , line_ids()
+  , char_diff()
+  , norm_chars()
+  , norm_ends()
+  , dir_cmp()
+  , dir_cmp_lines()
 {
 }
 
@@ -237,115 +292,193 @@ Diff::Data::~Data()
   }
 }
 
-SameArea Find_Max_Same( Diff::Data& m
-                      , const DiffArea& ca, const unsigned count )
+// Lines that differ only in leading and trailing white space
+// get the same id, and are diffed as the same:
+unsigned Line_Id( Diff::Data& m, const Line* pl )
 {
-  Trace trace( __PRETTY_FUNCTION__ );
-  SameArea max_same = { 0, 0, 0, 0 };
+  unsigned len = 0;
+  const char* s = pl->c_str_trim( len );
 
-  for( unsigned _ln_s = ca.ln_s; _ln_s<ca.fnl_s()-max_same.nlines; _ln_s++ )
+  return m.line_ids.Id( pl->chksum(), s, len );
+}
+
+// Appends pl to m.norm_chars without the differences m.ignore says to
+// ignore.  White space at the ends is always left off, as in Line_Id().
+// Returns true if pl is blank.
+bool Normalize( Diff::Data& m, const Line* pl )
+{
+  unsigned len = 0;
+  const char* s = pl->c_str_trim( len );
+
+  for( unsigned k=0; k<len; k++ )
   {
-    unsigned ln_s = _ln_s;
-    SameArea cur_same = { 0, 0, 0, 0 };
-    for( unsigned ln_l = ca.ln_l; ln_s<ca.fnl_s() && ln_l<ca.fnl_l(); ln_l++ )
-    {
-      const Line* ls = m.pfS->GetLineP( ln_s );
-      const Line* ll = m.pfL->GetLineP( ln_l );
+    const char C = s[k];
 
-      if( ls->chksum() != ll->chksum() ) { cur_same.Clear(); ln_s = _ln_s; }
-      else {
-        if( 0 == max_same.nlines   // First line match
-         || 0 == cur_same.nlines ) // First line match this outer loop
-        {
-          cur_same.Init( ln_s, ln_l, ls->len()+1 ); // Add one to account for line delimiter
-        }
-        else { // Continuation of cur_same
-          cur_same.Inc( Min( ls->len()+1, ll->len()+1 ) ); // Add one to account for line delimiter
-        }
-        if( max_same.nbytes < cur_same.nbytes ) max_same.Set( cur_same );
-        ln_s++;
-      }
+    if( IsSpace( C ) )
+    {
+      if( !(m.ignore & IGN_SPACE) ) m.norm_chars.push( C );
     }
-    // This line makes the diff run faster:
-    if( max_same.nlines ) _ln_s = Max( _ln_s, max_same.ln_s+max_same.nlines-1 );
+    else m.norm_chars.push( m.ignore & IGN_CASE ? tolower( C ) : C );
   }
-  return max_same;
+  return 0 == len;
 }
 
-void Popu_SameList( Diff::Data& m, const DiffArea& CA )
+bool Lines_Same( Diff::Data& m, const Line* ls, const Line* ll )
 {
-  Trace trace( __PRETTY_FUNCTION__ );
-  m.sameList.clear();
-  Array_t<DiffArea> compList;
-                    compList.push( CA );
-  unsigned count = 0;
-  DiffArea ca;
+  if( !m.ignore )
+  {
+    return ls->chksum() == ll->chksum() && ls->eq_trim( *ll );
+  }
+  m.norm_chars.clear();
+  const bool     BLANK_S = Normalize( m, ls );
+  const unsigned LEN_S   = m.norm_chars.len();
+  const bool     BLANK_L = Normalize( m, ll );
+  const unsigned LEN_L   = m.norm_chars.len() - LEN_S;
+
+  if( BLANK_S && BLANK_L ) return true;
 
-  while( compList.pop( ca ) )
+  return LEN_S == LEN_L
+      && 0 == memcmp( m.norm_chars.get(0), m.norm_chars.get(LEN_S), LEN_S );
+}
+
+// Normalizes nlines lines of pfb starting at ln onto m.norm_chars, and
+// pushes the number of each line normalized, counting from ln, to lines.
+// With IGN_BLANK, blank lines are left out.
+void Normalize_Lines( Diff::Data& m, FileBuf* pfb
+                    , const unsigned ln, const unsigned nlines
+                    , Array_t<unsigned>& lines )
+{
+  for( unsigned k=0; k<nlines; k++ )
   {
-    SameArea same = Find_Max_Same( m, ca, count++ );
+    const unsigned ST = m.norm_chars.len();
 
-    if( same.nlines && same.nbytes ) //< Dont count a single empty line as a same area
+    if( Normalize( m, pfb->GetLineP( ln+k ) ) && (m.ignore & IGN_BLANK) )
     {
-      m.sameList.push( same );
+      m.norm_chars.set_len( ST );
+    }
+    else {
+      m.norm_ends.push( m.norm_chars.len() );
+      lines.push( k );
+    }
+  }
+}
 
-      const unsigned SAME_FNL_S = same.ln_s+same.nlines; // Same finish line short
-      const unsigned SAME_FNL_L = same.ln_l+same.nlines; // Same finish line long
+// Turns runs of normalized lines into runs of lines counted from the
+// start of CA.  When blank lines are left out, the blank lines between
+// two lines of a run are paired up as the same, and any left over are
+// inserted or deleted.
+void Expand_Runs( const Array_t<unsigned>& lines_s
+                , const Array_t<unsigned>& lines_l
+                , Array_t<Same_Run>& runs )
+{
+  Array_t<Same_Run> norm_runs( runs );
+  runs.clear();
 
-      if( ( same.ln_s == ca.ln_s || same.ln_l == ca.ln_l )
-       && SAME_FNL_S < ca.fnl_s()
-       && SAME_FNL_L < ca.fnl_l() )
-      {
-        // Only one new DiffArea after same:
-        DiffArea ca1( SAME_FNL_S , ca.fnl_s()-SAME_FNL_S
-                    , SAME_FNL_L , ca.fnl_l()-SAME_FNL_L );
-        compList.push( ca1 );
-      }
-      else if( ( SAME_FNL_S == ca.fnl_s() || SAME_FNL_L == ca.fnl_l() )
-            && ca.ln_s < same.ln_s
-            && ca.ln_l < same.ln_l )
-      {
-        // Only one new DiffArea before same:
-        DiffArea ca1( ca.ln_s, same.ln_s-ca.ln_s
-                    , ca.ln_l, same.ln_l-ca.ln_l );
-        compList.push( ca1 );
-      }
-      else if( ca.ln_s < same.ln_s && SAME_FNL_S < ca.fnl_s()
-            && ca.ln_l < same.ln_l && SAME_FNL_L < ca.fnl_l() )
+  for( unsigned k=0; k<norm_runs.len(); k++ )
+  {
+    const Same_Run& nr = norm_runs[k];
+
+    for( unsigned j=0; j<nr.nlines; j++ )
+    {
+      const unsigned ln_s = lines_s[ nr.ln_s+j ];
+      const unsigned ln_l = lines_l[ nr.ln_l+j ];
+
+      if( 0<j )
       {
-        // Two new DiffArea's, one before same, and one after same:
-        DiffArea ca1( ca.ln_s, same.ln_s-ca.ln_s
-                    , ca.ln_l, same.ln_l-ca.ln_l );
-        DiffArea ca2( SAME_FNL_S, ca.fnl_s()-SAME_FNL_S
-                    , SAME_FNL_L, ca.fnl_l()-SAME_FNL_L );
-        compList.push( ca1 );
-        compList.push( ca2 );
+        Same_Run& last = runs[ runs.len()-1 ];
+
+        const unsigned BLANK_S = ln_s - (last.ln_s + last.nlines);
+        const unsigned BLANK_L = ln_l - (last.ln_l + last.nlines);
+
+        last.nlines += BLANK_S < BLANK_L ? BLANK_S : BLANK_L;
+
+        if( BLANK_S == BLANK_L ) { last.nlines++; continue; }
       }
+      Same_Run run = { ln_s, ln_l, 1 };
+      runs.push( run );
     }
   }
 }
 
-// Sort m.sameList from least ln_l to greatest ln_l.
-// DiffArea.ln_l is beginning line number in long file.
-//
-void Sort_SameList( Diff::Data& m )
+// Fills in runs like Diff_Ids(), but with the lines of CA normalized
+// first, so differences in m.ignore are not seen.  This takes one more
+// pass over the lines than diffing the Line_Id()'s.
+void Diff_Normalized( Diff::Data& m, const DiffArea& CA
+                    , Array_t<Same_Run>& runs )
 {
-  Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned SLL = m.sameList.len();
+  Array_t<unsigned> lines_s( CA.nlines_s );
+  Array_t<unsigned> lines_l( CA.nlines_l );
 
-  for( unsigned k=0; k<SLL; k++ )
+  m.norm_chars.clear();
+  m.norm_ends.clear();
+  Normalize_Lines( m, m.pfS, CA.ln_s, CA.nlines_s, lines_s );
+  Normalize_Lines( m, m.pfL, CA.ln_l, CA.nlines_l, lines_l );
+
+  // norm_chars does not move once all the lines are in it,
+  // so Line_Ids can point into it:
+  Array_t<unsigned> ids_s( lines_s.len() );
+  Array_t<unsigned> ids_l( lines_l.len() );
+
+  m.line_ids.Clear();
+  for( unsigned k=0; k<m.norm_ends.len(); k++ )
   {
-    for( unsigned j=SLL-1; k<j; j-- )
+    const unsigned ST  = 0<k ? m.norm_ends[k-1] : 0;
+    const unsigned LEN = m.norm_ends[k] - ST;
+    const char*    s   = 0<LEN ? m.norm_chars.get( ST ) : "";
+
+    const unsigned ID = m.line_ids.Id( Hash_64( s, LEN ), s, LEN );
+
+    if( k < lines_s.len() ) ids_s.push( ID );
+    else                    ids_l.push( ID );
+  }
+  const unsigned NUM_IDS = m.line_ids.Num_Ids();
+  m.line_ids.Clear();
+
+  Diff_Ids( ids_s.get(0), ids_s.len()
+          , ids_l.get(0), ids_l.len(), NUM_IDS, m.algo, runs );
+
+  if( m.ignore & IGN_BLANK ) Expand_Runs( lines_s, lines_l, runs );
+}
+
+void Popu_SameList( Diff::Data& m, const DiffArea& CA )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+  m.sameList.clear();
+
+  Array_t<Same_Run> runs;
+
+  if( m.ignore ) Diff_Normalized( m, CA, runs );
+  else {
+    Array_t<unsigned> ids_s( CA.nlines_s );
+    Array_t<unsigned> ids_l( CA.nlines_l );
+
+    m.line_ids.Clear();
+    for( unsigned k=0; k<CA.nlines_s; k++ )
+    {
+      ids_s.push( Line_Id( m, m.pfS->GetLineP( CA.ln_s+k ) ) );
+    }
+    for( unsigned k=0; k<CA.nlines_l; k++ )
     {
-      SameArea sa0 = m.sameList[ j-1 ];
-      SameArea sa1 = m.sameList[ j   ];
+      ids_l.push( Line_Id( m, m.pfL->GetLineP( CA.ln_l+k ) ) );
+    }
+    const unsigned NUM_IDS = m.line_ids.Num_Ids();
+    m.line_ids.Clear();
 
-      if( sa1.ln_l < sa0.ln_l )
-      {
-        m.sameList[ j-1 ] = sa1;
-        m.sameList[ j   ] = sa0;
-      }
+    Diff_Ids( ids_s.get(0), CA.nlines_s
+            , ids_l.get(0), CA.nlines_l, NUM_IDS, m.algo, runs );
+  }
+  // Runs come back in order, so sameList does not need sorting:
+  for( unsigned k=0; k<runs.len(); k++ )
+  {
+    const Same_Run& run = runs[k];
+    SameArea same = { CA.ln_s + run.ln_s, CA.ln_l + run.ln_l, run.nlines, 0 };
+
+    for( unsigned j=0; j<run.nlines; j++ )
+    {
+      // Add one to account for line delimiter
+      same.nbytes += m.pfS->LineLen( same.ln_s+j ) + 1;
     }
+    m.sameList.push( same );
   }
 }
 
@@ -428,19 +561,17 @@ void Sort_SimiList( Diff::Data& m )
   Trace trace( __PRETTY_FUNCTION__ );
   const unsigned SLL = m.simiList.len();
 
-  for( unsigned k=0; k<SLL; k++ )
+  // Insertion sort, since simiList is often already sorted:
+  for( unsigned k=1; k<SLL; k++ )
   {
-    for( unsigned j=SLL-1; k<j; j-- )
-    {
-      SimLines sl0 = m.simiList[ j-1 ];
-      SimLines sl1 = m.simiList[ j   ];
+    const SimLines sl = m.simiList[ k ];
+    unsigned j = k;
 
-      if( sl1.ln_l < sl0.ln_l )
-      {
-        m.simiList[ j-1 ] = sl1;
-        m.simiList[ j   ] = sl0;
-      }
+    for( ; 0<j && sl.ln_l < m.simiList[ j-1 ].ln_l; j-- )
+    {
+      m.simiList[ j ] = m.simiList[ j-1 ];
     }
+    m.simiList[ j ] = sl;
   }
 }
 
@@ -485,55 +616,63 @@ LineInfo* Borrow_LineInfo( Diff::Data& m
 }
 
 // Returns number of bytes that are the same between the two lines
-// and fills in li_s and li_l
-unsigned Compare_Lines( const Line* ls, LineInfo* li_s
+unsigned Bytes_Same( Diff::Data& m, const Line* ls, const Line* ll )
+{
+  if( 0==ls->len() && 0==ll->len() ) { return 1; }
+
+  return m.char_diff.Run( ls->c_str(0), ls->len(), ll->c_str(0), ll->len() );
+}
+
+void Add_Span( LineInfo* li, const Diff_Type dt, const unsigned nbytes )
+{
+  if( 0 == nbytes ) return;
+
+  const unsigned LEN = li->len();
+
+  if( 0<LEN && (*li)[LEN-1].diff_type == dt ) (*li)[LEN-1].nbytes += nbytes;
+  else {
+    const Char_Span span = { dt, nbytes };
+    li->push( span );
+  }
+}
+
+// Returns number of bytes that are the same between the two lines
+// and fills in li_s and li_l.  Chars between runs of same chars are
+// changed where the lines both have chars, and inserted where only
+// one line has chars.
+unsigned Compare_Lines( Diff::Data& m
+                      , const Line* ls, LineInfo* li_s
                       , const Line* ll, LineInfo* li_l )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  if( 0==ls->len() && 0==ll->len() ) { return 1; }
   li_s->clear(); li_l->clear();
-  const Line* pls = ls; LineInfo* pli_s = li_s;
-  const Line* pll = ll; LineInfo* pli_l = li_l;
-  if( ll->len() < ls->len() ) { pls = ll; pli_s = li_l;
-                                pll = ls; pli_l = li_s; }
-  const unsigned SLL = pls->len();
-  const unsigned LLL = pll->len();
 
-  pli_l->set_len( LLL );
-  pli_s->set_len( LLL );
+  const unsigned num_same = Bytes_Same( m, ls, ll );
 
-  unsigned num_same = 0;
-  unsigned i_s = 0;
-  unsigned i_l = 0;
+  const Array_t<Same_Run>& runs = m.char_diff.Runs();
+  unsigned ch_s = 0;
+  unsigned ch_l = 0;
 
-  while( i_s < SLL && i_l < LLL )
+  for( unsigned k=0; k<=runs.len(); k++ )
   {
-    const uint8_t cs = pls->get( i_s );
-    const uint8_t cl = pll->get( i_l );
+    // Past the last run, finish off the ends of the lines:
+    Same_Run R = { ls->len(), ll->len(), 0 };
+    if( k<runs.len() ) R = runs[k];
 
-    if( cs == cl )
-    {
-      num_same++;
-      (*pli_s)[ i_s++ ] = DT_SAME;
-      (*pli_l)[ i_l++ ] = DT_SAME;
-    }
-    else {
-      const unsigned remaining_s = SLL - i_s;
-      const unsigned remaining_l = LLL - i_l;
+    const unsigned GAP_S = R.ln_s - ch_s;
+    const unsigned GAP_L = R.ln_l - ch_l;
+    const unsigned NUM_CHANGED = GAP_S < GAP_L ? GAP_S : GAP_L;
 
-      if( 0<remaining_s
-       && 0<remaining_l && remaining_s == remaining_l )
-      {
-        (*pli_s)[ i_s++ ] = DT_CHANGED;
-        (*pli_l)[ i_l++ ] = DT_CHANGED;
-      }
-      else if( remaining_s < remaining_l ) (*pli_l)[ i_l++ ] = DT_INSERTED;
-      else if( remaining_l < remaining_s ) (*pli_s)[ i_s++ ] = DT_INSERTED;
-    }
-  }
-  for( unsigned k=SLL; k<LLL; k++ ) (*pli_s)[k] = DT_DELETED;
-  for( unsigned k=i_l; k<LLL; k++ ) (*pli_l)[k] = DT_INSERTED;
+    Add_Span( li_s, DT_CHANGED , NUM_CHANGED );
+    Add_Span( li_s, DT_INSERTED, GAP_S - NUM_CHANGED );
+    Add_Span( li_l, DT_CHANGED , NUM_CHANGED );
+    Add_Span( li_l, DT_INSERTED, GAP_L - NUM_CHANGED );
+    Add_Span( li_s, DT_SAME, R.nlines );
+    Add_Span( li_l, DT_SAME, R.nlines );
 
+    ch_s = R.ln_s + R.nlines;
+    ch_l = R.ln_l + R.nlines;
+  }
   return num_same;
 }
 
@@ -554,29 +693,27 @@ SimLines Find_Lines_Most_Same( Diff::Data& m
       const Line* ls = pfs->GetLineP( ln_s ); // Line from short area
       const Line* ll = pfl->GetLineP( ln_l ); // Line from long  area
 
-      LineInfo* li_s = Borrow_LineInfo( m, __FILE__,__LINE__);
-      LineInfo* li_l = Borrow_LineInfo( m, __FILE__,__LINE__);
-      const unsigned bytes_same = Compare_Lines( ls, li_s, ll, li_l );
+      const unsigned bytes_same = Bytes_Same( m, ls, ll );
 
       if( most_same.nbytes < bytes_same )
       {
-        if( most_same.li_s ) { Return_LineInfo( m, most_same.li_s ); }
-        if( most_same.li_l ) { Return_LineInfo( m, most_same.li_l ); }
         most_same.ln_s   = ln_s;
         most_same.ln_l   = ln_l;
         most_same.nbytes = bytes_same;
-        most_same.li_s   = li_s; // Hand off li_s
-        most_same.li_l   = li_l; // and      li_l
-      }
-      else {
-        Return_LineInfo( m, li_s );
-        Return_LineInfo( m, li_l );
       }
     }
   }
-  if( 0==most_same.nbytes )
+  if( 0<most_same.nbytes )
   {
-    // This if() block ensures that each line in the short DiffArea is
+    // Only fill in LineInfo's for the pair of lines kept:
+    most_same.li_s = Borrow_LineInfo( m, __FILE__,__LINE__);
+    most_same.li_l = Borrow_LineInfo( m, __FILE__,__LINE__);
+
+    Compare_Lines( m, pfs->GetLineP( most_same.ln_s ), most_same.li_s
+                    , pfl->GetLineP( most_same.ln_l ), most_same.li_l );
+  }
+  else {
+    // This else block ensures that each line in the short DiffArea is
     // matched to a line in the long DiffArea.  Each line in the short
     // DiffArea must be matched to a line in the long DiffArea or else
     // SimiList_2_DI_Lists wont work right.
@@ -587,6 +724,55 @@ SimLines Find_Lines_Most_Same( Diff::Data& m
   return most_same;
 }
 
+// Pairs the lines of a large diff area using Pair_Lines(), which finds
+// similar lines through an index instead of comparing all the lines
+void Popu_SimiList_Index( Diff::Data& m
+                        , const unsigned da_ln_s
+                        , const unsigned da_ln_l
+                        , const unsigned da_nlines_s
+                        , const unsigned da_nlines_l
+                        , FileBuf* pfs
+                        , FileBuf* pfl )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  Array_t<Line_Ref> refs_s;
+  Array_t<Line_Ref> refs_l;
+  for( unsigned k=0; k<da_nlines_s; k++ )
+  {
+    const Line* pl = pfs->GetLineP( da_ln_s+k );
+    const Line_Ref r = { pl->c_str(0), pl->len() };
+    refs_s.push( r );
+  }
+  for( unsigned k=0; k<da_nlines_l; k++ )
+  {
+    const Line* pl = pfl->GetLineP( da_ln_l+k );
+    const Line_Ref r = { pl->c_str(0), pl->len() };
+    refs_l.push( r );
+  }
+  Array_t<unsigned> pair_l;
+  Pair_Lines( refs_s.get(0), da_nlines_s
+            , refs_l.get(0), da_nlines_l, m.char_diff, pair_l );
+
+  for( unsigned k=0; k<da_nlines_s; k++ )
+  {
+    SimLines siml = { da_ln_s+k, da_ln_l+pair_l[k], 0, 0, 0 };
+    siml.li_s = Borrow_LineInfo( m, __FILE__,__LINE__);
+    siml.li_l = Borrow_LineInfo( m, __FILE__,__LINE__);
+
+    siml.nbytes = Compare_Lines( m, pfs->GetLineP( siml.ln_s ), siml.li_s
+                                  , pfl->GetLineP( siml.ln_l ), siml.li_l );
+    if( 0==siml.nbytes )
+    {
+      // Nothing the same, so show the whole lines as changed:
+      Return_LineInfo( m, siml.li_s ); siml.li_s = 0;
+      Return_LineInfo( m, siml.li_l ); siml.li_l = 0;
+      siml.nbytes = 1;
+    }
+    m.simiList.push( siml );
+  }
+}
+
 void Popu_SimiList( Diff::Data& m
                   , const unsigned da_ln_s
                   , const unsigned da_ln_l
@@ -598,7 +784,16 @@ void Popu_SimiList( Diff::Data& m
   Trace trace( __PRETTY_FUNCTION__ );
   Clear_SimiList(m);
 
-  if( da_nlines_s && da_nlines_l )
+  // Finding the most similar pair of lines compares up to
+  // da_nlines_s*(LD+1) pairs, and is repeated for each short line:
+  const unsigned long long LD = da_nlines_l - da_nlines_s;
+  const unsigned long long NUM_COMPARES = da_nlines_s*(LD+1)*da_nlines_s/2;
+
+  if( SIMI_INDEX_MIN_COMPARES < NUM_COMPARES )
+  {
+    Popu_SimiList_Index( m, da_ln_s, da_ln_l, da_nlines_s, da_nlines_l, pfs, pfl );
+  }
+  else if( da_nlines_s && da_nlines_l )
   {
     DiffArea ca( da_ln_s, da_nlines_s, da_ln_l, da_nlines_l );
 
@@ -654,8 +849,18 @@ void Insert_DI_List( Diff::Data& m
                    , const Diff_Info& di
                    , Array_t<Diff_Info>& DI_List )
 {
-  bool ok = DI_List.insert( m.DI_L_ins_idx, di );
-  ASSERT( __LINE__, ok, "ok" );
+  if( m.DI_L_staged )
+  {
+    // Inserting into the middle of DI_List one at a time is O(N) per line,
+    // so collect the lines and splice them in all at once after the diff:
+    Array_t<Diff_Info>& stage = ( &DI_List == &m.DI_List_S ) ? m.DI_Stage_S
+                                                             : m.DI_Stage_L;
+    stage.push( di );
+  }
+  else {
+    bool ok = DI_List.insert( m.DI_L_ins_idx, di );
+    ASSERT( __LINE__, ok, "ok" );
+  }
 }
 
 void SimiList_2_DI_Lists( Diff::Data& m
@@ -671,12 +876,15 @@ void SimiList_2_DI_Lists( Diff::Data& m
   // Diff info short line number:
   unsigned dis_ln = da_ln_s ? da_ln_s-1 : 0;
 
+  // simiList is sorted by ln_l, so only the next entry can match:
+  unsigned j = 0;
+
   for( unsigned k=0; k<da_nlines_l; k++ )
   {
     Diff_Info dis = { DT_DELETED , dis_ln    };
     Diff_Info dil = { DT_INSERTED, da_ln_l+k };
 
-    for( unsigned j=0; j<m.simiList.len(); j++ )
+    for( ; j<m.simiList.len() && m.simiList[ j ].ln_l <= da_ln_l+k; j++ )
     {
       SimLines& siml = m.simiList[ j ];
 
@@ -762,7 +970,7 @@ void Popu_DI_List_AddDiff( Diff::Data& m, const DiffArea& da )
       LineInfo* li_s = Borrow_LineInfo( m, __FILE__,__LINE__);
       LineInfo* li_l = Borrow_LineInfo( m, __FILE__,__LINE__);
 
-      unsigned bytes_same = Compare_Lines( ls, li_s, ll, li_l );
+      Compare_Lines( m, ls, li_s, ll, li_l );
 
       Diff_Info dis = { DT_CHANGED, da.ln_s+k, li_s };
       Diff_Info dil = { DT_CHANGED, da.ln_l+k, li_l };
@@ -906,6 +1114,24 @@ void Popu_DI_List_NoSameArea( Diff::Data& m )
 //  return files_differ;
 //}
 
+// Returns the index into dir_cmp of the pair at short line line_s,
+// or dir_cmp_lines.len() if line_s was not compared by dir_cmp
+unsigned Dir_Cmp_Idx( Diff::Data& m, const unsigned line_s )
+{
+  const unsigned LEN = m.dir_cmp_lines.len();
+
+  unsigned lo = 0;
+  unsigned hi = LEN;
+  while( lo < hi )
+  {
+    const unsigned mid = (lo + hi)/2;
+
+    if( m.dir_cmp_lines[ mid ] < line_s ) lo = mid+1;
+    else                                  hi = mid;
+  }
+  return ( lo < LEN && m.dir_cmp_lines[ lo ] == line_s ) ? lo : LEN;
+}
+
 // Returns true if the two lines, line_s and line_l, in the two files
 // being compared, are the names of files that differ
 bool Popu_DI_List_Have_Diff_Files( Diff::Data& m
@@ -916,52 +1142,96 @@ bool Popu_DI_List_Have_Diff_Files( Diff::Data& m
 
   if( m.pfS->IsDir() && m.pfL->IsDir() )
   {
-    // fname_s and fname_l are head names
-    String fname_s = m.pfS->GetLine( line_s ).toString();
-    String fname_l = m.pfL->GetLine( line_l ).toString();
+    const unsigned DCI = Dir_Cmp_Idx( m, line_s );
 
-    if( (fname_s != "..") && !fname_s.ends_with( DirDelimStr() )
-     && (fname_l != "..") && !fname_l.ends_with( DirDelimStr() ) )
+    if( DCI < m.dir_cmp_lines.len() )
     {
-      // fname_s and fname_l should now be full path names,
-      // tail and head, of regular files
-      fname_s.insert( 0, m.pfS->GetDirName() );
-      fname_l.insert( 0, m.pfL->GetDirName() );
-
-      FileBuf* pfb_s = m.vis.GetFileBuf( fname_s );
-      FileBuf* pfb_l = m.vis.GetFileBuf( fname_l );
+      // Files or directories were compared on disk by Popu_Dir_Cmp():
+      files_differ = !m.dir_cmp.Same( DCI );
+    }
+    else {
+      // fname_s and fname_l are head names
+      String fname_s = m.pfS->GetLine( line_s ).toString();
+      String fname_l = m.pfL->GetLine( line_l ).toString();
 
-      // If one side is in ram, read in the other side:
-      if     ( (0 == pfb_s) && (0 != pfb_l) ) m.vis.NotHaveFileAddFile( fname_s );
-      else if( (0 != pfb_s) && (0 == pfb_l) ) m.vis.NotHaveFileAddFile( fname_l );
-      else if( (0 == pfb_s) && (0 == pfb_l) )
+      if( (fname_s != "..") && !fname_s.ends_with( DirDelimStr() )
+       && (fname_l != "..") && !fname_l.ends_with( DirDelimStr() ) )
       {
-        // Adding files is slow because of all the new'ing, so limit
-        // the number of files that can be added per diff:
-        if( m.num_files_added_this_diff < m.max_files_added_per_diff )
-        {
-          bool added_s = m.vis.NotHaveFileAddFile( fname_s );
-          bool added_l = m.vis.NotHaveFileAddFile( fname_l );
+        // fname_s and fname_l should now be full path names,
+        // tail and head, of regular files
+        fname_s.insert( 0, m.pfS->GetDirName() );
+        fname_l.insert( 0, m.pfL->GetDirName() );
+
+        FileBuf* pfb_s = m.vis.GetFileBuf( fname_s );
+        FileBuf* pfb_l = m.vis.GetFileBuf( fname_l );
 
-          if( added_s ) m.num_files_added_this_diff++;
-          if( added_l ) m.num_files_added_this_diff++;
+        // If one side is in ram, read in the other side:
+        if     ( (0 == pfb_s) && (0 != pfb_l) ) m.vis.NotHaveFileAddFile( fname_s );
+        else if( (0 != pfb_s) && (0 == pfb_l) ) m.vis.NotHaveFileAddFile( fname_l );
+
+        pfb_s = m.vis.GetFileBuf( fname_s );
+        pfb_l = m.vis.GetFileBuf( fname_l );
+
+        if( (0 == pfb_s) || (0 == pfb_l) )
+        {
+          // Slow: Compare the files in NVM:
+          files_differ = !Files_Are_Same( fname_s.c_str(), fname_l.c_str() );
+        }
+        else {
+          // Fast: Compare files already cached in memory:
+          files_differ = !Files_Are_Same( *pfb_s, *pfb_l );
         }
       }
-      pfb_s = m.vis.GetFileBuf( fname_s );
-      pfb_l = m.vis.GetFileBuf( fname_l );
+    }
+  }
+  return files_differ;
+}
+
+// When diffing directories, compares all the files and sub-directories
+// of the same name, neither of which are in memory, before DI_List is
+// populated, so they can be compared on several threads, and
+// sub-directories compared recursively.  Files in memory may have been
+// changed, so they are still compared in memory.
+void Popu_Dir_Cmp( Diff::Data& m )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  m.dir_cmp.Clear();
+  m.dir_cmp_lines.clear();
 
-      if( (0 == pfb_s) || (0 == pfb_l) )
+  if( m.pfS->IsDir() && m.pfL->IsDir() )
+  {
+    for( unsigned k=0; k<m.sameList.len(); k++ )
+    {
+      const SameArea sa = m.sameList[k];
+
+      for( unsigned j=0; j<sa.nlines; j++ )
       {
-        // Slow: Compare the files in NVM:
-        files_differ = !Files_Are_Same( fname_s.c_str(), fname_l.c_str() );
-      }
-      else {
-        // Fast: Compare files already cached in memory:
-        files_differ = !Files_Are_Same( *pfb_s, *pfb_l );
+        // Same lines, so the same on both sides:
+        String line = m.pfS->GetLine( sa.ln_s+j ).toString();
+
+        if( line != ".." )
+        {
+          // Symbolic links are listed as "name -> target":
+          String fname;
+          line.split( " -> ", fname );
+          const bool IS_LNK = 0 < line.len();
+          const bool IS_DIR = !IS_LNK && fname.ends_with( DirDelimStr() );
+
+          String fname_s = m.pfS->GetDirName(); fname_s += fname;
+          String fname_l = m.pfL->GetDirName(); fname_l += fname;
+
+          if( IS_DIR || IS_LNK || ( !m.vis.GetFileBuf( fname_s )
+                                 && !m.vis.GetFileBuf( fname_l ) ) )
+          {
+            m.dir_cmp.Add( fname_s.c_str(), fname_l.c_str() );
+            m.dir_cmp_lines.push( sa.ln_s+j );
+          }
+        }
       }
     }
+    m.dir_cmp.Run();
   }
-  return files_differ;
 }
 
 void Popu_DI_List_AddSame( Diff::Data& m, const SameArea& sa )
@@ -1058,16 +1328,18 @@ void RunDiff( Diff::Data& m, const DiffArea& CA )
   const double t1_s = GetTimeSeconds();
 
   Popu_SameList( m, CA );
-  Sort_SameList( m );
 //PrintSameList();
   Popu_DiffList( m, CA );
 //PrintDiffList();
+  Popu_Dir_Cmp( m );
   Popu_DI_List( m, CA );
 //PrintDI_List( CA );
 
   const double t2_s = GetTimeSeconds();
   m.diff_ms = (t2_s - t1_s)*1000 + 0.5;
   m.printed_diff_ms = false;
+
+  Perf::Add_Secs( PERF_DIFF, t2_s - t1_s );
 }
 
 unsigned NumLines( Diff::Data& m )
@@ -1128,6 +1400,73 @@ bool Do_n_Search_for_Same( Diff::Data& m
   return found;
 }
 
+// True if line dl of DI_List is blank, or is a row put in across
+// from lines of the other file
+bool Blank_Diff_Line( const unsigned dl
+                    , const Array_t<Diff_Info>& DI_List
+                    , const FileBuf* pF )
+{
+  const Diff_Info& di = DI_List[ dl ];
+
+  if( di.diff_type == DT_DELETED ) return true;
+  if( di.diff_type == DT_DIFF_FILES ) return false;
+
+  unsigned len = 0;
+  pF->GetLineP( di.line_num )->c_str_trim( len );
+
+  return 0 == len;
+}
+
+// With IGN_BLANK, the diff lines [st,fn) are not a difference if they
+// are all blank, since the blank lines were left out of the diff, and
+// only could not be paired up.
+bool Blank_Diff_Lines( Diff::Data& m, const unsigned st, const unsigned fn )
+{
+  for( unsigned dl=st; dl<fn; dl++ )
+  {
+    if( !Blank_Diff_Line( dl, m.DI_List_S, m.pfS )
+     || !Blank_Diff_Line( dl, m.DI_List_L, m.pfL ) ) return false;
+  }
+  return true;
+}
+
+// True if the diff lines around dl, up to the same lines before and
+// after, are all blank, as in Blank_Diff_Lines()
+bool Blank_Diff_Hunk( Diff::Data& m, const unsigned dl )
+{
+  const unsigned NUM_LINES = NumLines(m);
+
+  // Stop at the first line that is not blank, as hunks can be long:
+  for( unsigned k=dl; 0<k && m.DI_List_S[k-1].diff_type != DT_SAME; k-- )
+  {
+    if( !Blank_Diff_Lines( m, k-1, k ) ) return false;
+  }
+  for( unsigned k=dl; k<NUM_LINES && m.DI_List_S[k].diff_type != DT_SAME; k++ )
+  {
+    if( !Blank_Diff_Lines( m, k, k+1 ) ) return false;
+  }
+  return true;
+}
+
+// If the diff lines starting at dl are only blank lines ignored by
+// IGN_BLANK, moves dl past them and returns true
+bool Skip_n_Blank_Diff( Diff::Data& m
+                      , unsigned& dl
+                      , const Array_t<Diff_Info>& DI_List )
+{
+  if( !(m.ignore & IGN_BLANK) ) return false;
+
+  const unsigned NUM_LINES = NumLines(m);
+
+  unsigned fn = dl;
+  while( fn<NUM_LINES && DI_List[fn].diff_type != DT_SAME ) fn++;
+
+  if( !Blank_Diff_Lines( m, dl, fn ) ) return false;
+
+  dl = fn;
+  return true;
+}
+
 // Look for difference based on Diff_Info:
 bool Do_n_Search_for_Diff_DT( Diff::Data& m
                             , unsigned& dl
@@ -1147,7 +1486,7 @@ bool Do_n_Search_for_Diff_DT( Diff::Data& m
      || DT == DT_DELETED
      || DT == DT_DIFF_FILES )
     {
-      found_diff = true;
+      if( !Skip_n_Blank_Diff( m, dl, DI_List ) ) found_diff = true;
     }
     else dl++;
   }
@@ -1164,7 +1503,7 @@ bool Do_n_Search_for_Diff_DT( Diff::Data& m
        || DT == DT_DELETED
        || DT == DT_DIFF_FILES )
       {
-        found_diff = true;
+        if( !Skip_n_Blank_Diff( m, dl, DI_List ) ) found_diff = true;
       }
       else dl++;
     }
@@ -1258,7 +1597,7 @@ bool Do_n_Search_for_Diff( Diff::Data& m
   {
     found_diff = Do_n_Search_for_Diff_DT( m, dl, DI_List );
 
-    if( !found_diff )
+    if( !found_diff && !(m.ignore & IGN_SPACE) )
     {
       dl = dl_st;
       found_diff = Do_n_Search_for_Diff_WhiteSpace( m, dl, DI_List );
@@ -1280,17 +1619,17 @@ unsigned Do_n_Find_Crs_Pos( Diff::Data& m
     LineInfo* pLI_s = m.DI_List_S[ NCL ].pLineInfo;
     LineInfo* pLI_l = m.DI_List_L[ NCL ].pLineInfo;
 
-    for( unsigned k=0; 0 != pLI_s && k<pLI_s->len()
-                    && 0 != pLI_l && k<pLI_l->len(); k++ )
+    if( pLI_s && pLI_l )
     {
-      Diff_Type dt_s = (*pLI_s)[ k ];
-      Diff_Type dt_l = (*pLI_l)[ k ];
+      // Lines start with at most one same span, followed by a diff:
+      const bool SAME_S = pLI_s->len() && DT_SAME == (*pLI_s)[0].diff_type;
+      const bool SAME_L = pLI_l->len() && DT_SAME == (*pLI_l)[0].diff_type;
+      const bool DIFF_S = SAME_S ? 1 < pLI_s->len() : 0 < pLI_s->len();
+      const bool DIFF_L = SAME_L ? 1 < pLI_l->len() : 0 < pLI_l->len();
 
-      if( dt_s != DT_SAME
-       || dt_l != DT_SAME )
+      if( DIFF_S || DIFF_L )
       {
-        NCP = k;
-        break;
+        NCP = SAME_S && SAME_L ? (*pLI_s)[0].nbytes : 0;
       }
     }
   }
@@ -1390,6 +1729,35 @@ bool InVisualArea( Diff::Data& m
   return false;
 }
 
+// Returns the Style of a char outside the visual area from its highlight
+// byte, hi.  Styles for all 256 values are found once, in the same order
+// of precedence as the View::In*() checks.  Diff does not show non-ascii.
+Style HiStyle_2_DiffStyle( const uint8_t hi )
+{
+  static Style table[256];
+  static bool  have_table = false;
+
+  if( !have_table )
+  {
+    for( unsigned h=0; h<256; h++ )
+    {
+      Style s = S_NORMAL;
+
+      if     ( h & HI_STAR      ) s = S_STAR;
+      else if( h & HI_STAR_IN_F ) s = S_STAR_IN_F;
+      else if( h & HI_DEFINE    ) s = S_DEFINE;
+      else if( h & HI_COMMENT   ) s = S_COMMENT;
+      else if( h & HI_CONST     ) s = S_CONST;
+      else if( h & HI_CONTROL   ) s = S_CONTROL;
+      else if( h & HI_VARTYPE   ) s = S_VARTYPE;
+
+      table[h] = s;
+    }
+    have_table = true;
+  }
+  return table[ hi ];
+}
+
 Style Get_Style( Diff::Data& m
                , View* pV
                , const unsigned DL
@@ -1404,16 +1772,8 @@ Style Get_Style( Diff::Data& m
 
   if( VL < pfb->NumLines() && pos < pfb->LineLen( VL ) )
   {
-    S = S_NORMAL;
-
-    if     ( InVisualArea( m, pV, DL, pos ) ) S = S_RV_VISUAL;
-    else if( pV->InStar         ( VL, pos ) ) S = S_STAR;
-    else if( pV->InStarInF      ( VL, pos ) ) S = S_STAR_IN_F;
-    else if( pV->InDefine       ( VL, pos ) ) S = S_DEFINE;
-    else if( pV->InComment      ( VL, pos ) ) S = S_COMMENT;
-    else if( pV->InConst        ( VL, pos ) ) S = S_CONST;
-    else if( pV->InControl      ( VL, pos ) ) S = S_CONTROL;
-    else if( pV->InVarType      ( VL, pos ) ) S = S_VARTYPE;
+    if( InVisualArea( m, pV, DL, pos ) ) S = S_RV_VISUAL;
+    else S = HiStyle_2_DiffStyle( pfb->GetStyle( VL ).get( pos ) );
   }
   return S;
 }
@@ -1876,6 +2236,7 @@ void Diff::ClearDiff()
   Clear_DI_List( m, m.DI_List_S );
   Clear_DI_List( m, m.DI_List_L );
   m.DI_L_ins_idx = 0;
+  m.realign = false;
 
   Clear_SimiList(m);
 
@@ -1894,7 +2255,6 @@ void Diff::ClearDiff()
   m.pvL = 0;
   m.pfS = 0;
   m.pfL = 0;
-  m.num_files_added_this_diff = 0;
 }
 
 bool DiffSameAsPrev( Diff::Data& m, View* const pv0, View* const pv1 )
@@ -2234,6 +2594,20 @@ void PrintWorkingView_DT_DELETED( Diff::Data& m
   }
 }
 
+// Row put in across from blank lines of the other file
+void PrintWorkingView_DT_BLANK( Diff::Data& m
+                              , View* pV
+                              , const unsigned WC
+                              , const unsigned G_ROW )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  for( unsigned col=0; col<WC; col++ )
+  {
+    Console::Set( G_ROW, Col_Win_2_GL( m, pV, col ), ' ', S_EMPTY );
+  }
+}
+
 void PrintWorkingView_DT_CHANGED( Diff::Data& m
                                 , View* pV
                                 , const unsigned WC
@@ -2248,34 +2622,26 @@ void PrintWorkingView_DT_CHANGED( Diff::Data& m
 
   if( di.pLineInfo )
   {
-    const unsigned LIL = di.pLineInfo->len();
-    unsigned cp = m.leftChar; // char position
-    for( unsigned i=m.leftChar; cp<LL && i<LIL && col<WC; i++, col++ )
-    {
-      Diff_Type dt = (*di.pLineInfo)[i];
+    const LineInfo& LI  = *di.pLineInfo;
+    const unsigned  LIL = LI.len();
+    unsigned sp = 0; // span
+    unsigned span_end = LIL ? LI[0].nbytes : 0; // char position past span
 
-      if( DT_SAME == dt )
-      {
-        Style s    = Get_Style( m, pV, dl, vl, cp );
-        int   byte = pV->GetFB()->Get( vl, cp );
-        pV->PrintWorkingView_Set( LL, G_ROW, col, cp, byte, s );
-        cp++;
-      }
-      else if( DT_CHANGED == dt || DT_INSERTED == dt )
-      {
-        Style s    = Get_Style( m, pV, dl, vl, cp ); s = DiffStyle( s );
-        int   byte = pV->GetFB()->Get( vl, cp );
-        pV->PrintWorkingView_Set( LL, G_ROW, col, cp, byte, s );
-        cp++;
-      }
-      else if( DT_DELETED == dt )
-      {
-        Console::Set( G_ROW, Col_Win_2_GL( m, pV, col ), '-', S_DIFF_DEL );
-      }
-      else //( DT_UNKN0WN  == dt )
+    for( unsigned cp=m.leftChar; cp<LL && col<WC; cp++, col++ )
+    {
+      while( sp<LIL && span_end <= cp )
       {
-        Console::Set( G_ROW, Col_Win_2_GL( m, pV, col ), '~', S_DIFF_DEL );
+        sp++;
+        if( sp<LIL ) span_end += LI[sp].nbytes;
       }
+      if( LIL <= sp ) break;
+
+      Style s    = Get_Style( m, pV, dl, vl, cp );
+      int   byte = pV->GetFB()->Get( vl, cp );
+
+      if( DT_SAME != LI[sp].diff_type ) s = DiffStyle( s );
+
+      pV->PrintWorkingView_Set( LL, G_ROW, col, cp, byte, s );
     }
     for( ; col<WC; col++ )
     {
@@ -2377,17 +2743,33 @@ void PrintWorkingView( Diff::Data& m, View* pV )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
+  Perf_Timer perf( PERF_PRINT_VIEW );
+
   const unsigned NUM_LINES = NumLines(m);
   const unsigned WR        = WorkingRows( pV );
   const unsigned WC        = WorkingCols( pV );
 
+  // With IGN_BLANK, hunks of only blank lines are shown as same:
+  bool blank_hunk = false;
+
   unsigned row = 0; // (dl=diff line)
   for( unsigned dl=m.topLine; dl<NUM_LINES && row<WR; dl++, row++ )
   {
     const unsigned G_ROW = Row_Win_2_GL( m, pV, row );
     const Diff_Type DT = DiffType( m, pV, dl );
 
-    if( DT == DT_UNKN0WN )
+    if( DT == DT_SAME ) blank_hunk = false;
+    else if( (m.ignore & IGN_BLANK)
+          && (dl == m.topLine || DiffType( m, pV, dl-1 ) == DT_SAME) )
+    {
+      blank_hunk = Blank_Diff_Hunk( m, dl );
+    }
+    if( blank_hunk )
+    {
+      if( DT == DT_DELETED ) PrintWorkingView_DT_BLANK( m, pV, WC, G_ROW );
+      else PrintWorkingView_DT_INSERTED_SAME( m, pV, WC, G_ROW, dl, DT_SAME );
+    }
+    else if( DT == DT_UNKN0WN )
     {
       PrintWorkingView_DT_UNKN0WN( m, pV, WC, G_ROW );
     }
@@ -3141,6 +3523,23 @@ bool Do_N_Search_for_Same( Diff::Data& m
   return found;
 }
 
+// If the diff lines ending at dl are only blank lines ignored by
+// IGN_BLANK, moves dl before them and returns true
+bool Skip_N_Blank_Diff( Diff::Data& m
+                      , int& dl
+                      , const Array_t<Diff_Info>& DI_List )
+{
+  if( !(m.ignore & IGN_BLANK) ) return false;
+
+  int st = dl;
+  while( 0<st && DI_List[st-1].diff_type != DT_SAME ) st--;
+
+  if( !Blank_Diff_Lines( m, st, dl+1 ) ) return false;
+
+  dl = st-1;
+  return true;
+}
+
 // Look for difference based on Diff_Info:
 bool Do_N_Search_for_Diff_DT( Diff::Data& m
                             , int& dl
@@ -3160,7 +3559,7 @@ bool Do_N_Search_for_Diff_DT( Diff::Data& m
      || DT == DT_DELETED
      || DT == DT_DIFF_FILES )
     {
-      found_diff = true;
+      if( !Skip_N_Blank_Diff( m, dl, DI_List ) ) found_diff = true;
     }
     else dl--;
   }
@@ -3177,7 +3576,7 @@ bool Do_N_Search_for_Diff_DT( Diff::Data& m
        || DT == DT_DELETED
        || DT == DT_DIFF_FILES )
       {
-        found_diff = true;
+        if( !Skip_N_Blank_Diff( m, dl, DI_List ) ) found_diff = true;
       }
       else dl--;
     }
@@ -3273,7 +3672,7 @@ bool Do_N_Search_for_Diff( Diff::Data& m
   {
     found_diff = Do_N_Search_for_Diff_DT( m, dl, DI_List );
 
-    if( !found_diff )
+    if( !found_diff && !(m.ignore & IGN_SPACE) )
     {
       dl = dl_st;
       found_diff = Do_N_Search_for_Diff_WhiteSpace( m, dl, DI_List );
@@ -3323,6 +3722,29 @@ void Do_N_Diff( Diff::Data& m )
   }
 }
 
+// Remember diff line DPL was touched by a line insert or delete,
+// so Diff::ReAlign() can re-diff the hunk around it.
+// GREW is +1 if a diff line was added at DPL, -1 if removed, else 0.
+void Mark_ReAlign( Diff::Data& m, const unsigned DPL, const int GREW )
+{
+  if( !m.realign )
+  {
+    m.realign = true;
+    m.realign_st = DPL;
+    m.realign_fn = DPL;
+  }
+  else {
+    // Lines after DPL moved, so move the end of the range with them:
+    if( DPL <= m.realign_fn )
+    {
+      if     ( 0 < GREW                    ) m.realign_fn++;
+      else if( GREW < 0 && 0 < m.realign_fn ) m.realign_fn--;
+    }
+    m.realign_st = Min( m.realign_st, DPL );
+    m.realign_fn = Max( m.realign_fn, DPL );
+  }
+}
+
 // Since a line was just inserted, increment line numbers of all lines
 // following, and increment line number of inserted line if needed.
 void Patch_Diff_Info_Inserted_Inc( Diff::Data& m
@@ -3380,6 +3802,8 @@ void Diff::Patch_Diff_Info_Inserted( View* pV
 
     bool ok1 = cDI_List.insert( DI_Len, dic ); ASSERT( __LINE__, ok1, "ok1" );
     bool ok2 = oDI_List.insert( DI_Len, dio ); ASSERT( __LINE__, ok2, "ok2" );
+
+    Mark_ReAlign( m, DI_Len, 1 );
   }
   else { // Inserting into beginning or middle of Diff_Info lists:
     Diff_Info& cDI = cDI_List[ DPL ];
@@ -3395,7 +3819,7 @@ void Diff::Patch_Diff_Info_Inserted( View* pV
       const Line* ls = m.pfS->GetLineP( sDI.line_num ); // Line from short view
       const Line* ll = m.pfL->GetLineP( lDI.line_num ); // Line from long  view
 
-      if( ls->chksum() == ll->chksum() ) // Lines are now equal
+      if( Lines_Same( m, ls, ll ) ) // Lines are now equal
       {
         cDI.diff_type = DT_SAME;
         oDI.diff_type = DT_SAME;
@@ -3404,11 +3828,12 @@ void Diff::Patch_Diff_Info_Inserted( View* pV
         if( !sDI.pLineInfo ) sDI.pLineInfo = Borrow_LineInfo(m,__FILE__,__LINE__);
         if( !lDI.pLineInfo ) lDI.pLineInfo = Borrow_LineInfo(m,__FILE__,__LINE__);
 
-        Compare_Lines( ls, sDI.pLineInfo, ll, lDI.pLineInfo );
+        Compare_Lines( m, ls, sDI.pLineInfo, ll, lDI.pLineInfo );
 
         cDI.diff_type = DT_CHANGED;
         oDI.diff_type = DT_CHANGED;
       }
+      Mark_ReAlign( m, DPL, 0 );
     }
     else {
       unsigned dio_line = DT_DELETED==oDI.diff_type
@@ -3426,6 +3851,7 @@ void Diff::Patch_Diff_Info_Inserted( View* pV
       {
         cDI_List[ k ].line_num++;
       }
+      Mark_ReAlign( m, DPL, 1 );
     }
   }
 }
@@ -3450,6 +3876,8 @@ void Diff::Patch_Diff_Info_Deleted( View* pV, const unsigned DPL )
   {
     cDI.diff_type = DT_DELETED;
     oDI.diff_type = DT_INSERTED;
+
+    Mark_ReAlign( m, DPL, 0 );
   }
   else if( DT_CHANGED == cDI.diff_type )
   {
@@ -3458,6 +3886,8 @@ void Diff::Patch_Diff_Info_Deleted( View* pV, const unsigned DPL )
 
     Return_LineInfo( m, cDI.pLineInfo ); cDI.pLineInfo = 0;
     Return_LineInfo( m, oDI.pLineInfo ); oDI.pLineInfo = 0;
+
+    Mark_ReAlign( m, DPL, 0 );
   }
   else if( DT_INSERTED == cDI.diff_type )
   {
@@ -3466,6 +3896,8 @@ void Diff::Patch_Diff_Info_Deleted( View* pV, const unsigned DPL )
 
     ASSERT( __LINE__, ok1, "ok1" );
     ASSERT( __LINE__, ok2, "ok2" );
+
+    Mark_ReAlign( m, DPL, -1 );
   }
   // Removed a view line, so decrement current and all following view line numbers:
   for( unsigned k=DPL; k<cDI_List.len(); k++ )
@@ -3500,14 +3932,14 @@ void Diff::Patch_Diff_Info_Changed( View* pV, const unsigned DPL )
     if( !sDI.pLineInfo ) sDI.pLineInfo = Borrow_LineInfo(m,__FILE__,__LINE__);
     if( !lDI.pLineInfo ) lDI.pLineInfo = Borrow_LineInfo(m,__FILE__,__LINE__);
 
-    Compare_Lines( ls, sDI.pLineInfo, ll, lDI.pLineInfo );
+    Compare_Lines( m, ls, sDI.pLineInfo, ll, lDI.pLineInfo );
 
     cDI.diff_type = DT_CHANGED;
     oDI.diff_type = DT_CHANGED;
   }
   else if( DT_CHANGED == cDI.diff_type )
   {
-    if( ls->chksum() == ll->chksum() ) // Lines are now equal
+    if( Lines_Same( m, ls, ll ) ) // Lines are now equal
     {
       cDI.diff_type = DT_SAME;
       oDI.diff_type = DT_SAME;
@@ -3519,7 +3951,7 @@ void Diff::Patch_Diff_Info_Changed( View* pV, const unsigned DPL )
       if( !sDI.pLineInfo ) sDI.pLineInfo = Borrow_LineInfo(m,__FILE__,__LINE__);
       if( !lDI.pLineInfo ) lDI.pLineInfo = Borrow_LineInfo(m,__FILE__,__LINE__);
 
-      Compare_Lines( ls, sDI.pLineInfo, ll, lDI.pLineInfo );
+      Compare_Lines( m, ls, sDI.pLineInfo, ll, lDI.pLineInfo );
     }
   }
 }
@@ -5304,6 +5736,74 @@ Diff::~Diff()
   delete &m;
 }
 
+// Sets the line diff algorithm, myers or patience.
+// Returns false if name is not an algorithm.
+bool Diff::Set_Algo( const char* name )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  Diff_Algo algo = m.algo;
+
+  if( !Str_2_Diff_Algo( name, algo ) ) return false;
+
+  if( algo != m.algo )
+  {
+    m.algo = algo;
+    // Make the next Run() diff again:
+    m.mod_time_s = m.mod_time_l = -1;
+  }
+  return true;
+}
+
+const char* Diff::Get_Algo() const
+{
+  return Diff_Algo_2_Str( m.algo );
+}
+
+// Sets the differences between lines the diff ignores, from a comma
+// separated list of space, blank and case, or none.
+// Returns false if a name is not one of those.
+bool Diff::Set_Ignore( const char* names )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  unsigned ignore = 0;
+
+  for( const char* p = names; *p; )
+  {
+    const char* comma = strchr( p, ',' );
+    const unsigned LEN = comma ? comma - p : strlen( p );
+
+    if     ( 5==LEN && 0==strncmp( p, "space", LEN ) ) ignore |= IGN_SPACE;
+    else if( 5==LEN && 0==strncmp( p, "blank", LEN ) ) ignore |= IGN_BLANK;
+    else if( 4==LEN && 0==strncmp( p, "case" , LEN ) ) ignore |= IGN_CASE;
+    else if( 4==LEN && 0==strncmp( p, "none" , LEN ) ) ;
+    else return false;
+
+    p += comma ? LEN + 1 : LEN;
+  }
+  m.ignore_str.clear();
+  if( ignore & IGN_SPACE ) m.ignore_str.append("space,");
+  if( ignore & IGN_BLANK ) m.ignore_str.append("blank,");
+  if( ignore & IGN_CASE  ) m.ignore_str.append("case,");
+
+  if( m.ignore_str.len() ) m.ignore_str.pop();
+  else                     m.ignore_str = "none";
+
+  if( ignore != m.ignore )
+  {
+    m.ignore = ignore;
+    // Make the next Run() diff again:
+    m.mod_time_s = m.mod_time_l = -1;
+  }
+  return true;
+}
+
+const char* Diff::Get_Ignore() const
+{
+  return m.ignore_str.c_str();
+}
+
 // Returns true if diff took place, else false
 //
 bool Diff::Run( View* const pv0, View* const pv1 )
@@ -5337,7 +5837,8 @@ void Diff::Update()
 
   // Update long view:
   m.pfL->Find_Styles( ViewLine( m, m.pvL, m.topLine ) + WorkingRows( m.pvL ) );
-  m.pfL->Find_Regexs( ViewLine( m, m.pvL, m.topLine ), WorkingRows( m.pvL ) );
+  m.pfL->Find_Regexs( ViewLine( m, m.pvL, m.topLine ), WorkingRows( m.pvL )
+                    , m.leftChar, WorkingCols( m.pvL ) );
 
   RepositionViews( m );
 
@@ -5349,7 +5850,8 @@ void Diff::Update()
 
   // Update short view:
   m.pfS->Find_Styles( ViewLine( m, m.pvS, m.topLine ) + WorkingRows( m.pvS ) );
-  m.pfS->Find_Regexs( ViewLine( m, m.pvS, m.topLine ), WorkingRows( m.pvS ) );
+  m.pfS->Find_Regexs( ViewLine( m, m.pvS, m.topLine ), WorkingRows( m.pvS )
+                    , m.leftChar, WorkingCols( m.pvS ) );
 
   m.pvS->Print_Borders();
   PrintWorkingView( m, m.pvS );
@@ -6955,11 +7457,15 @@ DiffArea DL_st_fn_2_DiffArea( Diff::Data& m
 {
   DiffArea da;
 
-  da.ln_s = ( DT_DELETED == m.DI_List_S[ DL_st ].diff_type )
+  // A diff area starting on the first diff line starts on line zero,
+  // since DELETED lines at the top of the file come before line zero:
+  da.ln_s = ( 0 == DL_st ) ? 0
+          : ( DT_DELETED == m.DI_List_S[ DL_st ].diff_type )
           ? m.DI_List_S[DL_st].line_num+1
           : m.DI_List_S[DL_st].line_num;
 
-  da.ln_l = ( DT_DELETED == m.DI_List_L[ DL_st ].diff_type )
+  da.ln_l = ( 0 == DL_st ) ? 0
+          : ( DT_DELETED == m.DI_List_L[ DL_st ].diff_type )
           ? m.DI_List_L[DL_st].line_num+1
           : m.DI_List_L[DL_st].line_num;
 
@@ -7063,19 +7569,58 @@ unsigned Remove_From_DI_Lists( Diff::Data& m, DiffArea da )
                                ? m.DI_List_L.len()
                                : DiffLine_L( m, da.fnl_l() );
 
-  unsigned DI_list_remove_fn = Max( DI_list_s_remove_fn
-                                  , DI_list_l_remove_fn );
+  unsigned DI_list_remove_fn = Min( Max( DI_list_s_remove_fn
+                                       , DI_list_l_remove_fn )
+                                  , m.DI_List_L.len() );
 //Log.Log("(DI_list_remove_st,DI_list_remove_fn) = ("
 //       + (DI_list_remove_st+1)+","+(DI_list_remove_fn+1) +")");
 
-  for( unsigned k=DI_list_remove_st; k<DI_list_remove_fn; k++ )
+  if( DI_list_remove_st < DI_list_remove_fn )
   {
-    m.DI_List_S.remove( DI_lists_insert_idx );
-    m.DI_List_L.remove( DI_lists_insert_idx );
+    for( unsigned k=DI_list_remove_st; k<DI_list_remove_fn; k++ )
+    {
+      Return_LineInfo( m, m.DI_List_S[k].pLineInfo );
+      Return_LineInfo( m, m.DI_List_L[k].pLineInfo );
+    }
+    // Remove the whole area at once instead of a line at a time:
+    const unsigned NUM_REMOVE = DI_list_remove_fn - DI_list_remove_st;
+
+    m.DI_List_S.remove_n( DI_lists_insert_idx, NUM_REMOVE );
+    m.DI_List_L.remove_n( DI_lists_insert_idx, NUM_REMOVE );
   }
   return DI_lists_insert_idx;
 }
 
+// Re-diff the diff area found around diff lines DL_st up to DL_fn.
+// Returns success or failure
+bool ReDiff_Lines( Diff::Data& m, const unsigned DL_st, const unsigned DL_fn )
+{
+  DiffArea da;
+  const bool found_diff_area = ReDiff_GetDiffArea( m, DL_st, DL_fn, da );
+
+  if( found_diff_area )
+  {
+  //Log.Log("ReDiff DiffArea:"); da.Print();
+    const unsigned INS_IDX = Remove_From_DI_Lists( m, da );
+    m.DI_L_ins_idx = INS_IDX;
+
+    m.DI_Stage_S.clear();
+    m.DI_Stage_L.clear();
+    m.DI_L_staged = true;
+
+    RunDiff( m, da );
+
+    m.DI_L_staged = false;
+    m.DI_List_S.insert( INS_IDX, m.DI_Stage_S );
+    m.DI_List_L.insert( INS_IDX, m.DI_Stage_L );
+    m.DI_Stage_S.clear();
+    m.DI_Stage_L.clear();
+
+    m.realign = false;
+  }
+  return found_diff_area;
+}
+
 // Returns success or failure
 bool Diff::ReDiff()
 {
@@ -7089,27 +7634,69 @@ bool Diff::ReDiff()
   {
     DL_fn = NUM_DLs-SIDE_BAND < DL ? NUM_DLs : DL + SIDE_BAND;
   }
-  DiffArea da;
-  const bool found_diff_area = ReDiff_GetDiffArea( m, DL_st, DL_fn, da );
-
-  if( !found_diff_area )
+  if( !ReDiff_Lines( m, DL_st, DL_fn ) )
   {
     m.vis.CmdLineMessage("rediff: DiffArea not found");
     PrintCursor( m.vis.CV() );
   }
   else {
     ok = true;
-  //Log.Log("ReDiff DiffArea:"); da.Print();
-
-    m.DI_L_ins_idx = Remove_From_DI_Lists( m, da );
-
-    RunDiff( m, da );
   //Update();
     m.vis.UpdateViews( false );
   }
   return ok;
 }
 
+// Lines inserted or deleted while editing are patched into the diff as
+// INSERTED and DELETED lines, which may leave a hunk mis-aligned.
+// Re-diff just the hunk around the edited lines, keeping the cursor on
+// the same view line.
+void Diff::ReAlign()
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const unsigned NUM_DLs = m.DI_List_L.len();
+
+  if( m.realign && 0 < NUM_DLs )
+  {
+    View* pV = m.vis.CV();
+
+    const unsigned VL = ViewLine( m, pV, CrsLine(m) );
+    const unsigned DL_st = Min( m.realign_st, NUM_DLs-1 );
+    const unsigned DL_fn = Min( m.realign_fn, NUM_DLs-1 );
+
+    if( ReDiff_Lines( m, DL_st, DL_fn ) )
+    {
+      // Dont report the time of a re-align as the time of the diff:
+      m.printed_diff_ms = true;
+
+      GoToCrsPos_NoWrite( DiffLine( pV, VL ), CrsChar(m) );
+      m.vis.UpdateViews( false );
+    }
+  }
+  m.realign = false;
+}
+
+// Diffs the files again from the start, after the algorithm or the
+// differences ignored changed, keeping the cursor on the same view line.
+void Diff::ReRun()
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  View* pV  = m.vis.CV();
+  View* pvS = m.pvS;
+  View* pvL = m.pvL;
+
+  const unsigned VL = ViewLine( m, pV, CrsLine(m) );
+  const unsigned CC = CrsChar(m);
+
+  if( Run( pvS, pvL ) )
+  {
+    GoToCrsPos_NoWrite( DiffLine( pV, VL ), CC );
+    m.vis.UpdateViews( false );
+  }
+}
+
 void Diff::Set_Cmd_Line_Msg( const String& msg )
 {
   m.cmd_line_msg = msg;
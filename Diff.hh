@@ -35,6 +35,10 @@ public:
   ~Diff();
 
   bool   Run( View* const pv0, View* const pv1 );
+  bool   Set_Algo( const char* name );
+  const char* Get_Algo() const;
+  bool   Set_Ignore( const char* names );
+  const char* Get_Ignore() const;
   void ClearDiff();
   void Update();
 
@@ -122,6 +126,8 @@ public:
   void PrintCursor( View* pV );
   bool Update_Status_Lines();
   bool ReDiff();
+  void ReAlign();
+  void ReRun();
 
   void Set_Cmd_Line_Msg( const String& msg );
   void DisplayMapping();
@@ -0,0 +1,642 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+// Times the line diff engine, and checks its results, on generated
+// workloads from 1K to 1M lines, or more with -n, or on real file pairs.
+// Build with: make vis-diffbench
+// Run with:   vis-diffbench [-n max lines] [-t threads]
+//        or:  vis-diffbench [-t threads] path_0 path_1
+// path_0 and path_1 are two files, or two directories, like two
+// checkouts of a repository, whose files of the same name are diffed.
+// Each diff reports the time to give lines ids and to diff the ids,
+// the peak memory used by the diff, the number of hunks, and whether
+// applying the hunks to the short file gives back the long file, and
+// for patience, whether one thread and several give the same runs.
+
+#include <stdio.h>     // printf, snprintf, FILE, fopen, fread
+#include <stdlib.h>    // atol
+#include <string.h>    // memcmp, strcmp, strlen, strncmp
+#include <dirent.h>    // opendir, readdir, closedir
+#include <sys/stat.h>  // stat, lstat
+#include <sys/time.h>  // gettimeofday
+#if defined(LINUX)
+#include <malloc.h>    // malloc_trim
+#endif
+
+#include "Hash.hh"
+#include "Diff_Engine.hh"
+
+static unsigned m_seed = 2463534242u;
+
+static unsigned Rand()
+{
+  m_seed ^= m_seed << 13;
+  m_seed ^= m_seed >> 17;
+  m_seed ^= m_seed << 5;
+  return m_seed;
+}
+
+static double Secs()
+{
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + tv.tv_usec*1e-6;
+}
+
+#if defined(LINUX)
+// Returns the value of key from /proc/self/status, in KB
+static long Status_KB( const char* key )
+{
+  long kb = 0;
+  FILE* fp = fopen("/proc/self/status", "r");
+  if( fp )
+  {
+    const unsigned KEY_LEN = strlen( key );
+    char line[256];
+    while( fgets( line, sizeof(line), fp ) )
+    {
+      if( 0 == strncmp( line, key, KEY_LEN ) ) kb = atol( line + KEY_LEN );
+    }
+    fclose( fp );
+  }
+  return kb;
+}
+
+// Starts measuring peak memory from now.  Freed memory is given back
+// first, so the diff does not reuse memory that is already counted.
+static long Mem_Start()
+{
+  malloc_trim( 0 );
+
+  FILE* fp = fopen("/proc/self/clear_refs", "w");
+  if( fp ) { fputs("5", fp ); fclose( fp ); }
+
+  return Status_KB("VmRSS:");
+}
+
+// Peak memory since Mem_Start(), in KB
+static long Mem_Peak( const long start ) { return Status_KB("VmHWM:") - start; }
+#else
+static long Mem_Start() { return 0; }
+static long Mem_Peak( const long start ) { return 0; }
+#endif
+
+// Lines of a file, kept in one array of chars
+struct Text
+{
+  Array_t<char>     chars;
+  Array_t<unsigned> ends; // End of each line in chars
+
+  void clear() { chars.clear(); ends.clear(); }
+
+  unsigned Num_Lines() const { return ends.len(); }
+
+  const char* Line( const unsigned k, unsigned& len ) const
+  {
+    const unsigned st = 0<k ? ends[k-1] : 0;
+    len = ends[k] - st;
+    return 0<len ? const_cast<Text*>( this )->chars.get( st ) : "";
+  }
+  void Add( const char* s, const unsigned len )
+  {
+    for( unsigned k=0; k<len; k++ ) chars.push( s[k] );
+    ends.push( chars.len() );
+  }
+  // Adds line k of t, with pre added before it and post after it
+  void Add( const Text& t, const unsigned k
+          , const char* pre = "", const char* post = "" )
+  {
+    unsigned len = 0;
+    const char* line = t.Line( k, len );
+
+    for( ; *pre; pre++ ) chars.push( *pre );
+    for( unsigned j=0; j<len; j++ ) chars.push( line[j] );
+    for( ; *post; post++ ) chars.push( *post );
+    ends.push( chars.len() );
+  }
+};
+
+// Lines like blank lines and closing braces, common in source code:
+static const char* COMMON_LINES[] = { "", "}", "  }", "{", "    break;"
+                                    , "  return 0;", "#endif", "  else {" };
+static const unsigned NUM_COMMON = sizeof(COMMON_LINES)/sizeof(char*);
+
+// One line in five is a common line, and the others are all different
+static void Add_Rand_Line( Text& t )
+{
+  if( 0 == Rand()%5 )
+  {
+    const char* line = COMMON_LINES[ Rand()%NUM_COMMON ];
+    t.Add( line, strlen( line ) );
+  }
+  else {
+    char line[64];
+    const int len = snprintf( line, sizeof(line), "%*sx%u = f( y%u, %u );"
+                            , 2 + 2*(Rand()%4), "", Rand()%100000
+                            , Rand(), Rand()%1000 );
+    t.Add( line, len );
+  }
+}
+
+static void Make_Rand( const unsigned NUM, Text& t )
+{
+  t.clear();
+  for( unsigned k=0; k<NUM; k++ ) Add_Rand_Line( t );
+}
+
+// Workload: an insert, delete or change of one to eight lines every
+// 100 lines on average
+static void Make_Edits( const Text& o, Text& n )
+{
+  const unsigned NUM = o.Num_Lines();
+  n.clear();
+
+  for( unsigned k=0; k<NUM; )
+  {
+    if( 0 == Rand()%100 )
+    {
+      const unsigned LEN = 1 + Rand()%8;
+      const unsigned EDIT = Rand()%3;
+
+      if( 0 != EDIT ) // Insert or change
+      {
+        for( unsigned j=0; j<LEN; j++ ) Add_Rand_Line( n );
+      }
+      if( 1 != EDIT ) k += LEN; // Delete or change
+    }
+    else n.Add( o, k++ );
+  }
+}
+
+// Workload: blocks of one to 50 lines, one in 20 of them moved down
+// past up to 200 other blocks
+static void Make_Moves( const Text& o, Text& n )
+{
+  const unsigned NUM = o.Num_Lines();
+  n.clear();
+
+  struct Block { unsigned st, fn, wait; };
+  Array_t<Block> moved;
+
+  for( unsigned k=0; k<NUM; )
+  {
+    const unsigned LEN = 1 + Rand()%50;
+    const Block B = { k, NUM < k+LEN ? NUM : k+LEN, 1 + Rand()%200 };
+    k = B.fn;
+
+    if( 0 == Rand()%20 ) moved.push( B );
+    else {
+      for( unsigned j=B.st; j<B.fn; j++ ) n.Add( o, j );
+    }
+    // Put down moved blocks that have waited long enough:
+    for( unsigned m=0; m<moved.len(); )
+    {
+      if( k < NUM && 0 < --moved[m].wait ) { m++; continue; }
+
+      for( unsigned j=moved[m].st; j<moved[m].fn; j++ ) n.Add( o, j );
+      moved.remove( m );
+    }
+  }
+}
+
+// Workload: runs of 5 to 50 lines re-indented, or given trailing
+// spaces, every 200 lines on average
+static void Make_Space( const Text& o, Text& n )
+{
+  const unsigned NUM = o.Num_Lines();
+  n.clear();
+
+  for( unsigned k=0; k<NUM; )
+  {
+    if( 0 == Rand()%200 )
+    {
+      const unsigned FN = NUM < k+5+Rand()%46 ? NUM : k+5+Rand()%46;
+      const bool INDENT = Rand()%2;
+
+      for( ; k<FN; k++ ) n.Add( o, k, INDENT ? "  " : "", INDENT ? "" : " " );
+    }
+    else n.Add( o, k++ );
+  }
+}
+
+// Workload: the middle half of the lines replaced by new lines
+static void Make_Hunk( const Text& o, Text& n )
+{
+  const unsigned NUM = o.Num_Lines();
+  n.clear();
+
+  for( unsigned k=0; k<NUM; k++ )
+  {
+    if( NUM/4 <= k && k < 3*NUM/4 ) Add_Rand_Line( n );
+    else                             n.Add( o, k );
+  }
+}
+
+// Workload: both files start with the first 100 lines of r, and every
+// NUM/50 lines two of them, in turn, are put in again, after a line in
+// o and before it in n.  They are unique only once the common prefix
+// is trimmed, and then the diff anchors on them instead of on the line,
+// so the runs change if some threads do not trim the prefix.
+static void Make_Repeats( const Text& r, Text& o, Text& n )
+{
+  const unsigned NUM   = r.Num_Lines();
+  const unsigned SPACE = NUM/50 + 1;
+  o.clear();
+  n.clear();
+
+  unsigned next = 0;
+  for( unsigned k=0; k<NUM; k++ )
+  {
+    if( 100 <= k && 0 == k%SPACE && next+1 < 100 )
+    {
+      o.Add( r, k ); o.Add( r, next ); o.Add( r, next+1 );
+      n.Add( r, next ); n.Add( r, next+1 ); n.Add( r, k );
+      next += 2;
+    }
+    else {
+      o.Add( r, k );
+      n.Add( r, k );
+    }
+  }
+}
+
+struct Result
+{
+  double   ids_ms;  // Time to give lines ids
+  double   diff_ms; // Time to diff the ids
+  long     mem_kb;  // Peak memory used by the diff
+  unsigned lines;   // Lines in the long file
+  unsigned hunks;   // Areas of differing lines
+  unsigned same;    // Lines the same
+  bool     ok;      // Hunks applied to short file give long file, and
+                    // one thread gives the same runs as several
+};
+
+static bool Same_Line( const Text& s, const unsigned ln_s
+                     , const Text& l, const unsigned ln_l )
+{
+  unsigned len_s = 0, len_l = 0;
+  const char* line_s = s.Line( ln_s, len_s );
+  const char* line_l = l.Line( ln_l, len_l );
+
+  return len_s == len_l && 0 == memcmp( line_s, line_l, len_s );
+}
+
+// Applies the hunks between runs to s, and returns true if that gives
+// back l: the runs must be in order, inside the files, and the lines of
+// each run the same in s and l.  Lines of l between runs are taken as
+// they are, and lines of s between runs are dropped.
+static bool Apply( const Text& s, const Text& l
+                 , const Array_t<Same_Run>& runs, Result& r )
+{
+  unsigned fn_s = 0, fn_l = 0;
+  r.same  = 0;
+  r.hunks = 0;
+
+  for( unsigned k=0; k<=runs.len(); k++ )
+  {
+    // Past the last run is an empty run at the ends of the files:
+    Same_Run R = { s.Num_Lines(), l.Num_Lines(), 0 };
+    if( k<runs.len() ) R = runs[k];
+
+    if( R.ln_s < fn_s || R.ln_l < fn_l ) return false;
+    if( s.Num_Lines() < R.ln_s + R.nlines
+     || l.Num_Lines() < R.ln_l + R.nlines ) return false;
+
+    if( fn_s < R.ln_s || fn_l < R.ln_l ) r.hunks++;
+
+    for( unsigned j=0; j<R.nlines; j++ )
+    {
+      if( !Same_Line( s, R.ln_s+j, l, R.ln_l+j ) ) return false;
+    }
+    fn_s = R.ln_s + R.nlines;
+    fn_l = R.ln_l + R.nlines;
+    r.same += R.nlines;
+  }
+  return true;
+}
+
+static bool Same_Runs( const Array_t<Same_Run>& a, const Array_t<Same_Run>& b )
+{
+  if( a.len() != b.len() ) return false;
+
+  for( unsigned k=0; k<a.len(); k++ )
+  {
+    if( a[k].ln_s   != b[k].ln_s
+     || a[k].ln_l   != b[k].ln_l
+     || a[k].nlines != b[k].nlines ) return false;
+  }
+  return true;
+}
+
+// Diffs the ids again with one thread, or with two if the first diff
+// used one, and returns true if that gives the same runs
+static bool Same_On_Threads( Array_t<unsigned>& ids_s
+                           , Array_t<unsigned>& ids_l
+                           , const unsigned num_ids
+                           , const Array_t<Same_Run>& runs )
+{
+  const unsigned NUM_THREADS = Diff_Num_Threads();
+  Array_t<Same_Run> runs_2;
+
+  Diff_Set_Threads( NUM_THREADS < 2 ? 2 : 1 );
+  Diff_Ids( ids_s.get(0), ids_s.len()
+          , ids_l.get(0), ids_l.len(), num_ids, DA_PATIENCE, runs_2 );
+  Diff_Set_Threads( NUM_THREADS );
+
+  return Same_Runs( runs, runs_2 );
+}
+
+// Diffs t_0 and t_1 the way vis does: the shorter is the short file,
+// lines get ids by a 64-bit hash, and the ids are diffed
+static void Bench( const Text& t_0, const Text& t_1, const Diff_Algo algo
+                 , Result& r )
+{
+  const Text& s = t_1.Num_Lines() < t_0.Num_Lines() ? t_1 : t_0;
+  const Text& l = t_1.Num_Lines() < t_0.Num_Lines() ? t_0 : t_1;
+
+  Line_Ids          line_ids;
+  Array_t<unsigned> ids_s( s.Num_Lines() );
+  Array_t<unsigned> ids_l( l.Num_Lines() );
+  Array_t<Same_Run> runs;
+
+  const double t1 = Secs();
+
+  for( unsigned k=0; k<s.Num_Lines(); k++ )
+  {
+    unsigned len = 0;
+    const char* line = s.Line( k, len );
+    ids_s.push( line_ids.Id( Hash_64( line, len ), line, len ) );
+  }
+  for( unsigned k=0; k<l.Num_Lines(); k++ )
+  {
+    unsigned len = 0;
+    const char* line = l.Line( k, len );
+    ids_l.push( line_ids.Id( Hash_64( line, len ), line, len ) );
+  }
+  const long   mem = Mem_Start();
+  const double t2  = Secs();
+
+  Diff_Ids( ids_s.get(0), ids_s.len()
+          , ids_l.get(0), ids_l.len(), line_ids.Num_Ids(), algo, runs );
+
+  const double t3 = Secs();
+
+  r.mem_kb  = Mem_Peak( mem );
+  r.ids_ms  = (t2-t1)*1000;
+  r.diff_ms = (t3-t2)*1000;
+  r.lines   = l.Num_Lines();
+  r.ok      = Apply( s, l, runs, r );
+
+  if( DA_PATIENCE == algo && r.ok )
+  {
+    r.ok = Same_On_Threads( ids_s, ids_l, line_ids.Num_Ids(), runs );
+  }
+}
+
+static const Diff_Algo ALGOS[] = { DA_MYERS, DA_PATIENCE };
+static const unsigned  NUM_ALGOS = 2;
+
+static void Print_Header( const char* first )
+{
+  printf("%-8s %10s %8s %9s %9s %9s %8s %10s %6s\n"
+        , first, "lines", "algo", "ids ms", "diff ms", "mem KB"
+        , "hunks", "same", "check" );
+}
+
+static void Print_Result( const char* first, const Diff_Algo algo
+                        , const Result& r )
+{
+  printf("%-8s %10u %8s %9.1f %9.1f %9ld %8u %10u %6s\n"
+        , first, r.lines, Diff_Algo_2_Str( algo ), r.ids_ms, r.diff_ms
+        , r.mem_kb, r.hunks, r.same, r.ok ? "ok" : "FAILED" );
+}
+
+// Returns the number of failed checks
+static unsigned Bench_Generated( const unsigned MAX_LINES )
+{
+  struct Workload
+  {
+    const char* name;
+    void      (*make)( const Text& o, Text& n );
+  };
+  const Workload loads[] = { { "edits" , Make_Edits }
+                           , { "moves" , Make_Moves }
+                           , { "space" , Make_Space }
+                           , { "hunk"  , Make_Hunk  }
+                           , { "repeat", 0          } }; // Make_Repeats()
+  Text o, n, base;
+  unsigned failed = 0;
+
+  Print_Header("workload");
+
+  for( unsigned w=0; w<sizeof(loads)/sizeof(Workload); w++ )
+  {
+    for( unsigned num=1000; num<=MAX_LINES; num*=10 )
+    {
+      if( loads[w].make )
+      {
+        Make_Rand( num, o );
+        loads[w].make( o, n );
+      }
+      else {
+        Make_Rand( num, base );
+        Make_Repeats( base, o, n );
+      }
+
+      for( unsigned a=0; a<NUM_ALGOS; a++ )
+      {
+        Result r;
+        Bench( o, n, ALGOS[a], r );
+        Print_Result( loads[w].name, ALGOS[a], r );
+        if( !r.ok ) failed++;
+      }
+    }
+  }
+  return failed;
+}
+
+static bool Read_File( const char* path, Text& t )
+{
+  t.clear();
+
+  FILE* fp = fopen( path, "rb" );
+  if( !fp ) return false;
+
+  char buf[ 64*1024 ];
+  size_t got = 0;
+  while( 0 < (got = fread( buf, 1, sizeof(buf), fp )) )
+  {
+    for( size_t k=0; k<got; k++ )
+    {
+      if( '\n' == buf[k] ) t.ends.push( t.chars.len() );
+      else                 t.chars.push( buf[k] );
+    }
+  }
+  // Last line without a newline:
+  if( t.chars.len() && (0 == t.ends.len() || t.ends[ t.ends.len()-1 ] < t.chars.len()) )
+  {
+    t.ends.push( t.chars.len() );
+  }
+  fclose( fp );
+  return true;
+}
+
+// Totals of the file pairs diffed with one algorithm
+struct Totals
+{
+  unsigned pairs;
+  unsigned lines;
+  double   ms;
+  long     max_mem_kb;
+  unsigned hunks;
+  unsigned failed;
+};
+
+// Diffs the file pair at path_0 and path_1, printing a line per
+// algorithm if the files differ
+static void Bench_Pair( const char* path_0, const char* path_1
+                      , Totals* totals )
+{
+  Text t_0, t_1;
+  if( !Read_File( path_0, t_0 ) || !Read_File( path_1, t_1 ) )
+  {
+    printf("Could not read %s or %s\n", path_0, path_1 );
+    return;
+  }
+  for( unsigned a=0; a<NUM_ALGOS; a++ )
+  {
+    Result r;
+    Bench( t_0, t_1, ALGOS[a], r );
+
+    Totals& T = totals[a];
+    T.pairs++;
+    T.lines += r.lines;
+    T.ms    += r.ids_ms + r.diff_ms;
+    T.hunks += r.hunks;
+    if( T.max_mem_kb < r.mem_kb ) T.max_mem_kb = r.mem_kb;
+    if( !r.ok ) T.failed++;
+
+    if( r.hunks || !r.ok )
+    {
+      Print_Result("pair", ALGOS[a], r );
+      printf("  %s\n", path_1 );
+    }
+  }
+}
+
+// Links are not followed, so each file is diffed once
+static bool Is_Dir( const char* path )
+{
+  struct stat sbuf;
+  return 0 == lstat( path, &sbuf ) && S_ISDIR( sbuf.st_mode );
+}
+
+static bool Is_Reg( const char* path )
+{
+  struct stat sbuf;
+  return 0 == lstat( path, &sbuf ) && S_ISREG( sbuf.st_mode );
+}
+
+// Diffs the regular files with the same names under dir_0 and dir_1
+static void Bench_Dirs( const char* dir_0, const char* dir_1
+                      , Totals* totals )
+{
+  DIR* dp = opendir( dir_0 );
+  if( !dp ) return;
+
+  while( struct dirent* de = readdir( dp ) )
+  {
+    const char* name = de->d_name;
+    if( 0==strcmp( name, "." ) || 0==strcmp( name, ".." )
+     || 0==strcmp( name, ".git" ) ) continue;
+
+    char path_0[ 4096 ];
+    char path_1[ 4096 ];
+    if( sizeof(path_0) <= (unsigned)snprintf( path_0, sizeof(path_0), "%s/%s", dir_0, name )
+     || sizeof(path_1) <= (unsigned)snprintf( path_1, sizeof(path_1), "%s/%s", dir_1, name ) )
+    {
+      continue;
+    }
+    if( Is_Reg( path_0 ) && Is_Reg( path_1 ) )
+    {
+      Bench_Pair( path_0, path_1, totals );
+    }
+    else if( Is_Dir( path_0 ) && Is_Dir( path_1 ) )
+    {
+      Bench_Dirs( path_0, path_1, totals );
+    }
+  }
+  closedir( dp );
+}
+
+// Returns the number of failed checks
+static unsigned Bench_Files( const char* path_0, const char* path_1 )
+{
+  Totals totals[ NUM_ALGOS ] = {};
+
+  Print_Header("");
+
+  if( Is_Dir( path_0 ) && Is_Dir( path_1 ) )
+  {
+    Bench_Dirs( path_0, path_1, totals );
+  }
+  else Bench_Pair( path_0, path_1, totals );
+
+  unsigned failed = 0;
+  for( unsigned a=0; a<NUM_ALGOS; a++ )
+  {
+    const Totals& T = totals[a];
+    printf("%-8s: %u file pairs, %u lines, %.1f ms, max %ld KB, %u hunks, %u FAILED\n"
+          , Diff_Algo_2_Str( ALGOS[a] ), T.pairs, T.lines, T.ms
+          , T.max_mem_kb, T.hunks, T.failed );
+    failed += T.failed;
+  }
+  return failed;
+}
+
+static int Usage( const char* prog )
+{
+  fprintf( stderr, "usage: %s [-n max lines] [-t threads] [path_0 path_1]\n", prog );
+  return 2;
+}
+
+int main( int argc, char* argv[] )
+{
+  unsigned max_lines = 1000*1000;
+
+  int k = 1;
+  for( ; k+1<argc && '-' == argv[k][0]; k+=2 )
+  {
+    if     ( 0==strcmp( argv[k], "-n" ) ) max_lines = atol( argv[k+1] );
+    else if( 0==strcmp( argv[k], "-t" ) ) Diff_Set_Threads( atol( argv[k+1] ) );
+    else return Usage( argv[0] );
+  }
+  unsigned failed = 0;
+
+  if     ( k == argc )   failed = Bench_Generated( max_lines );
+  else if( k+2 == argc ) failed = Bench_Files( argv[k], argv[k+1] );
+  else return Usage( argv[0] );
+
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,1156 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>      // sqrt
+#include <string.h>    // strcmp, memcmp
+#if defined(__SSE2__)
+#include <emmintrin.h> // _mm_cmpeq_epi8, _mm_movemask_epi8
+#endif
+#if !defined(WIN32)
+#include <pthread.h>
+#include <unistd.h>    // sysconf
+#endif
+
+#include "Diff_Engine.hh"
+
+// Myers searches give up after this many differences in one region,
+// unless the square root of the number of lines diffed is larger, and
+// split the region at the furthest point reached.  This bounds the
+// time spent on regions that have almost nothing in common:
+static const unsigned MIN_MAX_COST = 256;
+
+// Patience diffs of at least this many lines, counting both sides,
+// are cut at anchors and done on several threads:
+static const unsigned PARALLEL_MIN_LINES = 100*1000;
+static const unsigned MAX_DIFF_THREADS   = 64;
+
+// Char diffs with more edits than this, not counting the common
+// prefix and suffix, just show the middle of the line as changed:
+static const int MAX_CHAR_COST = 128;
+
+// Pair_Lines() keeps NUM_MIN_HASH MinHash values per line, looks at up
+// to MAX_BUCKET_CANDS lines sharing each value, and confirms the best
+// MAX_CONFIRM candidates of each line with a char diff:
+static const unsigned NUM_MIN_HASH     = 8;
+static const unsigned MAX_BUCKET_CANDS = 3;
+static const unsigned MAX_CONFIRM      = 6;
+
+// Part of the two sequences waiting to be diffed, or if same is
+// set, a run of same lines waiting to be added to the results.
+struct Region
+{
+  unsigned st_s, fn_s; // [st_s,fn_s) of short sequence
+  unsigned st_l, fn_l; // [st_l,fn_l) of long  sequence
+  bool     same;
+  bool     patience;   // Look for unique line anchors in region
+};
+
+struct Engine
+{
+  const unsigned* ids_s;
+  const unsigned* ids_l;
+  int             max_cost;
+
+  Array_t<Same_Run>& runs;
+  Array_t<Region>    todo;  // Stack of regions, last one is done first
+
+  Array_t<int> v_fw; // Furthest x on each diagonal, forward  search
+  Array_t<int> v_bw; // Furthest x on each diagonal, backward search
+
+  // Times each id appears in a region, up to 2, and its position:
+  Array_t<unsigned char> cnt_s;
+  Array_t<unsigned char> cnt_l;
+  Array_t<unsigned> pos_l;
+
+  // If local_ids is set, the ids of each region are renumbered from 0
+  // before counting, so the counts are only as long as the region:
+  bool              local_ids;
+  Array_t<unsigned> map_key; // Hash table of id+1, 0 if empty
+  Array_t<unsigned> map_val; // Local id of map_key
+  Array_t<unsigned> loc_s;   // Local ids of region, short
+  Array_t<unsigned> loc_l;   // Local ids of region, long
+
+  Array_t<unsigned> anch_s; // Candidate anchor line numbers, short
+  Array_t<unsigned> anch_l; // Candidate anchor line numbers, long
+  Array_t<unsigned> tails;  // Patience sort pile tops
+  Array_t<unsigned> prev;   // Previous anchor in longest sequence
+
+  Engine( const unsigned* ids_s, const unsigned* ids_l
+        , const unsigned max_cost, Array_t<Same_Run>& runs )
+    : ids_s( ids_s )
+    , ids_l( ids_l )
+    , max_cost( max_cost )
+    , runs( runs )
+    , local_ids( false )
+  {}
+};
+
+static void Add_Same( Engine& e, const unsigned ln_s, const unsigned ln_l
+                    , const unsigned nlines )
+{
+  if( 0 == nlines ) return;
+
+  const unsigned LEN = e.runs.len();
+
+  if( LEN )
+  {
+    Same_Run& last = e.runs[ LEN-1 ];
+
+    if( last.ln_s + last.nlines == ln_s
+     && last.ln_l + last.nlines == ln_l )
+    {
+      last.nlines += nlines;
+      return;
+    }
+  }
+  Same_Run run = { ln_s, ln_l, nlines };
+  e.runs.push( run );
+}
+
+static void Push_Same( Engine& e, const unsigned ln_s, const unsigned ln_l
+                     , const unsigned nlines )
+{
+  Region r = { ln_s, ln_s + nlines, ln_l, ln_l + nlines, true, false };
+  e.todo.push( r );
+}
+
+static void Push_Region( Engine& e
+                       , const unsigned st_s, const unsigned fn_s
+                       , const unsigned st_l, const unsigned fn_l
+                       , const bool patience )
+{
+  // Nothing can be the same if either side is empty:
+  if( st_s < fn_s && st_l < fn_l )
+  {
+    Region r = { st_s, fn_s, st_l, fn_l, false, patience };
+    e.todo.push( r );
+  }
+}
+
+// Finds a point (x,y) on the middle of an edit path from (0,0) to (N,M)
+// by running the Myers search forward from the start and backward from
+// the end until they meet.  If the search costs more than e.max_cost,
+// returns the point furthest along either search instead.  Returns
+// false if A and B have nothing in common.
+static bool Myers_Split( Engine& e
+                       , const unsigned* A, const int N
+                       , const unsigned* B, const int M
+                       , int& x, int& y )
+{
+  const int MAX_D  = (N + M + 1)/2;
+  const int D_LIM  = MAX_D < e.max_cost ? MAX_D : e.max_cost;
+  const int OFFSET = D_LIM + 1;
+  const int V_LEN  = 2*D_LIM + 3;
+
+  // Arrays only grow, since Array_t::set_len() shrinks one at a time:
+  if( e.v_fw.len() < unsigned(V_LEN) ) e.v_fw.set_len( V_LEN );
+  if( e.v_bw.len() < unsigned(V_LEN) ) e.v_bw.set_len( V_LEN );
+  int* v_fw = e.v_fw.get( 0 );
+  int* v_bw = e.v_bw.get( 0 );
+  for( int K=0; K<V_LEN; K++ ) v_fw[K] = v_bw[K] = -1;
+  v_fw[ OFFSET+1 ] = 0;
+  v_bw[ OFFSET+1 ] = 0;
+
+  const int  DELTA = N - M;
+  const bool FRONT = 0 != DELTA % 2; // Forward search finds the overlap
+
+  // Diagonals that ran off the edges are skipped:
+  int k_fw_st = 0, k_fw_fn = 0;
+  int k_bw_st = 0, k_bw_fn = 0;
+
+  for( int d=0; d<D_LIM; d++ )
+  {
+    for( int k=-d+k_fw_st; k<=d-k_fw_fn; k+=2 )
+    {
+      const int K = OFFSET + k;
+      int x1 = ( k == -d || ( k != d && v_fw[K-1] < v_fw[K+1] ) )
+             ? v_fw[K+1] : v_fw[K-1] + 1;
+      int y1 = x1 - k;
+      while( x1 < N && y1 < M && A[x1] == B[y1] ) { x1++; y1++; }
+      v_fw[K] = x1;
+
+      if     ( N < x1 ) k_fw_fn += 2;
+      else if( M < y1 ) k_fw_st += 2;
+      else if( FRONT )
+      {
+        const int K_BW = OFFSET + DELTA - k;
+        if( 0 <= K_BW && K_BW < V_LEN && -1 != v_bw[K_BW]
+         && N - v_bw[K_BW] <= x1 )
+        {
+          x = x1; y = y1; return true;
+        }
+      }
+    }
+    for( int k=-d+k_bw_st; k<=d-k_bw_fn; k+=2 )
+    {
+      const int K = OFFSET + k;
+      int x2 = ( k == -d || ( k != d && v_bw[K-1] < v_bw[K+1] ) )
+             ? v_bw[K+1] : v_bw[K-1] + 1;
+      int y2 = x2 - k;
+      while( x2 < N && y2 < M && A[N-x2-1] == B[M-y2-1] ) { x2++; y2++; }
+      v_bw[K] = x2;
+
+      if     ( N < x2 ) k_bw_fn += 2;
+      else if( M < y2 ) k_bw_st += 2;
+      else if( !FRONT )
+      {
+        const int K_FW = OFFSET + DELTA - k;
+        if( 0 <= K_FW && K_FW < V_LEN && -1 != v_fw[K_FW]
+         && N - x2 <= v_fw[K_FW] )
+        {
+          x = v_fw[K_FW]; y = x - (K_FW - OFFSET); return true;
+        }
+      }
+    }
+  }
+  if( D_LIM == MAX_D ) return false; // Nothing in common
+
+  // Too costly, so split at the point furthest from either end:
+  int best = 0;
+  for( int K=0; K<V_LEN; K++ )
+  {
+    const int k = K - OFFSET;
+    if( -1 != v_fw[K] )
+    {
+      const int x1 = v_fw[K], y1 = x1 - k;
+      if( x1 <= N && 0 <= y1 && y1 <= M && best < x1 + y1 )
+      {
+        best = x1 + y1; x = x1; y = y1;
+      }
+    }
+    if( -1 != v_bw[K] )
+    {
+      const int x2 = v_bw[K], y2 = x2 - k;
+      if( x2 <= N && 0 <= y2 && y2 <= M && best < x2 + y2 )
+      {
+        best = x2 + y2; x = N - x2; y = M - y2;
+      }
+    }
+  }
+  return 0 < best && best < N + M;
+}
+
+static void Myers( Engine& e, const Region& r )
+{
+  const int N = r.fn_s - r.st_s;
+  const int M = r.fn_l - r.st_l;
+  int x = 0, y = 0;
+
+  if( Myers_Split( e, e.ids_s + r.st_s, N, e.ids_l + r.st_l, M, x, y ) )
+  {
+    // Second half is pushed first so it is done last:
+    Push_Region( e, r.st_s+x, r.fn_s, r.st_l+y, r.fn_l, false );
+    Push_Region( e, r.st_s, r.st_s+x, r.st_l, r.st_l+y, false );
+  }
+}
+
+// Puts the local ids of ids[st,fn) in local, and returns the
+// number of local ids after adding them
+static unsigned Local_Ids( Engine& e, const unsigned* ids
+                         , const unsigned st, const unsigned fn
+                         , const unsigned mask, unsigned num_ids
+                         , Array_t<unsigned>& local )
+{
+  local.clear();
+  for( unsigned k=st; k<fn; k++ )
+  {
+    const unsigned KEY = ids[k] + 1;
+    unsigned h = (KEY * 2654435761u) & mask;
+
+    while( e.map_key[h] && e.map_key[h] != KEY ) h = (h + 1) & mask;
+
+    if( 0 == e.map_key[h] ) { e.map_key[h] = KEY; e.map_val[h] = num_ids++; }
+
+    local.push( e.map_val[h] );
+  }
+  return num_ids;
+}
+
+// Finds the lines that appear exactly once on each side of r, and
+// leaves the longest in-order sequence of them in e.anch_s and
+// e.anch_l.  Returns the number of anchors found.
+static unsigned Find_Anchors( Engine& e, const Region& r )
+{
+  const unsigned N = r.fn_s - r.st_s;
+  const unsigned M = r.fn_l - r.st_l;
+  const unsigned* A = e.ids_s + r.st_s;
+  const unsigned* B = e.ids_l + r.st_l;
+
+  if( e.local_ids )
+  {
+    unsigned cap = 16;
+    while( cap < 2*(N + M) ) cap *= 2;
+    if( e.map_key.len() < cap ) { e.map_key.set_len( cap );
+                                  e.map_val.set_len( cap ); }
+    memset( e.map_key.get(0), 0, cap*sizeof(unsigned) );
+
+    unsigned num_ids = Local_Ids( e, e.ids_s, r.st_s, r.fn_s, cap-1, 0, e.loc_s );
+             num_ids = Local_Ids( e, e.ids_l, r.st_l, r.fn_l, cap-1, num_ids, e.loc_l );
+    A = e.loc_s.get(0);
+    B = e.loc_l.get(0);
+
+    if( e.cnt_s.len() < num_ids ) { e.cnt_s.set_len( num_ids );
+                                    e.cnt_l.set_len( num_ids );
+                                    e.pos_l.set_len( num_ids ); }
+  }
+  for( unsigned k=0; k<N; k++ )
+  {
+    unsigned char& cnt = e.cnt_s[ A[k] ];
+    if( cnt < 2 ) cnt++;
+  }
+  for( unsigned k=0; k<M; k++ )
+  {
+    unsigned char& cnt = e.cnt_l[ B[k] ];
+    if( cnt < 2 ) cnt++;
+    e.pos_l[ B[k] ] = r.st_l + k;
+  }
+  // Candidates in short line order:
+  e.anch_s.clear();
+  e.anch_l.clear();
+  for( unsigned k=0; k<N; k++ )
+  {
+    const unsigned ID = A[k];
+    if( 1 == e.cnt_s[ID] && 1 == e.cnt_l[ID] )
+    {
+      e.anch_s.push( r.st_s + k );
+      e.anch_l.push( e.pos_l[ID] );
+    }
+  }
+  // Clear counts for the next region:
+  for( unsigned k=0; k<N; k++ ) e.cnt_s[ A[k] ] = 0;
+  for( unsigned k=0; k<M; k++ ) e.cnt_l[ B[k] ] = 0;
+
+  const unsigned NUM_CAND = e.anch_s.len();
+  if( 0 == NUM_CAND ) return 0;
+
+  // Longest increasing sequence of long line numbers, by patience sort:
+  e.tails.clear();
+  if( e.prev.len() < NUM_CAND ) e.prev.set_len( NUM_CAND );
+  for( unsigned c=0; c<NUM_CAND; c++ )
+  {
+    const unsigned LN_L = e.anch_l[c];
+    const unsigned NUM  = e.tails.len();
+    unsigned lo = NUM;
+
+    // Most candidates come after all the others when files are similar:
+    if( 0 == NUM || e.anch_l[ e.tails[NUM-1] ] < LN_L ) lo = NUM;
+    else {
+      unsigned hi = NUM-1;
+      lo = 0;
+      while( lo < hi )
+      {
+        const unsigned mid = (lo + hi)/2;
+        if( e.anch_l[ e.tails[mid] ] < LN_L ) lo = mid + 1;
+        else                                  hi = mid;
+      }
+    }
+    e.prev[c] = lo ? e.tails[lo-1] : NUM_CAND;
+    if( lo == NUM ) e.tails.push( c );
+    else            e.tails[lo] = c;
+  }
+  // Put the candidate numbers of the sequence in tails, in order:
+  const unsigned NUM = e.tails.len();
+  unsigned c = e.tails[ NUM-1 ];
+  for( unsigned k=NUM; 0<k; k-- ) { e.tails[k-1] = c; c = e.prev[c]; }
+
+  // Move the sequence to the front of anch_s and anch_l.
+  // tails[k] >= k, so entries not yet moved are not overwritten:
+  for( unsigned k=0; k<NUM; k++ )
+  {
+    e.anch_s[k] = e.anch_s[ e.tails[k] ];
+    e.anch_l[k] = e.anch_l[ e.tails[k] ];
+  }
+  return NUM;
+}
+
+// Pushes NUM anchors in r, and the regions between them.  SIZE is the
+// number of lines in the region the anchors were found in.  Gaps are
+// only searched for anchors again if they are at most half of SIZE,
+// so no line is counted more than log2(SIZE) times.
+static void Push_Anchors( Engine& e, const Region& r
+                        , const unsigned* anch_s
+                        , const unsigned* anch_l
+                        , const unsigned NUM
+                        , const unsigned SIZE )
+{
+  unsigned fn_s = r.fn_s;
+  unsigned fn_l = r.fn_l;
+  for( unsigned k=NUM; 0<k; k-- )
+  {
+    const unsigned ln_s = anch_s[k-1];
+    const unsigned ln_l = anch_l[k-1];
+    const unsigned GAP = (fn_s - ln_s - 1) + (fn_l - ln_l - 1);
+
+    Push_Region( e, ln_s+1, fn_s, ln_l+1, fn_l, 2*GAP <= SIZE );
+    Push_Same( e, ln_s, ln_l, 1 );
+    fn_s = ln_s;
+    fn_l = ln_l;
+  }
+  const unsigned GAP = (fn_s - r.st_s) + (fn_l - r.st_l);
+  Push_Region( e, r.st_s, fn_s, r.st_l, fn_l, 2*GAP <= SIZE );
+}
+
+// Returns false if there are no anchors in r
+static bool Patience( Engine& e, const Region& r )
+{
+  const unsigned NUM = Find_Anchors( e, r );
+  if( 0 == NUM ) return false;
+
+  Push_Anchors( e, r, e.anch_s.get(0), e.anch_l.get(0), NUM
+              , (r.fn_s - r.st_s) + (r.fn_l - r.st_l) );
+  return true;
+}
+
+// Takes the common prefix and then the common suffix off r, and puts
+// their number of lines in prefix and suffix
+static void Trim_Region( const Engine& e, Region& r
+                       , unsigned& prefix, unsigned& suffix )
+{
+  const unsigned* A = e.ids_s;
+  const unsigned* B = e.ids_l;
+
+  unsigned n = 0;
+  while( r.st_s+n < r.fn_s && r.st_l+n < r.fn_l
+      && A[ r.st_s+n ] == B[ r.st_l+n ] ) n++;
+  r.st_s += n;
+  r.st_l += n;
+  prefix = n;
+
+  n = 0;
+  while( r.st_s < r.fn_s-n && r.st_l < r.fn_l-n
+      && A[ r.fn_s-n-1 ] == B[ r.fn_l-n-1 ] ) n++;
+  r.fn_s -= n;
+  r.fn_l -= n;
+  suffix = n;
+}
+
+static void Diff_Region( Engine& e, Region r )
+{
+  unsigned prefix = 0, suffix = 0;
+  Trim_Region( e, r, prefix, suffix );
+
+  Add_Same( e, r.st_s - prefix, r.st_l - prefix, prefix );
+
+  // Common suffix, added after the middle:
+  if( suffix ) Push_Same( e, r.fn_s, r.fn_l, suffix );
+
+  if( r.st_s < r.fn_s && r.st_l < r.fn_l )
+  {
+    if( !r.patience || !Patience( e, r ) ) Myers( e, r );
+  }
+}
+
+Line_Ids::Line_Ids()
+  : m_lines()
+  , m_slots( 1024, 0 )
+{
+}
+
+void Line_Ids::Clear()
+{
+  m_lines.clear();
+  m_slots.set_all( 0 );
+}
+
+unsigned Line_Ids::Id( const unsigned long long hash
+                     , const char* data, const unsigned len )
+{
+  if( m_slots.len() < 2*(m_lines.len() + 1) ) Grow();
+
+  const unsigned MASK = m_slots.len() - 1;
+
+  for( unsigned h=unsigned( hash ) & MASK; ; h = (h + 1) & MASK )
+  {
+    unsigned& slot = m_slots[h];
+
+    if( 0 == slot ) // New line
+    {
+      Entry ent = { hash, data, len };
+      m_lines.push( ent );
+      slot = m_lines.len();
+      return slot - 1;
+    }
+    const Entry& ent = m_lines[ slot-1 ];
+
+    if( ent.hash == hash && ent.len == len
+     && 0 == memcmp( ent.data, data, len ) ) return slot - 1;
+  }
+}
+
+// Doubles the size of the hash table
+void Line_Ids::Grow()
+{
+  const unsigned NEW_LEN = 2*m_slots.len();
+  const unsigned MASK    = NEW_LEN - 1;
+
+  m_slots.clear();
+  m_slots.set_len( NEW_LEN );
+
+  for( unsigned id=0; id<m_lines.len(); id++ )
+  {
+    unsigned h = unsigned( m_lines[id].hash ) & MASK;
+
+    while( m_slots[h] ) h = (h + 1) & MASK;
+
+    m_slots[h] = id + 1;
+  }
+}
+
+static void Run_Engine( Engine& e )
+{
+  Region r;
+  while( e.todo.pop( r ) )
+  {
+    if( r.same ) Add_Same( e, r.st_s, r.st_l, r.fn_s - r.st_s );
+    else         Diff_Region( e, r );
+  }
+}
+
+// Part of the files diffed by one thread.  Starts with an anchor,
+// except for the first task, and has anchors [anch_st,anch_fn).
+struct Task
+{
+  Region   r;
+  unsigned anch_st;
+  unsigned anch_fn;
+  Array_t<Same_Run> runs;
+};
+
+struct Pool
+{
+  Engine&           e;     // Has the anchors
+  const unsigned    SIZE;  // Lines in the region the anchors were found in
+  Array_t<Task>&    tasks;
+  volatile unsigned next_task;
+
+  Pool( Engine& e, const unsigned SIZE, Array_t<Task>& tasks )
+    : e( e )
+    , SIZE( SIZE )
+    , tasks( tasks )
+    , next_task( 0 )
+  {}
+};
+
+// Each thread takes the next task not yet taken until none are left.
+// Tasks are about the same size, so no thread is left with much more
+// work than the others.
+static void* Worker( void* arg )
+{
+  Pool& p = *static_cast<Pool*>( arg );
+
+  for( ;; )
+  {
+    const unsigned T = __sync_fetch_and_add( &p.next_task, 1 );
+    if( p.tasks.len() <= T ) break;
+
+    Task& t = p.tasks[T];
+
+    // Counts indexed by ids of the whole files would be too big to
+    // have one per thread, so regions are renumbered:
+    Engine e( p.e.ids_s, p.e.ids_l, p.e.max_cost, t.runs );
+    e.local_ids = true;
+
+    Push_Anchors( e, t.r, p.e.anch_s.get( t.anch_st )
+                        , p.e.anch_l.get( t.anch_st )
+                        , t.anch_fn - t.anch_st, p.SIZE );
+    Run_Engine( e );
+  }
+  return 0;
+}
+
+static unsigned m_num_threads = 0;
+
+void Diff_Set_Threads( const unsigned num )
+{
+  m_num_threads = num;
+}
+
+unsigned Diff_Num_Threads()
+{
+#if defined(WIN32)
+  return 1;
+#else
+  unsigned num = m_num_threads;
+
+  if( 0 == num )
+  {
+    const long CPUS = sysconf( _SC_NPROCESSORS_ONLN );
+
+    num = 0 < CPUS ? CPUS : 1;
+  }
+  return num < MAX_DIFF_THREADS ? num : MAX_DIFF_THREADS;
+#endif
+}
+
+// Cuts the files at the anchors Patience() would find, into tasks of
+// about the same size, diffs the tasks on NUM_THREADS threads, and
+// puts the results back together in order.  The files are trimmed and
+// the gaps between anchors searched the same way as on one thread, so
+// the results do not depend on the number of threads.  Returns false
+// if no anchors were found, so the files could not be cut.
+static bool Diff_Parallel( Engine& e, const unsigned len_s, const unsigned len_l
+                         , const unsigned NUM_THREADS )
+{
+#if defined(WIN32)
+  return false;
+#else
+  Region ALL = { 0, len_s, 0, len_l, false, true };
+
+  unsigned prefix = 0, suffix = 0;
+  Trim_Region( e, ALL, prefix, suffix );
+
+  const unsigned SIZE = (ALL.fn_s - ALL.st_s) + (ALL.fn_l - ALL.st_l);
+  if( SIZE < PARALLEL_MIN_LINES ) return false;
+
+  const unsigned NUM_ANCH = Find_Anchors( e, ALL );
+  if( 0 == NUM_ANCH ) return false;
+
+  // Several tasks per thread, so a slow task does not hold up the rest:
+  const unsigned TASK_SIZE = SIZE/(8*NUM_THREADS) + 1;
+
+  Array_t<Task> tasks;
+  Task t;
+  t.r = ALL;
+  t.anch_st = 0;
+  for( unsigned k=0; k<NUM_ANCH; k++ )
+  {
+    t.r.fn_s = e.anch_s[k];
+    t.r.fn_l = e.anch_l[k];
+
+    if( TASK_SIZE <= (t.r.fn_s - t.r.st_s) + (t.r.fn_l - t.r.st_l) )
+    {
+      t.anch_fn = k;
+      tasks.push( t );
+      t.r.st_s  = t.r.fn_s;
+      t.r.st_l  = t.r.fn_l;
+      t.anch_st = k;
+    }
+  }
+  t.r.fn_s  = ALL.fn_s;
+  t.r.fn_l  = ALL.fn_l;
+  t.anch_fn = NUM_ANCH;
+  tasks.push( t );
+
+  Pool pool( e, SIZE, tasks );
+
+  pthread_t threads[ MAX_DIFF_THREADS ];
+  unsigned num_started = 0;
+  for( unsigned k=1; k<NUM_THREADS; k++ )
+  {
+    if( 0 == pthread_create( &threads[num_started], 0, Worker, &pool ) )
+    {
+      num_started++;
+    }
+  }
+  Worker( &pool ); // This thread works too
+  for( unsigned k=0; k<num_started; k++ ) pthread_join( threads[k], 0 );
+
+  Add_Same( e, 0, 0, prefix );
+
+  for( unsigned k=0; k<tasks.len(); k++ )
+  {
+    const Task& T = tasks[k];
+
+    for( unsigned j=0; j<T.runs.len(); j++ )
+    {
+      const Same_Run R = T.runs[j];
+
+      Add_Same( e, R.ln_s, R.ln_l, R.nlines );
+    }
+  }
+  Add_Same( e, ALL.fn_s, ALL.fn_l, suffix );
+  return true;
+#endif
+}
+
+void Diff_Ids( const unsigned* ids_s, const unsigned len_s
+             , const unsigned* ids_l, const unsigned len_l
+             , const unsigned num_ids
+             , const Diff_Algo algo
+             , Array_t<Same_Run>& runs )
+{
+  runs.clear();
+
+  unsigned max_cost = sqrt( double( len_s ) + len_l );
+  if( max_cost < MIN_MAX_COST ) max_cost = MIN_MAX_COST;
+
+  Engine e( ids_s, ids_l, max_cost, runs );
+
+  if( DA_PATIENCE == algo )
+  {
+    e.cnt_s.set_len( num_ids );
+    e.cnt_l.set_len( num_ids );
+    e.pos_l.set_len( num_ids );
+  }
+  const unsigned NUM_THREADS = DA_PATIENCE == algo
+                            && PARALLEL_MIN_LINES <= len_s + len_l
+                             ? Diff_Num_Threads() : 1;
+
+  if( NUM_THREADS < 2 || !Diff_Parallel( e, len_s, len_l, NUM_THREADS ) )
+  {
+    Push_Region( e, 0, len_s, 0, len_l, DA_PATIENCE == algo );
+    Run_Engine( e );
+  }
+}
+
+// Returns the number of chars at the start of a and b that are the same
+static unsigned Common_Prefix( const char* a, const char* b, const unsigned LEN )
+{
+  unsigned k=0;
+#if defined(__SSE2__)
+  for( ; k+16 <= LEN; k+=16 )
+  {
+    const __m128i A = _mm_loadu_si128( (const __m128i*)(a+k) );
+    const __m128i B = _mm_loadu_si128( (const __m128i*)(b+k) );
+    const unsigned SAME = _mm_movemask_epi8( _mm_cmpeq_epi8( A, B ) );
+
+    if( 0xFFFF != SAME ) return k + __builtin_ctz( ~SAME );
+  }
+#endif
+  for( ; k<LEN && a[k] == b[k]; k++ ) ;
+
+  return k;
+}
+
+// Returns the number of chars at the end of a and b that are the same.
+// a and b point one past the end of the chars compared.
+static unsigned Common_Suffix( const char* a, const char* b, const unsigned LEN )
+{
+  unsigned k=0;
+#if defined(__SSE2__)
+  for( ; k+16 <= LEN; k+=16 )
+  {
+    const __m128i A = _mm_loadu_si128( (const __m128i*)(a-k-16) );
+    const __m128i B = _mm_loadu_si128( (const __m128i*)(b-k-16) );
+    const unsigned DIFF = ~_mm_movemask_epi8( _mm_cmpeq_epi8( A, B ) ) & 0xFFFF;
+
+    if( DIFF ) return k + __builtin_clz( DIFF ) - 16;
+  }
+#endif
+  for( ; k<LEN && a[-int(k)-1] == b[-int(k)-1]; k++ ) ;
+
+  return k;
+}
+
+unsigned Char_Diff::Run( const char* s, const unsigned len_s
+                       , const char* l, const unsigned len_l )
+{
+  m_runs.clear();
+
+  const unsigned MIN_LEN = len_s < len_l ? len_s : len_l;
+  const unsigned PRE = Common_Prefix( s, l, MIN_LEN );
+  const unsigned SUF = Common_Suffix( s+len_s, l+len_l, MIN_LEN-PRE );
+
+  if( PRE )
+  {
+    const Same_Run R = { 0, 0, PRE };
+    m_runs.push( R );
+  }
+  Myers( s+PRE, len_s-PRE-SUF, l+PRE, len_l-PRE-SUF, PRE );
+
+  if( SUF )
+  {
+    const Same_Run R = { len_s-SUF, len_l-SUF, SUF };
+    m_runs.push( R );
+  }
+  unsigned num_same = 0;
+  for( unsigned k=0; k<m_runs.len(); k++ ) num_same += m_runs[k].nlines;
+
+  return num_same;
+}
+
+// Adds the runs of same chars in s and l, which have no common prefix
+// or suffix, to m_runs, with offset added to their char positions.
+void Char_Diff::Myers( const char* s, const unsigned len_s
+                     , const char* l, const unsigned len_l
+                     , const unsigned offset )
+{
+  const int N = len_s;
+  const int M = len_l;
+  if( 0 == N || 0 == M ) return;
+
+  const int MAX_D = N + M < MAX_CHAR_COST ? N + M : MAX_CHAR_COST;
+  const int OFF   = MAX_D + 1;
+
+  // Array_t::set_len() is slow to shrink, so only grow:
+  if( m_v.len() < unsigned( 2*OFF + 1 ) ) m_v.set_len( 2*OFF + 1 );
+  if( m_trace.len() < unsigned( (MAX_D+1)*(MAX_D+1) ) )
+  {
+    m_trace.set_len( (MAX_D+1)*(MAX_D+1) );
+  }
+  int* const V = m_v.get( OFF );
+  int* const T = m_trace.get( 0 );
+
+  V[1] = 0;
+  int D = -1;
+  for( int d=0; D < 0 && d<=MAX_D; d++ )
+  {
+    for( int k=-d; k<=d; k+=2 )
+    {
+      int x = ( k == -d || (k != d && V[k-1] < V[k+1]) ) ? V[k+1] : V[k-1]+1;
+      int y = x - k;
+      while( x < N && y < M && s[x] == l[y] ) { x++; y++; }
+      V[k] = x;
+
+      if( N <= x && M <= y ) { D = d; break; }
+    }
+    // V[-d,d] is saved at T[d*d], since 1+3+...+(2d-1) = d*d:
+    if( D < 0 ) memcpy( T + d*d, V - d, (2*d+1)*sizeof(int) );
+  }
+  if( D < 0 ) return; // Too different, so no same chars in the middle
+
+  // Walk back from the end, adding snakes in reverse order:
+  const unsigned FIRST = m_runs.len();
+  int x = N;
+  int y = M;
+  for( int d=D; 0<d; d-- )
+  {
+    const int* P = T + (d-1)*(d-1) + (d-1); // V after cost d-1
+    const int  k = x - y;
+    const bool DOWN = k == -d || (k != d && P[k-1] < P[k+1]);
+    const int  pk = DOWN ? k+1 : k-1;
+    const int  px = P[pk];
+    const int  sx = DOWN ? px : px+1; // Start of snake
+
+    if( sx < x )
+    {
+      const Same_Run R = { offset+sx, offset+sx-k, unsigned( x-sx ) };
+      m_runs.push( R );
+    }
+    x = px;
+    y = px - pk;
+  }
+  if( 0 < x )
+  {
+    const Same_Run R = { offset, offset, unsigned( x ) };
+    m_runs.push( R );
+  }
+  for( unsigned i=FIRST, j=m_runs.len(); i+1<j; i++, j-- )
+  {
+    const Same_Run R = m_runs[i];
+    m_runs[i]   = m_runs[j-1];
+    m_runs[j-1] = R;
+  }
+}
+
+static unsigned Mix_32( unsigned x )
+{
+  x ^= x >> 16; x *= 0x85EBCA6Bu;
+  x ^= x >> 13; x *= 0xC2B2AE35u;
+  x ^= x >> 16;
+  return x;
+}
+
+// Puts the NUM_MIN_HASH smallest values of the shingles of line r in
+// sig, each with a different hash function
+static void Min_Hash( const Line_Ref& r, unsigned* sig )
+{
+  for( unsigned b=0; b<NUM_MIN_HASH; b++ ) sig[b] = ~0u;
+
+  const unsigned char* d = reinterpret_cast<const unsigned char*>( r.data );
+  // Lines shorter than a shingle are one shingle:
+  const unsigned NUM = 3 <= r.len ? r.len - 2 : 1;
+
+  for( unsigned k=0; k<NUM; k++ )
+  {
+    unsigned shingle = 0;
+    for( unsigned j=0; j<3 && k+j<r.len; j++ ) shingle = (shingle << 8) | d[k+j];
+    if( r.len < 3 ) shingle |= (r.len + 1) << 24;
+
+    for( unsigned b=0; b<NUM_MIN_HASH; b++ )
+    {
+      const unsigned h = Mix_32( shingle ^ (0x9E3779B9u * (b+1)) );
+      if( h < sig[b] ) sig[b] = h;
+    }
+  }
+}
+
+// MinHash values of all the long lines, and for each value the long
+// lines that have it, in order, so candidates for each short line can
+// be found without looking at every long line
+struct Simi_Index
+{
+  struct Slot
+  {
+    unsigned value; // MinHash value
+    unsigned band;  // Which MinHash value plus 1, 0 if slot is empty
+    unsigned st;    // Start of long lines with value in lines
+    unsigned num;   // Number of long lines with value
+  };
+  Array_t<unsigned> sig;   // NUM_MIN_HASH values per long line
+  Array_t<unsigned> lines; // Long lines, grouped by slot
+  Array_t<Slot>     slots; // Hash table of values
+  unsigned          mask;
+
+  Slot& Find( const unsigned band, const unsigned value )
+  {
+    unsigned h = Mix_32( value + band ) & mask;
+    while( slots[h].band && ( slots[h].band != band+1
+                           || slots[h].value != value ) ) h = (h + 1) & mask;
+    return slots[h];
+  }
+};
+
+static void Build_Index( Simi_Index& x, const Line_Ref* l, const unsigned M )
+{
+  x.sig.set_len( M*NUM_MIN_HASH );
+  for( unsigned k=0; k<M; k++ ) Min_Hash( l[k], x.sig.get( k*NUM_MIN_HASH ) );
+
+  unsigned cap = 16;
+  while( cap < 2*M*NUM_MIN_HASH ) cap *= 2;
+  x.slots.set_len( cap );
+  x.mask = cap - 1;
+
+  // Count the long lines with each value:
+  for( unsigned E=0; E<M*NUM_MIN_HASH; E++ )
+  {
+    Simi_Index::Slot& slot = x.Find( E % NUM_MIN_HASH, x.sig[E] );
+
+    if( 0 == slot.band ) { slot.value = x.sig[E]; slot.band = E % NUM_MIN_HASH + 1; }
+    slot.num++;
+  }
+  unsigned st = 0;
+  for( unsigned k=0; k<cap; k++ )
+  {
+    x.slots[k].st = st; st += x.slots[k].num; x.slots[k].num = 0;
+  }
+  // Long lines are added in order, so each group is sorted:
+  x.lines.set_len( M*NUM_MIN_HASH );
+  for( unsigned E=0; E<M*NUM_MIN_HASH; E++ )
+  {
+    Simi_Index::Slot& slot = x.Find( E % NUM_MIN_HASH, x.sig[E] );
+
+    x.lines[ slot.st + slot.num++ ] = E / NUM_MIN_HASH;
+  }
+}
+
+// Adds long line kl to cands, if it is not already there, with the
+// number of MinHash values it shares with sig_s
+static void Add_Cand( const Simi_Index& x, const unsigned* sig_s
+                    , const unsigned kl
+                    , Array_t<unsigned>& cands
+                    , Array_t<unsigned>& scores )
+{
+  for( unsigned c=0; c<cands.len(); c++ ) if( cands[c] == kl ) return;
+
+  unsigned score = 0;
+  for( unsigned b=0; b<NUM_MIN_HASH; b++ )
+  {
+    if( sig_s[b] == x.sig[ kl*NUM_MIN_HASH + b ] ) score++;
+  }
+  cands.push( kl );
+  scores.push( score );
+}
+
+// Adds the long lines in [st, fn] sharing the value of slot, closest
+// to guess: one before guess, and up to MAX_BUCKET_CANDS from guess on
+static void Add_Near( Simi_Index& x, const unsigned* sig_s
+                    , const Simi_Index::Slot& slot
+                    , const unsigned guess
+                    , const unsigned st, const unsigned fn
+                    , Array_t<unsigned>& cands
+                    , Array_t<unsigned>& scores )
+{
+  const unsigned* L = x.lines.get( slot.st );
+  unsigned lo = 0, hi = slot.num;
+  while( lo < hi )
+  {
+    const unsigned mid = (lo + hi)/2;
+    if( L[mid] < guess ) lo = mid + 1;
+    else                 hi = mid;
+  }
+  if( 0<lo && st <= L[lo-1] ) Add_Cand( x, sig_s, L[lo-1], cands, scores );
+
+  for( unsigned n=0; lo<slot.num && L[lo] <= fn && n<MAX_BUCKET_CANDS; n++, lo++ )
+  {
+    Add_Cand( x, sig_s, L[lo], cands, scores );
+  }
+}
+
+// Distance of long line kl from the closest guess, where lines before
+// a guess are farther, since offsets of in-order pairs never go down
+static unsigned Guess_Dist( const unsigned kl, const unsigned guess_1
+                                             , const unsigned guess_2 )
+{
+  const unsigned D1 = guess_1 <= kl ? 2*(kl - guess_1) : 2*(guess_1 - kl) + 1;
+  const unsigned D2 = guess_2 <= kl ? 2*(kl - guess_2) : 2*(guess_2 - kl) + 1;
+
+  return D1 < D2 ? D1 : D2;
+}
+
+// Pair of lines confirmed to have chars the same
+struct Simi_Edge
+{
+  unsigned ln_s;
+  unsigned ln_l;
+  unsigned nbytes;
+  unsigned best; // Most chars the same of in-order pairs ending here
+  unsigned prev; // Edge before this one in that sequence
+};
+
+void Pair_Lines( const Line_Ref* s, const unsigned N
+               , const Line_Ref* l, const unsigned M
+               , Char_Diff& cd
+               , Array_t<unsigned>& pair_l )
+{
+  const unsigned NONE = ~0u;
+  const unsigned LD   = M - N;
+
+  pair_l.clear();
+  if( 0 == N ) return;
+
+  Simi_Index x;
+  Build_Index( x, l, M );
+
+  // Fenwick tree over offsets ln_l - ln_s, giving the best edge with
+  // offset at most some value.  Offsets of in-order pairs never go
+  // down, or some short line between them would have no long line.
+  Array_t<unsigned> fw_edge; fw_edge.set_len( LD+2 );
+  for( unsigned k=0; k<LD+2; k++ ) fw_edge[k] = NONE;
+
+  Array_t<Simi_Edge> edges;
+  Array_t<unsigned>  cands;  // Candidate long lines of a short line
+  Array_t<unsigned>  scores; // Number of MinHash values cands share
+  unsigned sig_s[ NUM_MIN_HASH ];
+  unsigned offset      = 0; // ln_l - ln_s of the best sequence so far
+  unsigned offset_last = 0; // ln_l - ln_s of most similar to last line
+
+  for( unsigned ks=0; ks<N; ks++ )
+  {
+    Min_Hash( s[ks], sig_s );
+    cands.clear();
+    scores.clear();
+
+    // Long lines on the same offset as the best sequence so far, and
+    // as the most similar line to the last short line, are the best
+    // guesses.  Other candidates are long lines in [ks, ks+LD] near the
+    // guesses that share a MinHash value with line ks.
+    const unsigned GUESS_1 = ks + offset;
+    const unsigned GUESS_2 = ks + offset_last;
+    // Lines on and just after the guesses are always confirmed, so
+    // single inserted lines do not lose the way:
+    for( unsigned k=0; k<2 && GUESS_1+k <= ks+LD; k++ ) Add_Cand( x, sig_s, GUESS_1+k, cands, scores );
+    for( unsigned k=0; k<2 && GUESS_2+k <= ks+LD; k++ ) Add_Cand( x, sig_s, GUESS_2+k, cands, scores );
+    for( unsigned c=0; c<cands.len(); c++ ) scores[c] += NUM_MIN_HASH;
+
+    for( unsigned b=0; b<NUM_MIN_HASH; b++ )
+    {
+      const Simi_Index::Slot& slot = x.Find( b, sig_s[b] );
+      if( 0 == slot.band ) continue;
+
+      Add_Near( x, sig_s, slot, GUESS_1, ks, ks+LD, cands, scores );
+      if( GUESS_2 != GUESS_1 )
+      {
+        Add_Near( x, sig_s, slot, GUESS_2, ks, ks+LD, cands, scores );
+      }
+    }
+    // Confirm the best candidates, and find the best sequence ending
+    // with each before adding any, since ln_s must increase:
+    const unsigned FIRST = edges.len();
+    for( unsigned n=0; n<MAX_CONFIRM && n<cands.len(); n++ )
+    {
+      // Most MinHash values shared, and then closest after a guess:
+      unsigned best = n;
+      for( unsigned c=n+1; c<cands.len(); c++ )
+      {
+        if( scores[best] < scores[c]
+         || ( scores[best] == scores[c]
+           && Guess_Dist( cands[c], GUESS_1, GUESS_2 )
+            < Guess_Dist( cands[best], GUESS_1, GUESS_2 ) ) ) best = c;
+      }
+      const unsigned KL = cands[best];
+      cands[best] = cands[n]; cands[n] = KL;
+      const unsigned SCORE = scores[best];
+      scores[best] = scores[n]; scores[n] = SCORE;
+
+      const unsigned NBYTES = cd.Run( s[ks].data, s[ks].len, l[KL].data, l[KL].len )
+                            + ( 0 == s[ks].len && 0 == l[KL].len );
+      if( 0 == NBYTES ) continue;
+
+      Simi_Edge e = { ks, KL, NBYTES, NBYTES, NONE };
+      for( unsigned i=KL-ks+1; 0<i; i -= i & -i )
+      {
+        const unsigned E = fw_edge[i];
+        if( E != NONE && e.best < edges[E].best + NBYTES )
+        {
+          e.best = edges[E].best + NBYTES;
+          e.prev = E;
+        }
+      }
+      edges.push( e );
+    }
+    // Next guesses follow the best sequence so far, and the most
+    // similar line to this one:
+    for( unsigned E=FIRST, BEST=FIRST, MOST=FIRST; E<edges.len(); E++ )
+    {
+      if( E == BEST || edges[BEST].best < edges[E].best )
+      {
+        BEST = E;
+        offset = edges[E].ln_l - ks;
+      }
+      if( E == MOST || edges[MOST].nbytes < edges[E].nbytes )
+      {
+        MOST = E;
+        offset_last = edges[E].ln_l - ks;
+      }
+    }
+    for( unsigned E=FIRST; E<edges.len(); E++ )
+    {
+      for( unsigned i=edges[E].ln_l-ks+1; i<LD+2; i += i & -i )
+      {
+        if( fw_edge[i] == NONE || edges[ fw_edge[i] ].best < edges[E].best ) fw_edge[i] = E;
+      }
+    }
+  }
+  pair_l.set_len( N );
+  for( unsigned k=0; k<N; k++ ) pair_l[k] = NONE;
+
+  unsigned E = NONE;
+  for( unsigned k=0; k<edges.len(); k++ )
+  {
+    if( E == NONE || edges[E].best < edges[k].best ) E = k;
+  }
+  for( ; E != NONE; E = edges[E].prev ) pair_l[ edges[E].ln_s ] = edges[E].ln_l;
+
+  // Fill in short lines not paired, at the offset of the pair before:
+  offset = 0;
+  for( unsigned k=0; k<N; k++ )
+  {
+    if( pair_l[k] == NONE ) pair_l[k] = k + offset;
+    else                    offset = pair_l[k] - k;
+  }
+}
+
+const char* Diff_Algo_2_Str( const Diff_Algo algo )
+{
+  return DA_MYERS == algo ? "myers" : "patience";
+}
+
+bool Str_2_Diff_Algo( const char* str, Diff_Algo& algo )
+{
+  if     ( 0 == strcmp( str, "myers"    ) ) algo = DA_MYERS;
+  else if( 0 == strcmp( str, "patience" ) ) algo = DA_PATIENCE;
+  else return false;
+
+  return true;
+}
@@ -0,0 +1,138 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DIFF_ENGINE_HH__
+#define __DIFF_ENGINE_HH__
+
+#include "Array_t.hh"
+
+// Line level diff of two sequences of line ids, where equal ids mean
+// equal lines.  Does not depend on FileBuf or the console, so it can
+// be run outside of vis.
+
+enum Diff_Algo
+{
+  DA_MYERS,    // Shortest edit script, O((N+M)D)
+  DA_PATIENCE, // Anchor on lines unique to both sides, Myers between anchors
+};
+
+// Run of consecutive lines the same in both sequences
+struct Same_Run
+{
+  unsigned ln_s;   // Beginning line number in short sequence
+  unsigned ln_l;   // Beginning line number in long  sequence
+  unsigned nlines; // Number of consecutive lines the same
+};
+
+// Gives each distinct line a dense id, 0, 1, 2, ..., so lines can be
+// diffed as arrays of integers.  Lines are looked up by a 64-bit hash,
+// and lines with equal hashes are compared byte by byte, so different
+// lines never get the same id.  The chars passed to Id() must not
+// change or go away until Clear() is called.
+class Line_Ids
+{
+public:
+  Line_Ids();
+
+  void     Clear();
+  unsigned Id( const unsigned long long hash
+             , const char* data, const unsigned len );
+  unsigned Num_Ids() const { return m_lines.len(); }
+
+private:
+  struct Entry
+  {
+    unsigned long long hash;
+    const char*        data;
+    unsigned           len;
+  };
+  void Grow();
+
+  Array_t<Entry>    m_lines; // Indexed by id
+  Array_t<unsigned> m_slots; // Hash table of id+1, 0 if empty
+};
+
+// Fills in runs, ordered by line number, with the lines common to ids_s
+// and ids_l, where ids are less than num_ids.  Adjacent runs are
+// separated by at least one differing line.
+void Diff_Ids( const unsigned* ids_s, const unsigned len_s
+             , const unsigned* ids_l, const unsigned len_l
+             , const unsigned num_ids
+             , const Diff_Algo algo
+             , Array_t<Same_Run>& runs );
+
+// Number of threads used for large patience diffs,
+// 0, the default, for one per CPU
+void Diff_Set_Threads( const unsigned num );
+unsigned Diff_Num_Threads();
+
+// Char level diff of two lines.  The common prefix and suffix are
+// stripped a block at a time, and Myers is run on the rest, giving up
+// on the middle if it has more than MAX_CHAR_COST edits.  The results
+// are Same_Run's of char positions instead of line numbers.  Keeps its
+// work arrays between calls, since it is called for many line pairs.
+class Char_Diff
+{
+public:
+  // Returns the number of chars the same in the two lines
+  unsigned Run( const char* s, const unsigned len_s
+              , const char* l, const unsigned len_l );
+
+  // Runs of same chars from the last call to Run()
+  const Array_t<Same_Run>& Runs() const { return m_runs; }
+
+private:
+  void Myers( const char* s, const unsigned len_s
+            , const char* l, const unsigned len_l
+            , const unsigned offset );
+
+  Array_t<int>      m_v;     // Furthest x reached on each diagonal
+  Array_t<int>      m_trace; // m_v after each cost, for backtracking
+  Array_t<Same_Run> m_runs;
+};
+
+// A line to be paired by Pair_Lines()
+struct Line_Ref
+{
+  const char* data;
+  unsigned    len;
+};
+
+// Pairs each of the N lines in s with one of the M lines in l, N <= M,
+// for showing changed lines side by side.  Short line k is paired with
+// a long line in [k, k+M-N], and paired long lines increase with k.
+// Candidate pairs are lines sharing MinHash values of their 3 char
+// shingles, and are confirmed with cd, so the time is about linear in
+// N+M instead of comparing every line to every line.  The in-order
+// pairs with the most chars the same are kept, and each short line
+// left over is paired at the same offset as the pair before it.
+// Puts the long line paired with each short line in pair_l.
+void Pair_Lines( const Line_Ref* s, const unsigned N
+               , const Line_Ref* l, const unsigned M
+               , Char_Diff& cd
+               , Array_t<unsigned>& pair_l );
+
+const char* Diff_Algo_2_Str( const Diff_Algo algo );
+bool        Str_2_Diff_Algo( const char* str, Diff_Algo& algo );
+
+#endif
@@ -0,0 +1,514 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>    // memcmp, memcpy, strlen, strcmp
+#include <stdio.h>     // FILE, fopen, fread, fclose
+#include <stdlib.h>    // malloc, free
+#include <unistd.h>    // readlink, close
+#include <fcntl.h>     // open
+#include <dirent.h>    // opendir, readdir, closedir
+#include <sys/stat.h>  // lstat, fstat
+#if !defined(WIN32)
+#include <pthread.h>
+#include <sys/mman.h>  // mmap, munmap, madvise
+#endif
+
+#include "Hash.hh"
+#include "Diff_Engine.hh"
+#include "Dir_Cmp.hh"
+
+// Reading files waits on the disk more than the CPU,
+// so hash on a few more threads than there are CPUs:
+static const unsigned MAX_CMP_THREADS = 64;
+
+// Cached hashes of files that have since changed are never looked up
+// again, so start over when the cache gets this big:
+static const unsigned MAX_CACHED = 1024*1024;
+
+static const unsigned NO_TASK = ~0u;
+
+static int Stat( const char* path, struct stat& sbuf )
+{
+#if defined(WIN32)
+  return ::stat( path, &sbuf );
+#else
+  return ::lstat( path, &sbuf );
+#endif
+}
+
+static bool Dot_Or_Dot_Dot( const char* name )
+{
+  return 0==strcmp( name, "." ) || 0==strcmp( name, ".." );
+}
+
+// Appends delimiter and name to path of length len,
+// returning the new length, or 0 if it does not fit
+static unsigned Append_Name( char* path, const unsigned len, const unsigned path_len
+                           , const char* name )
+{
+  const unsigned NAME_LEN = strlen( name );
+  const bool     ADD_DELIM = 0<len && '/' != path[len-1];
+  const unsigned NEW_LEN = len + ADD_DELIM + NAME_LEN;
+
+  if( path_len <= NEW_LEN ) return 0;
+
+  if( ADD_DELIM ) path[len] = '/';
+  memcpy( path + len + ADD_DELIM, name, NAME_LEN + 1 );
+
+  return NEW_LEN;
+}
+
+static void Push_Str( Array_t<char>& a, const char* s )
+{
+  for( ; *s; s++ ) a.push( *s );
+  a.push( 0 );
+}
+
+// Hashes the size bytes of the file at path, returning false if the
+// file could not be read, or its size changed since it was stat'ed
+static bool Hash_File( const char* path, const unsigned long long size
+                     , unsigned long long hash[2] )
+{
+  bool ok = false;
+#if defined(WIN32)
+  FILE* fp = fopen( path, "rb" );
+  if( fp )
+  {
+    char* data = static_cast<char*>( malloc( size ) );
+    if( data )
+    {
+      if( size == fread( data, 1, size, fp ) && EOF == fgetc( fp ) )
+      {
+        Hash_128( data, size, hash );
+        ok = true;
+      }
+      free( data );
+    }
+    fclose( fp );
+  }
+#else
+  const int fd = open( path, O_RDONLY );
+  if( 0 <= fd )
+  {
+    struct stat sbuf;
+    if( 0 == fstat( fd, &sbuf ) && size == (unsigned long long)sbuf.st_size )
+    {
+      void* data = mmap( 0, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if( MAP_FAILED != data )
+      {
+        madvise( data, size, MADV_SEQUENTIAL );
+        Hash_128( data, size, hash );
+        munmap( data, size );
+        ok = true;
+      }
+    }
+    close( fd );
+  }
+#endif
+  return ok;
+}
+
+Dir_Cmp::Dir_Cmp()
+  : m_pairs()
+  , m_pair_paths()
+  , m_files()
+  , m_tasks()
+  , m_task_paths()
+  , m_cache()
+  , m_num_cached( 0 )
+  , m_num_hashed( 0 )
+  , m_next_task( 0 )
+{
+  m_path_s[0] = 0;
+  m_path_l[0] = 0;
+}
+
+unsigned Dir_Cmp::Add( const char* path_s, const char* path_l )
+{
+  Pair p = { m_pair_paths.len(), 0, false };
+  Push_Str( m_pair_paths, path_s );
+  p.path_l = m_pair_paths.len();
+  Push_Str( m_pair_paths, path_l );
+
+  m_pairs.push( p );
+
+  return m_pairs.len()-1;
+}
+
+bool Dir_Cmp::Same( const unsigned k ) const
+{
+  return k < m_pairs.len() && m_pairs[k].same;
+}
+
+void Dir_Cmp::Clear()
+{
+  m_pairs.clear();
+  m_pair_paths.clear();
+}
+
+void Dir_Cmp::Run()
+{
+  m_files.clear();
+  m_tasks.clear();
+  m_task_paths.clear();
+  m_num_hashed = 0;
+
+  // Walk the trees, deciding everything but files needing to be hashed:
+  for( unsigned P=0; P<m_pairs.len(); P++ )
+  {
+    Pair& p = m_pairs[P];
+
+    const unsigned len_s = Append_Name( m_path_s, 0, PATH_LEN, m_pair_paths.get( p.path_s ) );
+    const unsigned len_l = Append_Name( m_path_l, 0, PATH_LEN, m_pair_paths.get( p.path_l ) );
+
+    p.same = 0<len_s && 0<len_l && Compare_Paths( P, len_s, len_l );
+  }
+  // Only hash files of pairs not already found to differ:
+  for( unsigned k=0; k<m_files.len(); k++ )
+  {
+    const File_Pair& fp = m_files[k];
+
+    if( m_pairs[ fp.pair ].same )
+    {
+      if( NO_TASK != fp.s.task ) m_tasks[ fp.s.task ].needed = true;
+      if( NO_TASK != fp.l.task ) m_tasks[ fp.l.task ].needed = true;
+    }
+  }
+  Hash_Tasks();
+
+  for( unsigned k=0; k<m_tasks.len(); k++ )
+  {
+    const Hash_Task& t = m_tasks[k];
+
+    if( t.needed && t.ok ) Add_Cached( t.key, t.hash );
+  }
+  for( unsigned k=0; k<m_files.len(); k++ )
+  {
+    const File_Pair& fp = m_files[k];
+    Pair& p = m_pairs[ fp.pair ];
+
+    if( p.same )
+    {
+      unsigned long long hash_s[2];
+      unsigned long long hash_l[2];
+
+      p.same = Hash_Of( fp.s, hash_s )
+            && Hash_Of( fp.l, hash_l )
+            && hash_s[0] == hash_l[0]
+            && hash_s[1] == hash_l[1];
+    }
+  }
+}
+
+// m_path_s and m_path_l have the paths to compare.
+// Returns false if they are known to differ.
+bool Dir_Cmp::Compare_Paths( const unsigned P
+                           , const unsigned len_s
+                           , const unsigned len_l )
+{
+  struct stat st_s;
+  struct stat st_l;
+
+  if( 0 != Stat( m_path_s, st_s )
+   || 0 != Stat( m_path_l, st_l ) ) return false;
+
+  if( S_ISDIR( st_s.st_mode ) && S_ISDIR( st_l.st_mode ) )
+  {
+    return Compare_Dirs( P, len_s, len_l );
+  }
+  if( S_ISREG( st_s.st_mode ) && S_ISREG( st_l.st_mode ) )
+  {
+#if defined(OSX)
+    const long long MTIME_S = st_s.st_mtimespec.tv_sec*1000000000LL + st_s.st_mtimespec.tv_nsec;
+    const long long MTIME_L = st_l.st_mtimespec.tv_sec*1000000000LL + st_l.st_mtimespec.tv_nsec;
+#elif defined(WIN32)
+    const long long MTIME_S = st_s.st_mtime*1000000000LL;
+    const long long MTIME_L = st_l.st_mtime*1000000000LL;
+#else
+    const long long MTIME_S = st_s.st_mtim.tv_sec*1000000000LL + st_s.st_mtim.tv_nsec;
+    const long long MTIME_L = st_l.st_mtim.tv_sec*1000000000LL + st_l.st_mtim.tv_nsec;
+#endif
+    const File_Key KEY_S = { (unsigned long long)st_s.st_dev
+                           , (unsigned long long)st_s.st_ino
+                           , (unsigned long long)st_s.st_size, MTIME_S };
+    const File_Key KEY_L = { (unsigned long long)st_l.st_dev
+                           , (unsigned long long)st_l.st_ino
+                           , (unsigned long long)st_l.st_size, MTIME_L };
+
+    return Compare_Files( P, KEY_S, KEY_L );
+  }
+#if !defined(WIN32)
+  if( S_ISLNK( st_s.st_mode ) && S_ISLNK( st_l.st_mode ) )
+  {
+    // Links are the same if they point to the same path:
+    char link_s[ PATH_LEN ];
+    char link_l[ PATH_LEN ];
+    const ssize_t LEN_S = readlink( m_path_s, link_s, PATH_LEN );
+    const ssize_t LEN_L = readlink( m_path_l, link_l, PATH_LEN );
+
+    return 0 <= LEN_S && LEN_S == LEN_L && 0 == memcmp( link_s, link_l, LEN_S );
+  }
+#endif
+  // Anything else is the same if it is the same type:
+  return (st_s.st_mode & S_IFMT) == (st_l.st_mode & S_IFMT);
+}
+
+// Directories are the same if they have the same names,
+// and the files and directories of each name are the same.
+bool Dir_Cmp::Compare_Dirs( const unsigned P
+                          , const unsigned len_s
+                          , const unsigned len_l )
+{
+  // Put the names in the long directory into a hash table:
+  Array_t<char>     names;
+  Array_t<unsigned> name_st;
+
+  DIR* dp = opendir( m_path_l );
+  if( 0 == dp ) return false;
+
+  while( dirent* de = readdir( dp ) )
+  {
+    if( !Dot_Or_Dot_Dot( de->d_name ) )
+    {
+      name_st.push( names.len() );
+      Push_Str( names, de->d_name );
+    }
+  }
+  closedir( dp );
+
+  const unsigned NUM_L = name_st.len();
+  unsigned size = 16;
+  while( size < 2*NUM_L ) size *= 2;
+  const unsigned MASK = size-1;
+
+  Array_t<unsigned> slots( size, 0 ); // Index into name_st plus 1, 0 if empty
+
+  for( unsigned k=0; k<NUM_L; k++ )
+  {
+    const char* name = names.get( name_st[k] );
+    unsigned i = Hash_64( name, strlen( name ) ) & MASK;
+    while( slots[i] ) i = (i+1) & MASK;
+    slots[i] = k+1;
+  }
+  // Look up each name in the short directory, and compare what it names:
+  dp = opendir( m_path_s );
+  if( 0 == dp ) return false;
+
+  bool same = true;
+  unsigned num_s = 0;
+
+  while( same )
+  {
+    dirent* de = readdir( dp );
+    if( 0 == de ) break;
+
+    const char* name = de->d_name;
+    if( Dot_Or_Dot_Dot( name ) ) continue;
+    num_s++;
+
+    bool found = false;
+    for( unsigned i = Hash_64( name, strlen( name ) ) & MASK
+       ; !found && slots[i]; i = (i+1) & MASK )
+    {
+      found = 0==strcmp( name, names.get( name_st[ slots[i]-1 ] ) );
+    }
+    if( !found ) same = false;
+    else {
+      const unsigned LEN_S = Append_Name( m_path_s, len_s, PATH_LEN, name );
+      const unsigned LEN_L = Append_Name( m_path_l, len_l, PATH_LEN, name );
+
+      same = 0<LEN_S && 0<LEN_L && Compare_Paths( P, LEN_S, LEN_L );
+
+      m_path_s[ len_s ] = 0;
+      m_path_l[ len_l ] = 0;
+    }
+  }
+  closedir( dp );
+
+  return same && num_s == NUM_L;
+}
+
+// Decides what it can from the stat's of the files, and puts off
+// hashing the rest until all the trees have been walked.
+bool Dir_Cmp::Compare_Files( const unsigned P
+                           , const File_Key& key_s
+                           , const File_Key& key_l )
+{
+  if( key_s.dev == key_l.dev && key_s.ino == key_l.ino ) return true;
+  if( key_s.size != key_l.size ) return false;
+  if( 0 == key_s.size ) return true;
+
+  File_Pair fp;
+  fp.pair = P;
+  Get_Side( m_path_s, key_s, fp.s );
+  Get_Side( m_path_l, key_l, fp.l );
+
+  if( NO_TASK == fp.s.task && NO_TASK == fp.l.task )
+  {
+    // Both hashes cached:
+    return fp.s.hash[0] == fp.l.hash[0]
+        && fp.s.hash[1] == fp.l.hash[1];
+  }
+  m_files.push( fp );
+
+  return true;
+}
+
+void Dir_Cmp::Get_Side( const char* path, const File_Key& key, Side& side )
+{
+  if( Find_Cached( key, side.hash ) ) side.task = NO_TASK;
+  else {
+    Hash_Task t;
+    t.path   = m_task_paths.len();
+    t.key    = key;
+    t.needed = false;
+    t.ok     = false;
+    Push_Str( m_task_paths, path );
+
+    side.task = m_tasks.len();
+    m_tasks.push( t );
+  }
+}
+
+bool Dir_Cmp::Hash_Of( const Side& side, unsigned long long hash[2] )
+{
+  if( NO_TASK == side.task )
+  {
+    hash[0] = side.hash[0];
+    hash[1] = side.hash[1];
+    return true;
+  }
+  const Hash_Task& t = m_tasks[ side.task ];
+
+  hash[0] = t.hash[0];
+  hash[1] = t.hash[1];
+
+  return t.ok;
+}
+
+bool Dir_Cmp::Find_Cached( const File_Key& key, unsigned long long hash[2] )
+{
+  if( 0 == m_num_cached ) return false;
+
+  const unsigned MASK = m_cache.len()-1;
+
+  for( unsigned i = Hash_64( &key, sizeof(key) ) & MASK
+     ; m_cache[i].used; i = (i+1) & MASK )
+  {
+    const Cached& c = m_cache[i];
+
+    if( 0 == memcmp( &c.key, &key, sizeof(key) ) )
+    {
+      hash[0] = c.hash[0];
+      hash[1] = c.hash[1];
+      return true;
+    }
+  }
+  return false;
+}
+
+void Dir_Cmp::Add_Cached( const File_Key& key, const unsigned long long hash[2] )
+{
+  unsigned long long old[2];
+  if( Find_Cached( key, old ) ) return;
+
+  if( MAX_CACHED <= m_num_cached )
+  {
+    m_cache.clear();
+    m_num_cached = 0;
+  }
+  // Keep the table at most half full:
+  if( m_cache.len() <= 2*(m_num_cached+1) )
+  {
+    Array_t<Cached> old_cache( m_cache );
+
+    const Cached EMPTY = { { 0, 0, 0, 0 }, { 0, 0 }, false };
+    const unsigned SIZE = m_cache.len() ? 2*m_cache.len() : 1024;
+    m_cache = Array_t<Cached>( SIZE, EMPTY );
+    m_num_cached = 0;
+
+    for( unsigned k=0; k<old_cache.len(); k++ )
+    {
+      if( old_cache[k].used ) Add_Cached( old_cache[k].key, old_cache[k].hash );
+    }
+  }
+  const unsigned MASK = m_cache.len()-1;
+  unsigned i = Hash_64( &key, sizeof(key) ) & MASK;
+  while( m_cache[i].used ) i = (i+1) & MASK;
+
+  Cached& c = m_cache[i];
+  c.key     = key;
+  c.hash[0] = hash[0];
+  c.hash[1] = hash[1];
+  c.used    = true;
+  m_num_cached++;
+}
+
+// Each thread takes the next task not yet taken until none are left
+void* Dir_Cmp::Worker( void* arg )
+{
+  Dir_Cmp& x = *static_cast<Dir_Cmp*>( arg );
+
+  for( ;; )
+  {
+    const unsigned T = __sync_fetch_and_add( &x.m_next_task, 1 );
+    if( x.m_tasks.len() <= T ) break;
+
+    Hash_Task& t = x.m_tasks[T];
+
+    if( t.needed )
+    {
+      t.ok = Hash_File( x.m_task_paths.get( t.path ), t.key.size, t.hash );
+    }
+  }
+  return 0;
+}
+
+void Dir_Cmp::Hash_Tasks()
+{
+  for( unsigned k=0; k<m_tasks.len(); k++ )
+  {
+    if( m_tasks[k].needed ) m_num_hashed++;
+  }
+  m_next_task = 0;
+
+#if defined(WIN32)
+  Worker( this );
+#else
+  unsigned num_threads = 2*Diff_Num_Threads();
+  if( m_num_hashed < num_threads ) num_threads = m_num_hashed;
+  if( MAX_CMP_THREADS < num_threads ) num_threads = MAX_CMP_THREADS;
+
+  pthread_t threads[ MAX_CMP_THREADS ];
+  unsigned num_started = 0;
+  for( unsigned k=1; k<num_threads; k++ )
+  {
+    if( 0 == pthread_create( &threads[num_started], 0, Worker, this ) )
+    {
+      num_started++;
+    }
+  }
+  Worker( this ); // This thread works too
+  for( unsigned k=0; k<num_started; k++ ) pthread_join( threads[k], 0 );
+#endif
+}
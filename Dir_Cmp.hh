@@ -0,0 +1,127 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __DIR_CMP_HH__
+#define __DIR_CMP_HH__
+
+#include "Array_t.hh"
+
+// Compares files and directory trees on disk, for diffing directories.
+// Files are compared by type, size and inode first, and then by a
+// 128-bit hash of their contents, hashed on several threads.  Hashes
+// are kept between calls to Run(), keyed by (dev, inode, mtime, size),
+// so comparing again only reads files that changed.  Does not depend
+// on FileBuf or the console, so it can be run outside of vis.
+class Dir_Cmp
+{
+public:
+  Dir_Cmp();
+
+  // Adds a pair of paths to be compared by the next Run(), either both
+  // regular files or both directories, which are compared recursively.
+  // Returns the index of the pair.
+  unsigned Add( const char* path_s, const char* path_l );
+
+  // Compares the pairs added since the last Clear()
+  void Run();
+
+  // After Run(), true if the two sides of pair k have the same contents
+  bool Same( const unsigned k ) const;
+
+  // Removes the pairs, but keeps the cached hashes
+  void Clear();
+
+  unsigned Num_Pairs () const { return m_pairs.len(); }
+  unsigned Num_Hashed() const { return m_num_hashed; } // By last Run()
+
+private:
+  static const unsigned PATH_LEN = 4096;
+
+  struct File_Key
+  {
+    unsigned long long dev;
+    unsigned long long ino;
+    unsigned long long size;
+    long long          mtime; // Nano seconds
+  };
+  struct Cached
+  {
+    File_Key           key;
+    unsigned long long hash[2];
+    bool               used;
+  };
+  // File whose hash is not cached, to be hashed by a worker thread
+  struct Hash_Task
+  {
+    unsigned           path; // Offset into m_task_paths
+    File_Key           key;
+    unsigned long long hash[2];
+    bool               needed;
+    bool               ok;
+  };
+  // One side of a pair of files, hashed by task, or cached hash
+  struct Side
+  {
+    unsigned           task;
+    unsigned long long hash[2];
+  };
+  // Pair of files the same size, decided after hashing
+  struct File_Pair
+  {
+    unsigned pair;
+    Side     s;
+    Side     l;
+  };
+  struct Pair
+  {
+    unsigned path_s; // Offsets into m_pair_paths
+    unsigned path_l;
+    bool     same;
+  };
+
+  bool Compare_Paths( const unsigned P, const unsigned len_s, const unsigned len_l );
+  bool Compare_Dirs ( const unsigned P, const unsigned len_s, const unsigned len_l );
+  bool Compare_Files( const unsigned P, const File_Key& key_s, const File_Key& key_l );
+  void Get_Side( const char* path, const File_Key& key, Side& side );
+  bool Find_Cached( const File_Key& key, unsigned long long hash[2] );
+  void Add_Cached ( const File_Key& key, const unsigned long long hash[2] );
+  bool Hash_Of( const Side& side, unsigned long long hash[2] );
+  void Hash_Tasks();
+  static void* Worker( void* arg );
+
+  Array_t<Pair>      m_pairs;
+  Array_t<char>      m_pair_paths;
+  Array_t<File_Pair> m_files;
+  Array_t<Hash_Task> m_tasks;
+  Array_t<char>      m_task_paths;
+  Array_t<Cached>    m_cache;  // Hash table of hashes of files
+  unsigned           m_num_cached;
+  unsigned           m_num_hashed;
+  volatile unsigned  m_next_task;
+
+  // Paths of the files being compared, built up while walking the trees:
+  char m_path_s[ PATH_LEN ];
+  char m_path_l[ PATH_LEN ];
+};
+
+#endif
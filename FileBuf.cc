@@ -22,7 +22,7 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <ctype.h>     // is(alnum|punct|space|print|lower...)
-#include <string.h>    // memcpy, memset
+#include <string.h>    // memcpy, memset, memchr
 #include <unistd.h>    // readlink
 #include <sys/stat.h>  // lstat
 #include <stdio.h>     // printf, stderr, FILE, fopen, fclose
@@ -42,6 +42,7 @@
 #include "LineView.hh"
 #include "Vis.hh"
 #include "FileBuf.hh"
+#include "Perf.hh"
 #include "Highlight_Bash.hh"
 #include "Highlight_BufferEditor.hh"
 #include "Highlight_CMake.hh"
@@ -74,6 +75,10 @@ extern const char* SHELL_BUF_NAME;
 extern const char* COLON_BUF_NAME;
 extern const char* SLASH_BUF_NAME;
 
+// Lines longer than this are not syntax highlighted, and only have
+// their search patterns found in the columns being displayed:
+const unsigned HI_MAX_LINE_LEN = 4096;
+
 struct FileBuf::Data
 {
   Data( FileBuf& parent
@@ -121,6 +126,9 @@ struct FileBuf::Data
   Encoding   decoding;
   Encoding   encoding;
   unsigned   tab_size;
+  unsigned   hi_max_line_len; // Longest line fully highlighted
+  unsigned   max_lines; // If non-zero, most lines kept by Apply_Cap()
+  unsigned   max_bytes; // If non-zero, most bytes kept by Apply_Cap()
 };
 
 FileBuf::Data::Data( FileBuf& parent
@@ -158,6 +166,9 @@ FileBuf::Data::Data( FileBuf& parent
   , decoding( ENC_BYTE )
   , encoding( ENC_BYTE )
   , tab_size( 1 )
+  , hi_max_line_len( HI_MAX_LINE_LEN )
+  , max_lines( 0 )
+  , max_bytes( 0 )
 {
   if( is_dir )
   {
@@ -205,6 +216,10 @@ FileBuf::Data::Data( FileBuf& parent
   , m_mutable( true )
   , decoding( rfb.m.decoding )
   , encoding( rfb.m.encoding )
+  , tab_size( rfb.m.tab_size )
+  , hi_max_line_len( rfb.m.hi_max_line_len )
+  , max_lines( 0 )
+  , max_bytes( 0 )
 {
   if( is_dir )
   {
@@ -884,6 +899,20 @@ void RemoveLine_Adjust_Views_topLines( FileBuf::Data& m, const unsigned l_num )
   }
 }
 
+// Keep pV over the same lines after the first num lines were removed.
+// If the view was over removed lines, it moves to the top of the file.
+void RemoveFirstLines_Adjust_View( View_IF* pV, const unsigned num )
+{
+  const unsigned top_line = pV->GetTopLine();
+  const unsigned crs_line = pV->CrsLine();
+
+  if( num <= top_line ) pV->SetTopLine( top_line - num );
+  else {
+    pV->SetTopLine( 0 );
+    pV->SetCrsRow( num < crs_line ? crs_line - num : 0 );
+  }
+}
+
 CrsPos Update_Styles_Find_St( FileBuf::Data& m, const unsigned first_line )
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -909,6 +938,21 @@ CrsPos Update_Styles_Find_St( FileBuf::Data& m, const unsigned first_line )
   return st;
 }
 
+// Leave star styles unchanged, and clear syntax styles of long line l_num
+void Clear_Long_Line_Syntax_Styles( FileBuf::Data& m, const unsigned l_num )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  Line* sp = m.styles[ l_num ];
+
+  const unsigned LL = sp->len();
+
+  for( unsigned p=0; p<LL; p++ )
+  {
+    sp->set( p, sp->get( p ) & ( HI_STAR | HI_STAR_IN_F ) );
+  }
+}
+
 // Find m.styles starting at st up to but not including fn line number
 void Find_Styles_In_Range( FileBuf::Data& m, const CrsPos st, const int fn )
 {
@@ -921,7 +965,23 @@ void Find_Styles_In_Range( FileBuf::Data& m, const CrsPos st, const int fn )
     m.file_type = FT_TEXT;
     m.pHi = new(__FILE__,__LINE__) Highlight_Text( m.self );
   }
-  m.pHi->Run_Range( st, fn );
+  // Highlight the segments between long lines, so that a long line
+  // does not have to be run through the highlighter:
+  CrsPos seg_st = st;
+
+  for( int l=st.crsLine; l<fn; l++ )
+  {
+    if( m.hi_max_line_len < m.lines[l]->len() )
+    {
+      if( seg_st.crsLine < l ) m.pHi->Run_Range( seg_st, l );
+
+      Clear_Long_Line_Syntax_Styles( m, l );
+
+      seg_st.crsLine = l+1;
+      seg_st.crsChar = 0;
+    }
+  }
+  if( seg_st.crsLine < fn ) m.pHi->Run_Range( seg_st, fn );
 }
 
 // Clear all m.styles includeing star and syntax
@@ -1968,6 +2028,78 @@ void FileBuf::InsertChar( const unsigned l_num
   if( SavingHist( m ) ) m.history.Save_InsertChar( l_num, c_num );
 }
 
+// Insert text, which can hold many lines separated by '\n's, at pos,
+// saving it as one change, and move pos to the end of the inserted text.
+//
+void FileBuf::InsertText( CrsPos& pos, const Line& text )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+  const unsigned l_num = pos.crsLine;
+  const unsigned c_num = pos.crsChar;
+  const unsigned LEN   = text.len();
+
+  ASSERT( __LINE__, l_num < m.lines.len(), "l_num < m.lines.len()" );
+
+  if( 0 == LEN ) return;
+
+  Line* lp =  m.lines[ l_num ];
+  Line* sp = m.styles[ l_num ];
+
+  ASSERT( __LINE__, c_num <= lp->len(), "c_num < lp->len()" );
+
+  // Take the rest of line l_num off, to go after text:
+  Line tail;
+  for( unsigned k=c_num; k<lp->len(); k++ ) tail.push( lp->get(k) );
+  lp->set_len( c_num );
+
+  // Split text into lines, scanning for '\n's with memchr:
+  Array_t<Line*> new_lines;
+  const char* const str = text.c_str( 0 );
+  Line* cp = lp;
+  for( unsigned st=0; cp; )
+  {
+    const char* nl = SCast<const char*>( memchr( str+st, '\n', LEN-st ) );
+    const unsigned fn = nl ? nl-str : LEN;
+
+    cp->append( str+st, fn-st );
+
+    if( nl ) {
+      cp = m.vis.BorrowLine( __FILE__,__LINE__ );
+      new_lines.push( cp );
+      st = fn+1;
+    }
+    else cp = 0;
+  }
+  const unsigned NUM_NEW = new_lines.len();
+  Line* const last = NUM_NEW ? new_lines[ NUM_NEW-1 ] : lp;
+
+  pos.crsLine = l_num + NUM_NEW;
+  pos.crsChar = last->len();
+
+  last->append( tail );
+
+  sp->set_len( c_num );
+  sp->set_len( lp->len() );
+
+  Array_t<Line*> new_styles;
+  for( unsigned k=0; k<NUM_NEW; k++ )
+  {
+    new_styles.push( m.vis.BorrowLine( __FILE__,__LINE__, new_lines[k]->len(), 0 ) );
+  }
+  bool ok = m.lines.insert( l_num+1, new_lines )
+         && m.styles.insert( l_num+1, new_styles )
+         && m.lineRegexsValid.insert( l_num+1, NUM_NEW, false )
+         && m.lineRegexsValid.set( l_num, false );
+
+  ASSERT( __LINE__, ok, "ok" );
+
+  ChangedLine( m, l_num );
+
+  if( SavingHist( m ) ) m.history.Save_InsertBlock( l_num, c_num, text );
+
+  for( unsigned k=0; k<NUM_NEW; k++ ) InsertLine_Adjust_Views_topLines( l_num+1 );
+}
+
 // Add a new line at the end of FileBuf, which is a copy of line
 //
 void FileBuf::PushLine( const Line& line )
@@ -2199,6 +2331,147 @@ uint8_t FileBuf::RemoveChar( const unsigned l_num, const unsigned c_num )
   return C;
 }
 
+// Remove the text from st up to fn, joining lines st.crsLine and fn.crsLine.
+// Only used to undo InsertText(), so the removal is not saved.
+//
+void FileBuf::RemoveText( const CrsPos& st, const CrsPos& fn )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+  const unsigned l_num   = st.crsLine;
+  const unsigned NUM_REM = fn.crsLine - st.crsLine;
+
+  ASSERT( __LINE__, st.crsLine <= fn.crsLine, "st.crsLine <= fn.crsLine" );
+  ASSERT( __LINE__, fn.crsLine < m.lines.len(), "fn.crsLine < m.lines.len()" );
+
+  Line* lp =  m.lines[ l_num ];
+  Line* sp = m.styles[ l_num ];
+  Line* fp =  m.lines[ fn.crsLine ];
+
+  ASSERT( __LINE__, st.crsChar <= lp->len(), "st.crsChar <= lp->len()" );
+
+  Line tail;
+  for( unsigned k=fn.crsChar; k<fp->len(); k++ ) tail.push( fp->get(k) );
+
+  lp->set_len( st.crsChar );
+  lp->append( tail );
+
+  sp->set_len( st.crsChar );
+  sp->set_len( lp->len() );
+
+  for( unsigned k=1; k<=NUM_REM; k++ )
+  {
+    m.vis.ReturnLine(  m.lines[ l_num+k ] );
+    m.vis.ReturnLine( m.styles[ l_num+k ] );
+  }
+  bool ok = m.lines.remove_n( l_num+1, NUM_REM )
+         && m.styles.remove_n( l_num+1, NUM_REM )
+         && m.lineRegexsValid.remove_n( l_num+1, NUM_REM )
+         && m.lineRegexsValid.set( l_num, false );
+
+  ASSERT( __LINE__, ok, "ok" );
+
+  ChangedLine( m, l_num );
+
+  for( unsigned k=0; k<NUM_REM; k++ ) RemoveLine_Adjust_Views_topLines( m, l_num+1 );
+}
+
+// Remove the first num lines, all at once, without saving the change.
+void FileBuf::RemoveFirstLines( const unsigned num )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+  ASSERT( __LINE__, num <= m.lines.len(), "num <= m.lines.len()" );
+
+  for( unsigned k=0; k<num; k++ )
+  {
+    m.vis.ReturnLine(  m.lines[ k ] );
+    m.vis.ReturnLine( m.styles[ k ] );
+  }
+  bool ok = m.lines.remove_n( 0, num )
+         && m.styles.remove_n( 0, num )
+         && m.lineRegexsValid.remove_n( 0, num );
+
+  ASSERT( __LINE__, ok, "ok" );
+
+  // Remaining line offsets and styles are still good, just shifted up:
+  if( num < m.lineOffsets.len() )
+  {
+    const unsigned OFFSET = m.lineOffsets[ num ];
+
+    m.lineOffsets.remove_n( 0, num );
+
+    for( unsigned k=0; k<m.lineOffsets.len(); k++ ) m.lineOffsets[k] -= OFFSET;
+  }
+  else m.lineOffsets.clear();
+
+  m.hi_touched_line = num < m.hi_touched_line ? m.hi_touched_line - num : 0;
+
+  for( unsigned w=0; w<MAX_WINS && w<m.views.len(); w++ )
+  {
+    RemoveFirstLines_Adjust_View( m.views[w], num );
+  }
+  if( 0 != m.line_view ) RemoveFirstLines_Adjust_View( m.line_view, num );
+}
+
+// If the number of lines or bytes has gone more than an eighth over
+// max_lines or max_bytes, drop the oldest lines to get back down to them.
+// Dropping in batches keeps the cost per line constant.
+void FileBuf::Apply_Cap()
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const unsigned NUM_LINES = m.lines.len();
+
+  if( 0 == NUM_LINES ) return;
+
+  unsigned num_drop = 0;
+
+  if( 0 < m.max_lines && m.max_lines + m.max_lines/8 < NUM_LINES )
+  {
+    num_drop = NUM_LINES - m.max_lines;
+  }
+  if( 0 < m.max_bytes )
+  {
+    const unsigned SIZE = GetSize();
+
+    if( m.max_bytes + m.max_bytes/8 < SIZE )
+    {
+      // Find first line from which there are at most max_bytes to the end:
+      unsigned k = num_drop;
+      while( k < NUM_LINES-1 && m.max_bytes < SIZE - m.lineOffsets[k] ) k++;
+
+      num_drop = k;
+    }
+  }
+  // Always keep the last line, which output is being appended to:
+  num_drop = Min( num_drop, NUM_LINES-1 );
+
+  if( 0 < num_drop ) RemoveFirstLines( num_drop );
+}
+
+unsigned FileBuf::Get_Max_Lines() const
+{
+  return m.max_lines;
+}
+
+unsigned FileBuf::Get_Max_Bytes() const
+{
+  return m.max_bytes;
+}
+
+void FileBuf::Set_Max_Lines( const unsigned max_lines )
+{
+  m.max_lines = max_lines;
+
+  Apply_Cap();
+}
+
+void FileBuf::Set_Max_Bytes( const unsigned max_bytes )
+{
+  m.max_bytes = max_bytes;
+
+  Apply_Cap();
+}
+
 void FileBuf::PopLine( Line& line )
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -2449,7 +2722,8 @@ void UpdateWinViews( FileBuf::Data& m, const bool PRINT_CMD_LINE )
       if( pV == m.vis.WinView( w2 ) )
       {
         m.self.Find_Styles( pV->GetTopLine() + pV->WorkingRows() );
-        m.self.Find_Regexs( pV->GetTopLine(), pV->WorkingRows() );
+        m.self.Find_Regexs( pV->GetTopLine(), pV->WorkingRows()
+                          , pV->GetLeftChar(), pV->WorkingCols() );
 
         pV->RepositionView();
         pV->Print_Borders();
@@ -2523,6 +2797,8 @@ void FileBuf::Find_Styles( const unsigned up_to_line )
 
     if( m.hi_touched_line < up_to_line )
     {
+      Perf_Timer perf( PERF_FIND_STYLES );
+
       // Find m.styles for some EXTRA_LINES beyond where we need to find
       // m.styles for the moment, so that when the user is scrolling down
       // through an area of a file that has not yet been syntax highlighed,
@@ -2541,21 +2817,81 @@ void FileBuf::Find_Styles( const unsigned up_to_line )
   }
 }
 
+// Called when waiting for user input.  Finds m.styles for at most
+// max_lines more lines toward up_to_line, so that paging down does not
+// have to find m.styles for lines not yet highlighted.
+// Returns true if any m.styles were found, else false.
+bool FileBuf::Find_Styles_Idle( const unsigned up_to_line
+                              , const unsigned max_lines )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const unsigned UP_TO_LINE = Min( up_to_line, NumLines() );
+
+  if( m.hi_touched_line < UP_TO_LINE )
+  {
+    Find_Styles( Min( UP_TO_LINE, m.hi_touched_line + max_lines ) );
+    return true;
+  }
+  return false;
+}
+
 void FileBuf::Find_Regexs( const unsigned start_line
-                         , const unsigned num_lines )
+                         , const unsigned num_lines
+                         , const unsigned left_char
+                         , const unsigned num_cols )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
+  Perf_Timer perf( PERF_FIND_REGEXS );
+
   Check_4_New_Regex();
 
   const unsigned up_to_line = Min( start_line+num_lines, NumLines() );
 
   for( unsigned k=start_line; k<up_to_line; k++ )
   {
-    Find_Regexs_4_Line( k );
+    if( m.hi_max_line_len < LineLen( k ) )
+    {
+      Find_Regexs_4_Window( k, left_char, num_cols );
+    }
+    else {
+      Find_Regexs_4_Line( k );
+    }
   }
 }
 
+// Called when waiting for user input.  Finds regexs for at most
+// max_lines lines, starting at start_line, whose regexs are not valid.
+// Returns true if any regexs were found, else false.
+bool FileBuf::Find_Regexs_Idle( const unsigned start_line
+                              , const unsigned num_lines
+                              , const unsigned max_lines )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  // Finding regexs in directories and the buffer editor reads the
+  // listed files, which is too slow to do while waiting for input:
+  if( m.file_type == FT_BUFFER_EDITOR
+   || m.file_type == FT_DIR ) return false;
+
+  Check_4_New_Regex();
+
+  const unsigned up_to_line = Min( start_line+num_lines
+                                 , m.lineRegexsValid.len() );
+  unsigned found = 0;
+  for( unsigned k=start_line; found<max_lines && k<up_to_line; k++ )
+  {
+    // Long lines only have their regexs found in the displayed columns:
+    if( !m.lineRegexsValid.at(k) && LineLen( k ) <= m.hi_max_line_len )
+    {
+      Find_Regexs_4_Line( k );
+      found++;
+    }
+  }
+  return 0<found;
+}
+
 void FileBuf::Check_4_New_Regex()
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -2650,6 +2986,56 @@ void FileBuf::Find_Regexs_4_Line( const unsigned line_num )
   }
 }
 
+// Find regexs in columns [st_c,st_c+num_c) of long line line_num.
+// The line is not marked valid, so the regexs in other columns are
+// found when they are displayed, or by Find_Regexs_4_Line().
+void FileBuf::Find_Regexs_4_Window( const unsigned line_num
+                                  , const unsigned st_c
+                                  , const unsigned num_c )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  if( line_num < m.lineRegexsValid.len() && !m.lineRegexsValid[line_num] )
+  {
+    Line* lp = m.lines[line_num];
+    const unsigned LL = lp->len();
+    // Include enough columns on each side of the window to find
+    // matches crossing the window edges:
+    const unsigned PAD = m.regex.len();
+    const unsigned ST  = PAD < st_c ? st_c - PAD : 0;
+    const unsigned FN  = Min( st_c + num_c + PAD, LL );
+
+    for( unsigned pos=ST; pos<FN; pos++ )
+    {
+      ClearStarStyle( m, line_num, pos );
+    }
+    String window;
+    for( unsigned pos=ST; pos<FN; pos++ ) window.push( lp->get( pos ) );
+
+    bool found = true;
+    for( unsigned p=0; found && p<window.len(); )
+    {
+      unsigned ma_pos = 0;
+      unsigned ma_len = 0;
+
+      found = Regex_Search( m, window.c_str()+p, m.regex.c_str(), ma_pos, ma_len )
+           && 0 < ma_len;
+
+      if( found )
+      {
+        const unsigned ma_st = p + ma_pos;
+        const unsigned ma_fn = p + ma_pos + ma_len;
+
+        for( unsigned pos=ma_st; pos<window.len() && pos<ma_fn; pos++ )
+        {
+          Set__StarStyle( m, line_num, ST+pos );
+        }
+        p = ma_fn;
+      }
+    }
+  }
+}
+
 #else
 
 //void Find_patterns_for_line( FileBuf::Data& m
@@ -2707,6 +3093,8 @@ void Find_patterns_for_line_case_sensitive( FileBuf::Data& m
                                           , const unsigned line_num
                                           , Line* lp
                                           , const int LL
+                                          , const int p_st
+                                          , const int p_fn
                                           , const char* star_str
                                           , const int star_len
                                           , const bool boundary_st
@@ -2715,7 +3103,7 @@ void Find_patterns_for_line_case_sensitive( FileBuf::Data& m
   Trace trace( __PRETTY_FUNCTION__ );
 
   // Search for m.regex in Line, lp, at each position p:
-  for( int p=0; p<=(LL-star_len); p++ )
+  for( int p=p_st; p<=(LL-star_len) && p<p_fn; p++ )
   {
     bool matches = !boundary_st || line_start_or_prev_C_non_ident( *lp, p );
 
@@ -2742,6 +3130,8 @@ void Find_patterns_for_line_case_insensitive( FileBuf::Data& m
                                             , const unsigned line_num
                                             , Line* lp
                                             , const int LL
+                                            , const int p_st
+                                            , const int p_fn
                                             , const char* star_str
                                             , const int star_len
                                             , const bool boundary_st
@@ -2750,7 +3140,7 @@ void Find_patterns_for_line_case_insensitive( FileBuf::Data& m
   Trace trace( __PRETTY_FUNCTION__ );
 
   // Search for m.regex in Line, lp, at each position p:
-  for( int p=0; p<=(LL-star_len); p++ )
+  for( int p=p_st; p<=(LL-star_len) && p<p_fn; p++ )
   {
     bool matches = !boundary_st || line_start_or_prev_C_non_ident( *lp, p );
 
@@ -2775,10 +3165,13 @@ void Find_patterns_for_line_case_insensitive( FileBuf::Data& m
 
 // This version does case insensitive search:
 //
+// Only matches starting at positions [p_st,p_fn) are found.
 void Find_patterns_for_line( FileBuf::Data& m
                            , const unsigned line_num
                            , Line* lp
-                           , const int LL )
+                           , const int LL
+                           , const int p_st
+                           , const int p_fn )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
@@ -2813,6 +3206,8 @@ void Find_patterns_for_line( FileBuf::Data& m
                                            , line_num
                                            , lp
                                            , LL
+                                           , p_st
+                                           , p_fn
                                            , star_str
                                            , star_len
                                            , boundary_st
@@ -2823,6 +3218,8 @@ void Find_patterns_for_line( FileBuf::Data& m
                                          , line_num
                                          , lp
                                          , LL
+                                         , p_st
+                                         , p_fn
                                          , star_str
                                          , star_len
                                          , boundary_st
@@ -3060,12 +3457,42 @@ void FileBuf::Find_Regexs_4_Line( const unsigned line_num )
           for( int k=0; k<LL; k++ ) Set__StarInFStyle( m, line_num, k );
         }
       }
-      Find_patterns_for_line( m, line_num, lp, LL );
+      Find_patterns_for_line( m, line_num, lp, LL, 0, LL );
     }
     m.lineRegexsValid.set( line_num, true );
   }
 }
 
+// Find regexs in columns [st_c,st_c+num_c) of long line line_num.
+// The line is not marked valid, so the regexs in other columns are
+// found when they are displayed, or by Find_Regexs_4_Line().
+void FileBuf::Find_Regexs_4_Window( const unsigned line_num
+                                  , const unsigned st_c
+                                  , const unsigned num_c )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  if( line_num < m.lineRegexsValid.len() && !m.lineRegexsValid.at(line_num) )
+  {
+    Line* lp = m.lines[line_num];
+    const unsigned LL = lp->len();
+    // Include enough columns on each side of the window to find
+    // matches crossing the window edges:
+    const unsigned PAD = m.regex.len();
+    const unsigned ST  = PAD < st_c ? st_c - PAD : 0;
+    const unsigned FN  = Min( st_c + num_c + PAD, LL );
+
+    for( unsigned pos=ST; pos<FN; pos++ )
+    {
+      ClearStarAndInFileStyles( m, line_num, pos );
+    }
+    if( 0<m.regex.len() && ST<FN )
+    {
+      Find_patterns_for_line( m, line_num, lp, LL, ST, FN );
+    }
+  }
+}
+
 #endif
 
 // Leave star style unchanged, and clear syntax m.styles
@@ -3730,3 +4157,20 @@ void FileBuf::Set_Tab_Size( const unsigned ts_new )
   }
 }
 
+unsigned FileBuf::Get_Hi_Max_Line_Len() const
+{
+  return m.hi_max_line_len;
+}
+
+void FileBuf::Set_Hi_Max_Line_Len( const unsigned len )
+{
+  if( 0 < len && m.hi_max_line_len != len )
+  {
+    m.hi_max_line_len = len;
+
+    ClearStyles();
+    Invalidate_Regexs();
+    Update();
+  }
+}
+
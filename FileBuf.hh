@@ -70,6 +70,7 @@ public:
   void     InsertLine( const unsigned l_num, Line* const pLine );
   void     InsertLine( const unsigned l_num );
   void     InsertLine_Adjust_Views_topLines( const unsigned l_num );
+  void     InsertText( CrsPos& pos, const Line& text );
   void     InsertChar( const unsigned l_num, const unsigned c_num
                      , const uint8_t C );
   void     PushLine( const Line& line );
@@ -82,6 +83,13 @@ public:
   Line*    RemoveLineP( const unsigned l_num );
   void     RemoveLine( const unsigned l_num );
   uint8_t  RemoveChar( const unsigned l_num, const unsigned c_num );
+  void     RemoveText( const CrsPos& st, const CrsPos& fn );
+  void     RemoveFirstLines( const unsigned num );
+  void     Apply_Cap();
+  unsigned Get_Max_Lines() const;
+  unsigned Get_Max_Bytes() const;
+  void     Set_Max_Lines( const unsigned max_lines );
+  void     Set_Max_Bytes( const unsigned max_bytes );
   void     PopLine( Line& line );
   void     PopLine();
   void     AppendLineToLine( const unsigned l_num, const Line& line );
@@ -116,10 +124,16 @@ public:
   bool     Has_LF_at_EOF() const;
   void ClearStyles();
   void Find_Styles( const unsigned up_to_line );
+  bool Find_Styles_Idle( const unsigned up_to_line, const unsigned max_lines );
   void Check_4_New_Regex();
   void Invalidate_Regexs();
-  void Find_Regexs( const unsigned start_line, const unsigned num_lines );
+  void Find_Regexs( const unsigned start_line, const unsigned num_lines
+                  , const unsigned left_char, const unsigned num_cols );
+  bool Find_Regexs_Idle( const unsigned start_line, const unsigned num_lines
+                       , const unsigned max_lines );
   void Find_Regexs_4_Line( const unsigned line_num );
+  void Find_Regexs_4_Window( const unsigned line_num
+                           , const unsigned st_c, const unsigned num_c );
   void ClearSyntaxStyles( const unsigned l_num, const unsigned c_num );
   void SetSyntaxStyle( const unsigned l_num, const unsigned c_num
                      , const unsigned style );
@@ -136,6 +150,8 @@ public:
   void     Strip_escape_seqs();
   unsigned Get_Tab_Size() const;
   void     Set_Tab_Size( const unsigned ts_new );
+  unsigned Get_Hi_Max_Line_Len() const;
+  void     Set_Hi_Max_Line_Len( const unsigned len );
 
   struct Data;
 
@@ -0,0 +1,130 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>    // memcpy
+
+#include "Hash.hh"
+
+typedef unsigned long long uint64;
+
+unsigned long long Hash_64( const void* data, const unsigned len )
+{
+  const uint64 M    = 0xc6a4a7935bd1e995ULL;
+  const int    R    = 47;
+  const uint64 SEED = 0x9747b28c;
+
+  uint64 h = SEED ^ (len * M);
+
+  const unsigned char* p   = static_cast<const unsigned char*>( data );
+  const unsigned char* END = p + (len & ~7u);
+
+  for( ; p < END; p += 8 )
+  {
+    uint64 k;
+    memcpy( &k, p, 8 );
+
+    k *= M;
+    k ^= k >> R;
+    k *= M;
+
+    h ^= k;
+    h *= M;
+  }
+  // Last 0 to 7 bytes:
+  const unsigned REM = len & 7;
+  if( REM )
+  {
+    for( unsigned k=0; k<REM; k++ ) h ^= uint64( p[k] ) << (8*k);
+    h *= M;
+  }
+  h ^= h >> R;
+  h *= M;
+  h ^= h >> R;
+
+  return h;
+}
+
+static inline uint64 Rotl_64( const uint64 x, const int r )
+{
+  return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64 Fmix_64( uint64 k )
+{
+  k ^= k >> 33;
+  k *= 0xff51afd7ed558ccdULL;
+  k ^= k >> 33;
+  k *= 0xc4ceb9fe1a85ec53ULL;
+  k ^= k >> 33;
+
+  return k;
+}
+
+void Hash_128( const void* data, const size_t len, unsigned long long h[2] )
+{
+  const uint64 C1 = 0x87c37b91114253d5ULL;
+  const uint64 C2 = 0x4cf5ad432745937fULL;
+
+  uint64 h1 = 0x9747b28c;
+  uint64 h2 = 0x9747b28c;
+
+  const unsigned char* p   = static_cast<const unsigned char*>( data );
+  const unsigned char* END = p + (len & ~size_t(15));
+
+  for( ; p < END; p += 16 )
+  {
+    uint64 k1, k2;
+    memcpy( &k1, p  , 8 );
+    memcpy( &k2, p+8, 8 );
+
+    k1 *= C1; k1 = Rotl_64( k1, 31 ); k1 *= C2; h1 ^= k1;
+    h1 = Rotl_64( h1, 27 ); h1 += h2; h1 = h1*5 + 0x52dce729;
+
+    k2 *= C2; k2 = Rotl_64( k2, 33 ); k2 *= C1; h2 ^= k2;
+    h2 = Rotl_64( h2, 31 ); h2 += h1; h2 = h2*5 + 0x38495ab5;
+  }
+  // Last 0 to 15 bytes:
+  const unsigned REM = len & 15;
+  uint64 k1 = 0;
+  uint64 k2 = 0;
+  for( unsigned k=8; k<REM; k++ ) k2 ^= uint64( p[k] ) << (8*(k-8));
+  for( unsigned k=0; k<REM && k<8; k++ ) k1 ^= uint64( p[k] ) << (8*k);
+
+  if( 8 < REM ) { k2 *= C2; k2 = Rotl_64( k2, 33 ); k2 *= C1; h2 ^= k2; }
+  if( 0 < REM ) { k1 *= C1; k1 = Rotl_64( k1, 31 ); k1 *= C2; h1 ^= k1; }
+
+  h1 ^= len;
+  h2 ^= len;
+
+  h1 += h2;
+  h2 += h1;
+
+  h1 = Fmix_64( h1 );
+  h2 = Fmix_64( h2 );
+
+  h1 += h2;
+  h2 += h1;
+
+  h[0] = h1;
+  h[1] = h2;
+}
@@ -134,18 +134,32 @@ const char* const HELP_STR =
 "  :cs3 - Switch to color scheme 1\n"
 "  :detab=tab_size = Remove tabs. Tabs are tab_size\n"
 "  :diff- Enter diff mode\n"
+"  :diffalgo=  - Show line diff algorithm\n"
+"  :diffalgo=myers|patience - Set line diff algorithm, patience by default\n"
+"  :diffignore=  - Show differences ignored by diff\n"
+"  :diffignore=space,blank,case - Ignore all white space, blank lines, case,\n"
+"                or any of them.  :diffignore=none ignores none, the default\n"
 "  :nodiff- Exit diff mode\n"
 "  :hi  - Re-syntax-highlight file\n"
+"  :hl=       - Show longest line that is syntax highlighted\n"
+"  :hl=<len>  - Only syntax highlight lines up to len chars in current file\n"
 "  :help- Go to help buffer\n"
 "  :e   - Re-read current file\n"
 "  :e filename - Edit filename\n"
 "  :map - Enter map mode to map a command\n"
+"  :maxbytes=  - Show most bytes kept in job buffer\n"
+"  :maxbytes=N - Keep only the last N bytes in job buffer, 0 for no limit\n"
+"  :maxlines=  - Show most lines kept in job buffer\n"
+"  :maxlines=N - Keep only the last N lines in job buffer, 0 for no limit\n"
 "  :n   - Go to next buffer\n"
+"  :perf- Show key to screen latency statistics\n"
+"  :perf clear - Clear key to screen latency statistics\n"
 "  :pwd - Display current working directory\n"
 "  :q   - quit current file\n"
 "  :qa  - quit all files\n"
 "  :re  - Re-draw entire screen\n"
-"  :run - If in shell buffer, run shell command\n"
+"  :jobs- List shell commands run, and their status\n"
+"  :run - If in shell buffer, run shell command in its own job buffer\n"
 "  :se  - Switch to the search editor\n"
 "  :sh  - Enter shell buffer\n"
 "  :shell-Enter shell buffer\n"
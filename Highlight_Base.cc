@@ -35,53 +35,204 @@ Highlight_Base::Highlight_Base( FileBuf& rfb )
 {
 }
 
+// Keyword table built once per HiPairs array on first use.
+// Keys made only of identifier chars are stored in an open addressing
+// hash table, so each identifier in the range is looked up once instead
+// of being compared against every key.  Keys containing other chars,
+// like "OBJECT IDENTIFIER" or "@Override", are few and are still
+// compared one at a time, in HiPairs order.
+struct HiKeyTable
+{
+  const HiKeyVal* pairs;
+  unsigned        mask;     // Number of slots - 1
+  unsList         slots;    // HiPairs index + 1 of ident keys, 0 if empty
+  unsList         lens;     // strlen() of each HiPairs key
+  unsList         specials; // HiPairs indexes of non-ident keys
+};
+
+static unsigned Hash_Key( const char* s, const unsigned LEN )
+{
+  // FNV-1a
+  unsigned h = 2166136261u;
+  for( unsigned k=0; k<LEN; k++ )
+  {
+    h ^= SCast<uint8_t>( s[k] );
+    h *= 16777619u;
+  }
+  return h;
+}
+
+static bool Key_Is_Ident( const char* key )
+{
+  for( const char* c = key; *c; c++ )
+  {
+    if( !IsIdent( SCast<uint8_t>( *c ) ) ) return false;
+  }
+  return true;
+}
+
+static void Build_Key_Table( HiKeyTable& t, const HiKeyVal* HiPairs )
+{
+  t.pairs = HiPairs;
+
+  unsigned num_ident = 0;
+  for( unsigned h=0; HiPairs[h].key; h++ )
+  {
+    t.lens.push( strlen( HiPairs[h].key ) );
+
+    if( Key_Is_Ident( HiPairs[h].key ) ) num_ident++;
+    else                                 t.specials.push( h );
+  }
+  // Keep the table at most half full:
+  unsigned num_slots = 16;
+  while( num_slots < 2*num_ident ) num_slots *= 2;
+  t.mask = num_slots - 1;
+  t.slots.set_len( num_slots );
+
+  for( unsigned h=0; HiPairs[h].key; h++ )
+  {
+    const char*    key = HiPairs[h].key;
+    const unsigned LEN = t.lens[h];
+
+    if( 0<LEN && Key_Is_Ident( key ) )
+    {
+      unsigned s = Hash_Key( key, LEN ) & t.mask;
+      bool dup = false;
+      for( ; !dup && t.slots[s]; s = (s+1) & t.mask )
+      {
+        const unsigned i = t.slots[s]-1;
+        // If a key is listed twice, the first one wins:
+        dup = t.lens[i]==LEN && 0==memcmp( HiPairs[i].key, key, LEN );
+      }
+      if( !dup ) t.slots[s] = h+1;
+    }
+  }
+}
+
+// Tables built so far, freed by Highlight_Base::Cleanup():
+static Array_t<HiKeyTable*>* key_tables = 0;
+
+static const HiKeyTable& Get_Key_Table( const HiKeyVal* HiPairs )
+{
+  if( 0 == key_tables )
+  {
+    key_tables = new(__FILE__,__LINE__) Array_t<HiKeyTable*>;
+  }
+  Array_t<HiKeyTable*>& tables = *key_tables;
+
+  for( unsigned k=0; k<tables.len(); k++ )
+  {
+    if( tables[k]->pairs == HiPairs ) return *tables[k];
+  }
+  HiKeyTable* pt = new(__FILE__,__LINE__) HiKeyTable;
+  Build_Key_Table( *pt, HiPairs );
+  tables.push( pt );
+
+  return *pt;
+}
+
+void Highlight_Base::Cleanup()
+{
+  if( 0 != key_tables )
+  {
+    for( unsigned k=0; k<key_tables->len(); k++ )
+    {
+      MemMark(__FILE__,__LINE__); delete (*key_tables)[k];
+    }
+    MemMark(__FILE__,__LINE__); delete key_tables; key_tables = 0;
+  }
+}
+
+// Returns HiPairs index + 1 of the ident key equal to the LEN chars at s,
+// or 0 if there is no such key.
+static unsigned Find_Ident_Key( const HiKeyTable& t
+                              , const char* s
+                              , const unsigned LEN )
+{
+  for( unsigned k = Hash_Key( s, LEN ) & t.mask; t.slots[k]; k = (k+1) & t.mask )
+  {
+    const unsigned i = t.slots[k]-1;
+
+    if( t.lens[i]==LEN && 0==memcmp( t.pairs[i].key, s, LEN ) ) return i+1;
+  }
+  return 0;
+}
+
+// Returns true if key matches un-styled text at p,
+// and key is followed by end of line or a non-identifier
+static bool Key_Matches( const Line& lr, const Line& sr
+                       , const unsigned LL, const unsigned p
+                       , const char* key, const unsigned KEY_LEN )
+{
+  if( 0==KEY_LEN || LL < p+KEY_LEN ) return false;
+
+  for( unsigned k=0; k<KEY_LEN; k++ )
+  {
+    if( sr.get(p+k) || key[k] != lr.get(p+k) ) return false;
+  }
+  return line_end_or_non_ident( lr, LL, p+KEY_LEN-1 );
+}
+
 void Highlight_Base::Hi_FindKey_In_Range( HiKeyVal* HiPairs
                                         , const CrsPos   st
                                         , const unsigned fn )
 {
   Trace trace( __PRETTY_FUNCTION__ );
   const unsigned NUM_LINES = m_fb.NumLines();
+  const HiKeyTable& t = Get_Key_Table( HiPairs );
 
-  for( unsigned l=st.crsLine; l<=fn && l<NUM_LINES; l++ )
+  for( unsigned l=st.crsLine; l<fn && l<NUM_LINES; l++ )
   {
     const Line&    lr = m_fb.GetLine( l );
     const Line&    sr = m_fb.GetStyle( l );
     const unsigned LL = lr.len();
 
     const unsigned st_pos = st.crsLine==l ? st.crsChar : 0;
-    const unsigned fn_pos = 0<LL ? LL-1 : 0;
 
-    for( unsigned p=st_pos; p<=fn_pos && p<LL; p++ )
+    for( unsigned p=st_pos; p<LL; p++ )
     {
-      bool key_st = !sr.get(p) && line_start_or_prev_C_non_ident( lr, p );
+      if( sr.get(p) || !line_start_or_prev_C_non_ident( lr, p ) ) continue;
+
+      // Find the end of the identifier starting at p, if any:
+      unsigned q = p;
+      while( q<LL && IsIdent( lr.get(q) ) ) q++;
+
+      unsigned found = 0; // HiPairs index + 1 of matching key
+      if( p<q )
+      {
+        found = Find_Ident_Key( t, lr.c_str(p), q-p );
 
-      for( unsigned h=0; key_st && HiPairs[h].key; h++ )
+        for( unsigned m=p; found && m<q; m++ )
+        {
+          if( sr.get(m) ) found = 0;
+        }
+      }
+      // A non-ident key listed before the ident key takes precedence:
+      for( unsigned k=0; k<t.specials.len(); k++ )
       {
-        bool matches = true;
-        const char*    key     = HiPairs[h].key;
-        const uint8_t  HI_TYPE = HiPairs[h].val;
-        const unsigned KEY_LEN = strlen( key );
+        const unsigned h = t.specials[k];
+        if( found && found <= h ) break;
 
-        for( unsigned k=0; matches && (p+k)<LL && k<KEY_LEN; k++ )
+        if( Key_Matches( lr, sr, LL, p, HiPairs[h].key, t.lens[h] ) )
         {
-          if( sr.get(p+k) || key[k] != lr.get(p+k) ) matches = false;
-          else {
-            if( k+1 == KEY_LEN ) // Found pattern
-            {
-              matches = line_end_or_non_ident( lr, LL, p+k );
-              if( matches ) {
-                for( unsigned m=p; m<p+KEY_LEN; m++ ) m_fb.SetSyntaxStyle( l, m, HI_TYPE );
-                // Increment p one less than KEY_LEN, because p
-                // will be incremented again by the for loop
-                p += KEY_LEN-1;
-                // Set key_st to false here to break out of h for loop
-                key_st = false;
-              }
-            }
-          }
+          found = h+1;
+          break;
         }
       }
+      if( found )
+      {
+        const unsigned KEY_LEN = t.lens[found-1];
+        const uint8_t  HI_TYPE = HiPairs[found-1].val;
+
+        for( unsigned m=p; m<p+KEY_LEN; m++ ) m_fb.SetSyntaxStyle( l, m, HI_TYPE );
+        // Increment p one less than KEY_LEN, because p
+        // will be incremented again by the for loop
+        p += KEY_LEN-1;
+      }
+      else if( p<q ) {
+        // No key can start inside the identifier, so skip to its end
+        p = q-1;
+      }
     }
   }
 }
-
@@ -42,6 +42,9 @@ public:
 
   virtual void Run_Range( const CrsPos st, const unsigned fn ) = 0;
 
+  // Frees the keyword tables built by Hi_FindKey_In_Range()
+  static void Cleanup();
+
 protected:
   void Hi_FindKey_In_Range( HiKeyVal* HiPairs
                           , const CrsPos st, const unsigned fn );
@@ -21,432 +21,10 @@
 // DEALINGS IN THE SOFTWARE.                                                  //
 ////////////////////////////////////////////////////////////////////////////////
 
-#include <ctype.h>
-#include <string.h>
-#include <strings.h>
-
 #include "Utilities.hh"
 #include "FileBuf.hh"
-#include "MemLog.hh"
 #include "Highlight_Bash.hh"
 
-extern MemLog<MEM_LOG_BUF_SIZE> Log;
-
-Highlight_Bash::Highlight_Bash( FileBuf& rfb )
-  : Highlight_Base( rfb )
-  , m_state( &ME::Hi_In_None )
-{
-}
-
-void Highlight_Bash::Run_Range( const CrsPos st, const unsigned fn )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-
-  m_state = &ME::Hi_In_None;
-
-  unsigned l=st.crsLine;
-  unsigned p=st.crsChar;
-
-  while( m_state && l<fn )
-  {
-    (this->*m_state)( l, p );
-  }
-  Find_Styles_Keys_In_Range( st, fn );
-}
-
-static bool Quote_Start( const char qt
-                       , const char c2
-                       , const char c1
-                       , const char c0 )
-{
-  return (c1==0    && c0==qt ) //< Quote at beginning of line
-      || (c1!='\\' && c0==qt ) //< Non-escaped quote
-      || (c2=='\\' && c1=='\\' && c0==qt ); //< Escapted escape before quote
-}
-
-static bool TwoControl( const char c1, const char c0 )
-{
-  return (c1=='=' && c0=='=')
-      || (c1=='&' && c0=='&')
-      || (c1=='|' && c0=='|')
-      || (c1=='|' && c0=='=')
-      || (c1=='&' && c0=='=')
-      || (c1=='!' && c0=='=')
-      || (c1=='+' && c0=='=')
-      || (c1=='-' && c0=='=');
-}
-
-static bool OneVarType( const char c0 )
-{
-  return (c0=='&' || c0=='#')
-      || (c0=='.' || c0=='*')
-      || (c0=='[' || c0==']');
-}
-
-static bool OneControl( const char c0 )
-{
-  return (c0=='=' || c0=='@')
-      || (c0=='^' || c0=='~')
-      || (c0==':' || c0=='%')
-      || (c0=='+' || c0=='-')
-      || (c0=='<' || c0=='>')
-      || (c0=='!' || c0=='?')
-      || (c0=='(' || c0==')')
-      || (c0=='{' || c0=='}')
-      || (c0==',' || c0==';')
-      || (c0=='/' || c0=='|');
-}
-
-void Highlight_Bash::Hi_In_None( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
-  {
-    const unsigned LL = m_fb.LineLen( l );
-
-    for( ; p<LL; p++ )
-    {
-      m_fb.ClearSyntaxStyles( l, p );
-
-      // c0 is ahead of c1 is ahead of c2: (c2,c1,c0)
-      const char c2 = 1<p ? m_fb.Get( l, p-2 ) : 0;
-      const char c1 = 0<p ? m_fb.Get( l, p-1 ) : 0;
-      const char c0 =       m_fb.Get( l, p   );
-      const bool comment = c0=='#' && (0==p || c1!='$');
-
-      if     ( comment )                    { m_state = &ME::Hi_In_Comment; }
-      else if( Quote_Start('\'',c2,c1,c0) ) { m_state = &ME::Hi_SingleQuote; }
-      else if( Quote_Start('\"',c2,c1,c0) ) { m_state = &ME::Hi_DoubleQuote; }
-      else if( !IsIdent(c1) && isdigit(c0)) { m_state = &ME::Hi_NumberBeg; }
-
-      else if( TwoControl( c1, c0 ) )
-      {
-        m_fb.SetSyntaxStyle( l, p-1, HI_CONTROL );
-        m_fb.SetSyntaxStyle( l, p  , HI_CONTROL );
-      }
-      else if( c0=='$' )
-      {
-        m_fb.SetSyntaxStyle( l, p, HI_DEFINE );
-      }
-      else if( OneVarType( c0 ) )
-      {
-        m_fb.SetSyntaxStyle( l, p, HI_VARTYPE );
-      }
-      else if( OneControl( c0 ) )
-      {
-        m_fb.SetSyntaxStyle( l, p, HI_CONTROL );
-      }
-      else if( c0 < 32 || 126 < c0 )
-      {
-        m_fb.SetSyntaxStyle( l, p, HI_NONASCII );
-      }
-      if( &ME::Hi_In_None != m_state ) return;
-    }
-    p = 0;
-  }
-  m_state = 0;
-}
-
-void Highlight_Bash::Hi_In_Comment( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
-
-  for( ; p<LL; p++ )
-  {
-    m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
-  }
-  p=0; l++;
-  m_state = &ME::Hi_In_None;
-}
-
-//void Highlight_Bash::Hi_SingleQuote( unsigned& l, unsigned& p )
-//{
-//  Trace trace( __PRETTY_FUNCTION__ );
-//
-//  m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-//
-//  for( ; l<m_fb.NumLines(); l++ )
-//  {
-//    const unsigned LL = m_fb.LineLen( l );
-//
-//    bool slash_escaped = false;
-//    for( ; p<LL; p++ )
-//    {
-//      // c0 is ahead of c1: (c1,c0)
-//      const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-//      const char c0 =     m_fb.Get( l, p );
-//
-//      if( (c1==0    && c0=='\'')
-//       || (c1!='\\' && c0=='\'')
-//       || (c1=='\\' && c0=='\'' && slash_escaped) )
-//      {
-//        m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-//        m_state = &ME::Hi_In_None;
-//      }
-//      else {
-//        if( c1=='\\' && c0=='\\' ) slash_escaped = !slash_escaped;
-//        else                       slash_escaped = false;
-//
-//        m_fb.SetSyntaxStyle( l, p, HI_CONST );
-//      }
-//      if( &ME::Hi_SingleQuote != m_state ) return;
-//    }
-//    p = 0;
-//  }
-//  m_state = 0;
-//}
-void Highlight_Bash::Hi_SingleQuote( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-
-  m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-
-  for( ; l<m_fb.NumLines(); l++ )
-  {
-    const unsigned LL = m_fb.LineLen( l );
-
-    bool slash_escaped = false;
-    for( ; p<LL; p++ )
-    {
-      // c0 is ahead of c1: (c1,c0)
-      const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-      const char c0 =     m_fb.Get( l, p );
-
-      if( (c1==0    && c0=='\'')
-       || (c1!='\\' && c0=='\'')
-       || (c1=='\\' && c0=='\'' && slash_escaped) )
-      {
-        // End of single quote:
-        m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-        m_state = &ME::Hi_In_None;
-      }
-      else {
-        if( (c1!='\\' && c0=='$')
-         || (c1=='\\' && c0=='$' && slash_escaped) )
-        {
-          m_fb.SetSyntaxStyle( l, p, HI_DEFINE );
-        }
-        else {
-          m_fb.SetSyntaxStyle( l, p, HI_CONST );
-        }
-        slash_escaped = (c1=='\\' && c0=='\\') ? !slash_escaped : false;
-      }
-      if( &ME::Hi_SingleQuote != m_state ) return;
-    }
-    p = 0;
-  }
-  m_state = 0;
-}
-
-//void Highlight_Bash::Hi_DoubleQuote( unsigned& l, unsigned& p )
-//{
-//  Trace trace( __PRETTY_FUNCTION__ );
-//
-//  m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-//
-//  for( ; l<m_fb.NumLines(); l++ )
-//  {
-//    const unsigned LL = m_fb.LineLen( l );
-//
-//    bool slash_escaped = false;
-//    for( ; p<LL; p++ )
-//    {
-//      // c0 is ahead of c1: c1,c0
-//      const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-//      const char c0 =     m_fb.Get( l, p   );
-//
-//      // c0 is ahead of c1: (c1,c0)
-//      if( (c1==0    && c0=='\"')
-//       || (c1!='\\' && c0=='\"')
-//       || (c1=='\\' && c0=='\"' && slash_escaped) )
-//      {
-//        m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-//        m_state = &ME::Hi_In_None;
-//      }
-//      else {
-//        if( c1=='\\' && c0=='\\' ) slash_escaped = !slash_escaped;
-//        else                       slash_escaped = false;
-//
-//        m_fb.SetSyntaxStyle( l, p, HI_CONST );
-//      }
-//      if( &ME::Hi_DoubleQuote != m_state ) return;
-//    }
-//    p = 0;
-//  }
-//  m_state = 0;
-//}
-void Highlight_Bash::Hi_DoubleQuote( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-
-  m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-
-  for( ; l<m_fb.NumLines(); l++ )
-  {
-    const unsigned LL = m_fb.LineLen( l );
-
-    bool slash_escaped = false;
-    for( ; p<LL; p++ )
-    {
-      // c0 is ahead of c1: c1,c0
-      const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-      const char c0 =     m_fb.Get( l, p   );
-
-      if( (c1==0    && c0=='\"')
-       || (c1!='\\' && c0=='\"')
-       || (c1=='\\' && c0=='\"' && slash_escaped) )
-      {
-        // End of double quote:
-        m_fb.SetSyntaxStyle( l, p, HI_CONST ); p++;
-        m_state = &ME::Hi_In_None;
-      }
-      else {
-        if( (c1!='\\' && c0=='$')
-         || (c1=='\\' && c0=='$' && slash_escaped) )
-        {
-          m_fb.SetSyntaxStyle( l, p, HI_DEFINE );
-        }
-        else {
-          m_fb.SetSyntaxStyle( l, p, HI_CONST );
-        }
-        slash_escaped = (c1=='\\' && c0=='\\') ? !slash_escaped : false;
-      }
-      if( &ME::Hi_DoubleQuote != m_state ) return;
-    }
-    p = 0;
-  }
-  m_state = 0;
-}
-
-void Highlight_Bash::Hi_NumberBeg( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  m_fb.SetSyntaxStyle( l, p, HI_CONST );
-
-  const char c1 = m_fb.Get( l, p );
-  p++;
-  m_state = &ME::Hi_NumberIn;
-
-  const unsigned LL = m_fb.LineLen( l );
-  if( '0' == c1 && (p+1)<LL )
-  {
-    const char c0 = m_fb.Get( l, p );
-    if( 'x' == c0 ) {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      m_state = &ME::Hi_NumberHex;
-      p++;
-    }
-  }
-}
-
-void Highlight_Bash::Hi_NumberIn( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
-  if( LL <= p ) m_state = &ME::Hi_In_None;
-  else {
-    const char c1 = m_fb.Get( l, p );
-
-    if( '.'==c1 )
-    {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      m_state = &ME::Hi_NumberFraction;
-      p++;
-    }
-    else if( 'e'==c1 || 'E'==c1 )
-    {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      m_state = &ME::Hi_NumberExponent;
-      p++;
-      if( p<LL )
-      {
-        const char c0 = m_fb.Get( l, p );
-        if( '+' == c0 || '-' == c0 ) {
-          m_fb.SetSyntaxStyle( l, p, HI_CONST );
-          p++;
-        }
-      }
-    }
-    else if( isdigit(c1) )
-    {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      p++;
-    }
-    else {
-      m_state = &ME::Hi_In_None;
-    }
-  }
-}
-
-void Highlight_Bash::Hi_NumberHex( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
-  if( LL <= p ) m_state = &ME::Hi_In_None;
-  else {
-    const char c1 = m_fb.Get( l, p );
-    if( isxdigit(c1) )
-    {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      p++;
-    }
-    else {
-      m_state = &ME::Hi_In_None;
-    }
-  }
-}
-
-void Highlight_Bash::Hi_NumberFraction( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
-  if( LL <= p ) m_state = &ME::Hi_In_None;
-  else {
-    const char c1 = m_fb.Get( l, p );
-    if( isdigit(c1) )
-    {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      p++;
-    }
-    else if( 'e'==c1 || 'E'==c1 )
-    {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      m_state = &ME::Hi_NumberExponent;
-      p++;
-      if( p<LL )
-      {
-        const char c0 = m_fb.Get( l, p );
-        if( '+' == c0 || '-' == c0 ) {
-          m_fb.SetSyntaxStyle( l, p, HI_CONST );
-          p++;
-        }
-      }
-    }
-    else {
-      m_state = &ME::Hi_In_None;
-    }
-  }
-}
-
-void Highlight_Bash::Hi_NumberExponent( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
-  if( LL <= p ) m_state = &ME::Hi_In_None;
-  else {
-    const char c1 = m_fb.Get( l, p );
-    if( isdigit(c1) )
-    {
-      m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      p++;
-    }
-    else {
-      m_state = &ME::Hi_In_None;
-    }
-  }
-}
-
 static HiKeyVal HiPairs[] =
 {
   { "if"                 , HI_CONTROL },
@@ -524,12 +102,10 @@ static HiKeyVal HiPairs[] =
   { 0 }
 };
 
-void Highlight_Bash::
-     Find_Styles_Keys_In_Range( const CrsPos   st
-                              , const unsigned fn )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
+static HiCodeSyntax Syntax( "#", 0, 0, 0, "\'\"", 0, HiPairs
+                          , "$", true, "@", 0, true );
 
-  Hi_FindKey_In_Range( HiPairs, st, fn );
+Highlight_Bash::Highlight_Bash( FileBuf& rfb )
+  : Highlight_Code( rfb, Syntax )
+{
 }
-
@@ -24,33 +24,12 @@
 #ifndef __HIGHLIGHT_BASH_HH__
 #define __HIGHLIGHT_BASH_HH__
 
-#include "Highlight_Base.hh"
+#include "Highlight_Code.hh"
 
-class Highlight_Bash : public Highlight_Base
+class Highlight_Bash : public Highlight_Code
 {
 public:
   Highlight_Bash( FileBuf& rfb );
-
-private:
-  void Run_Range( const CrsPos st, const unsigned fn );
-
-  void Hi_In_None       ( unsigned& l, unsigned& p );
-  void Hi_In_Comment    ( unsigned& l, unsigned& p );
-  void Hi_SingleQuote   ( unsigned& l, unsigned& p );
-  void Hi_DoubleQuote   ( unsigned& l, unsigned& p );
-  void Hi_NumberBeg     ( unsigned& l, unsigned& p );
-  void Hi_NumberIn      ( unsigned& l, unsigned& p );
-  void Hi_NumberHex     ( unsigned& l, unsigned& p );
-  void Hi_NumberFraction( unsigned& l, unsigned& p );
-  void Hi_NumberExponent( unsigned& l, unsigned& p );
-
-  typedef Highlight_Bash ME;
-  typedef void (ME::*HiStateFunc) ( unsigned&, unsigned& );
-
-  virtual void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn );
-
-  HiStateFunc m_state;
 };
 
 #endif
-
@@ -34,12 +34,14 @@ extern const char* EDIT_BUF_NAME;
 extern const char* HELP_BUF_NAME;
 extern const char* MSG__BUF_NAME;
 extern const char* SHELL_BUF_NAME;
+extern const char*   JOB_BUF_NAME;
 extern const char* COLON_BUF_NAME;
 extern const char* SLASH_BUF_NAME;
 
 Highlight_BufferEditor::Highlight_BufferEditor( FileBuf& rfb )
   : Highlight_Base( rfb )
   , m_state( &ME::Hi_In_None )
+  , m_fn( 0 )
 {
 }
 
@@ -49,6 +51,7 @@ void Highlight_BufferEditor::Run_Range( const CrsPos   st
   Trace trace( __PRETTY_FUNCTION__ );
 
   m_state = &ME::Hi_In_None;
+  m_fn    = Min( fn, m_fb.NumLines() );
 
   unsigned l=st.crsLine;
   unsigned p=st.crsChar;
@@ -63,7 +66,7 @@ void Highlight_BufferEditor::Hi_In_None( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const Line&    lr = m_fb.GetLine( l );
     const unsigned LL = m_fb.LineLen( l );
@@ -78,7 +81,8 @@ void Highlight_BufferEditor::Hi_In_None( unsigned& l, unsigned& p )
        || 0==strncmp( ls, MSG__BUF_NAME, lr.len() )
        || 0==strncmp( ls, SHELL_BUF_NAME, lr.len() )
        || 0==strncmp( ls, COLON_BUF_NAME, lr.len() )
-       || 0==strncmp( ls, SLASH_BUF_NAME, lr.len() ) )
+       || 0==strncmp( ls, SLASH_BUF_NAME, lr.len() )
+       || 0==strncmp( ls, JOB_BUF_NAME, strlen( JOB_BUF_NAME ) ) )
       {
         for( int k=0; k<LL; k++ )
         {
@@ -40,6 +40,7 @@ private:
   typedef void (Highlight_BufferEditor::*HiStateFunc) ( unsigned&, unsigned& );
 
   HiStateFunc m_state;
+  unsigned    m_fn; // Line at which Run_Range() stops
 };
 
 #endif
@@ -32,44 +32,20 @@
 
 extern MemLog<MEM_LOG_BUF_SIZE> Log;
 
-Highlight_Code::Highlight_Code( FileBuf& rfb )
-  : Highlight_Base( rfb )
-  , m_state( &ME::Hi_In_None )
-{
-}
-
-void Highlight_Code::Run_Range( const CrsPos st, const unsigned fn )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-
-  m_state = &ME::Hi_In_None;
-
-  unsigned l=st.crsLine;
-  unsigned p=st.crsChar;
-
-  while( m_state && l<fn )
-  {
-    (this->*m_state)( l, p );
-  }
-  Find_Styles_Keys_In_Range( st, fn );
-}
-
-static bool Quote_Start( const char qt
-                       , const char c2
-                       , const char c1
-                       , const char c0 )
-{
-  return (c1==0    && c0==qt ) //< Quote at beginning of line
-      || (c1!='\\' && c0==qt ) //< Non-escaped quote
-      || (c2=='\\' && c1=='\\' && c0==qt ); //< Escaped escape before quote
-}
-bool OneVarType( const char c0 )
+// Byte classes:
+const uint8_t BC_IDENT     = 0x01;
+const uint8_t BC_DIGIT     = 0x02;
+const uint8_t BC_QUOTE     = 0x04;
+const uint8_t BC_RAW_QUOTE = 0x08;
+const uint8_t BC_VAR       = 0x10;
+
+static bool OneVarType( const uint8_t c0 )
 {
   return (c0=='&')
       || (c0=='.' || c0=='*')
       || (c0=='[' || c0==']');
 }
-static bool OneControl( const char c0 )
+static bool OneControl( const uint8_t c0 )
 {
   return c0=='=' || c0=='^' || c0=='~'
       || c0==':' || c0=='%'
@@ -81,7 +57,7 @@ static bool OneControl( const char c0 )
       || c0==',' || c0==';'
       || c0=='/' || c0=='|';
 }
-bool TwoControl( const char c1, const char c0 )
+static bool TwoControl( const uint8_t c1, const uint8_t c0 )
 {
   return (c1=='=' && c0=='=')
       || (c1=='&' && c0=='&')
@@ -92,30 +68,120 @@ bool TwoControl( const char c1, const char c0 )
       || (c1=='+' && c0=='=')
       || (c1=='-' && c0=='=');
 }
+static bool Quote_Start( const uint8_t qt
+                       , const uint8_t c2
+                       , const uint8_t c1
+                       , const uint8_t c0 )
+{
+  return (c1==0    && c0==qt ) //< Quote at beginning of line
+      || (c1!='\\' && c0==qt ) //< Non-escaped quote
+      || (c2=='\\' && c1=='\\' && c0==qt ); //< Escaped escape before quote
+}
+// Returns true if delim, of length LEN, starts at position p of lr
+static bool Delim( const char* delim, const unsigned LEN
+                 , const Line& lr, const unsigned p )
+{
+  return delim && p+LEN <= lr.len()
+               && 0==memcmp( lr.c_str( p ), delim, LEN );
+}
+
+Highlight_Code::Highlight_Code( FileBuf& rfb, const HiCodeSyntax& syn )
+  : Highlight_Base( rfb )
+  , m_syn( syn )
+  , m_lc_len( syn.line_comment ? strlen( syn.line_comment ) : 0 )
+  , m_bb_len( syn.block_beg    ? strlen( syn.block_beg    ) : 0 )
+  , m_be_len( syn.block_end    ? strlen( syn.block_end    ) : 0 )
+  , m_quote( 0 )
+  , m_state( &ME::Hi_In_None )
+  , m_fn( 0 )
+{
+  // Classify every byte once, so the state functions only do
+  // table look ups instead of comparing each char to lists of chars:
+  for( unsigned c=0; c<256; c++ )
+  {
+    m_class[c] = 0;
+    if( IsIdent( c ) ) m_class[c] |= BC_IDENT;
+    if( isdigit( c ) ) m_class[c] |= BC_DIGIT;
+
+    if     ( OneVarType( c ) ) m_style[c] = HI_VARTYPE;
+    else if( OneControl( c ) ) m_style[c] = HI_CONTROL;
+    else if( c < 32 || 126 < c ) m_style[c] = HI_NONASCII;
+    else                       m_style[c] = 0;
+  }
+  for( const char* q = m_syn.quotes; q && *q; q++ )
+  {
+    m_class[ SCast<uint8_t>(*q) ] |= BC_QUOTE;
+  }
+  for( const char* q = m_syn.raw_quotes; q && *q; q++ )
+  {
+    m_class[ SCast<uint8_t>(*q) ] |= BC_RAW_QUOTE;
+  }
+  for( const char* v = m_syn.vars; v && *v; v++ )
+  {
+    m_class[ SCast<uint8_t>(*v) ] |= BC_VAR;
+    m_style[ SCast<uint8_t>(*v) ]  = HI_DEFINE;
+  }
+  for( const char* c = m_syn.controls; c && *c; c++ )
+  {
+    m_style[ SCast<uint8_t>(*c) ] = HI_CONTROL;
+  }
+}
+
+void Highlight_Code::Run_Range( const CrsPos st, const unsigned fn )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  m_state = &ME::Hi_In_None;
+  m_fn    = Min( fn, m_fb.NumLines() );
+
+  unsigned l=st.crsLine;
+  unsigned p=st.crsChar;
+
+  while( m_state && l<fn )
+  {
+    (this->*m_state)( l, p );
+  }
+  Hi_FindKey_In_Range( m_syn.keys, st, fn );
+}
 
 void Highlight_Code::Hi_In_None( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
-    const unsigned LL = m_fb.LineLen( l );
+    const Line&    lr = m_fb.GetLine( l );
+    const unsigned LL = lr.len();
 
     for( ; p<LL; p++ )
     {
       m_fb.ClearSyntaxStyles( l, p );
 
       // c0 is ahead of c1 is ahead of c2: (c2,c1,c0)
-      const char c2 = (1<p) ? m_fb.Get( l, p-2 ) : 0;
-      const char c1 = (0<p) ? m_fb.Get( l, p-1 ) : 0;
-      const char c0 =         m_fb.Get( l, p );
-
-      if     ( c1=='/' && c0 == '/' ) { p--; m_state = &ME::Hi_BegCPP_Comment; }
-      else if( c1=='/' && c0 == '*' ) { p--; m_state = &ME::Hi_BegC_Comment; }
-      else if(            c0 == '#' ) { m_state = &ME::Hi_In_Define; }
-      else if( Quote_Start('\'',c2,c1,c0) ) { m_state = &ME::Hi_In_SingleQuote; }
-      else if( Quote_Start('\"',c2,c1,c0) ) { m_state = &ME::Hi_In_DoubleQuote; }
-      else if( !IsIdent( c1 )
-             && isdigit(c0)){ m_state = &ME::Hi_NumberBeg; }
+      const uint8_t c2 = (1<p) ? lr.get( p-2 ) : 0;
+      const uint8_t c1 = (0<p) ? lr.get( p-1 ) : 0;
+      const uint8_t c0 =         lr.get( p );
+
+      if( Delim( m_syn.line_comment, m_lc_len, lr, p ) )
+      {
+        if( m_class[c1] & BC_VAR )
+        {
+          // Variable, like $#, not a comment:
+          for( unsigned k=0; k<m_lc_len; k++ )
+          {
+            m_fb.SetSyntaxStyle( l, p+k, HI_VARTYPE );
+          }
+          p += m_lc_len-1;
+        }
+        else m_state = &ME::Hi_In_CPP_Comment;
+      }
+      else if( Delim( m_syn.block_beg, m_bb_len, lr, p ) ) { m_state = &ME::Hi_BegC_Comment; }
+      else if( m_syn.define && c0 == m_syn.define  ) { m_state = &ME::Hi_In_Define; }
+      else if( (m_class[c0] & BC_QUOTE)
+             && Quote_Start(c0,c2,c1,c0) ) { m_quote = c0; m_state = &ME::Hi_In_Quote; }
+      else if( (m_class[c0] & BC_RAW_QUOTE)
+             && Quote_Start(c0,c2,c1,c0) ) { m_quote = c0; m_state = &ME::Hi_In_Raw_Quote; }
+      else if( !(m_class[c1] & BC_IDENT)
+             &&  (m_class[c0] & BC_DIGIT) ){ m_state = &ME::Hi_NumberBeg; }
 
       else if( (c1==':' && c0==':')
             || (c1=='-' && c0=='>') )
@@ -128,17 +194,13 @@ void Highlight_Code::Hi_In_None( unsigned& l, unsigned& p )
         m_fb.SetSyntaxStyle( l, p-1, HI_CONTROL );
         m_fb.SetSyntaxStyle( l, p  , HI_CONTROL );
       }
-      else if( OneVarType( c0 ) )
+      else if( m_style[c0] )
       {
-        m_fb.SetSyntaxStyle( l, p, HI_VARTYPE );
+        m_fb.SetSyntaxStyle( l, p, m_style[c0] );
       }
-      else if( OneControl( c0 ) )
+      else if( m_syn.line_cont && c0 == m_syn.line_cont && p+1 == LL )
       {
-        m_fb.SetSyntaxStyle( l, p, HI_CONTROL );
-      }
-      else if( c0 < 32 || 126 < c0 )
-      {
-        m_fb.SetSyntaxStyle( l, p, HI_NONASCII );
+        m_fb.SetSyntaxStyle( l, p, HI_DEFINE );
       }
       if( &ME::Hi_In_None != m_state ) return;
     }
@@ -150,24 +212,21 @@ void Highlight_Code::Hi_In_None( unsigned& l, unsigned& p )
 void Highlight_Code::Hi_In_Define( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
+  const Line&    lr = m_fb.GetLine( l );
+  const unsigned LL = lr.len();
 
-  char ce = 0; // character at end of line
+  uint8_t ce = 0; // character at end of line
   for( ; p<LL; p++ )
   {
-    // c0 is ahead of c1: (c1,c0)
-    const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-    const char c0 =     m_fb.Get( l, p );
+    const uint8_t c0 = lr.get( p );
 
-    if( c1=='/' && c0=='/' )
+    if( Delim( m_syn.line_comment, m_lc_len, lr, p ) )
     {
-      m_state = &ME::Hi_BegCPP_Comment;
-      p--;
+      m_state = &ME::Hi_In_CPP_Comment;
     }
-    else if( c1=='/' && c0=='*' )
+    else if( Delim( m_syn.block_beg, m_bb_len, lr, p ) )
     {
       m_state = &ME::Hi_BegC_Comment;
-      p--;
     }
     else {
       m_fb.SetSyntaxStyle( l, p, HI_DEFINE );
@@ -186,53 +245,39 @@ void Highlight_Code::Hi_In_Define( unsigned& l, unsigned& p )
 void Highlight_Code::Hi_BegC_Comment( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
-  p++;
+  for( unsigned k=0; k<m_bb_len; k++ )
+  {
+    m_fb.SetSyntaxStyle( l, p++, HI_COMMENT );
+  }
   m_state = &ME::Hi_In_C_Comment;
 }
 
 void Highlight_Code::Hi_In_C_Comment( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
-    const unsigned LL = m_fb.LineLen( l );
+    const Line&    lr = m_fb.GetLine( l );
+    const unsigned LL = lr.len();
 
     for( ; p<LL; p++ )
     {
-      // c0 is ahead of c1: (c1,c0)
-      const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-      const char c0 =     m_fb.Get( l, p );
-
-      if( c1=='*' && c0=='/' )
+      if( Delim( m_syn.block_end, m_be_len, lr, p ) )
       {
-        m_state = &ME::Hi_EndC_Comment;
+        for( unsigned k=0; k<m_be_len; k++ )
+        {
+          m_fb.SetSyntaxStyle( l, p++, HI_COMMENT );
+        }
+        m_state = &ME::Hi_In_None;
+        return;
       }
-      else m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
-
-      if( &ME::Hi_In_C_Comment != m_state ) return;
+      m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
     }
     p = 0;
   }
   m_state = 0;
 }
 
-void Highlight_Code::Hi_EndC_Comment( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
-  p++;
-  m_state = &ME::Hi_In_None;
-}
-
-void Highlight_Code::Hi_BegCPP_Comment( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
-  p++;
-  m_state = &ME::Hi_In_CPP_Comment;
-}
-
 void Highlight_Code::Hi_In_CPP_Comment( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -242,86 +287,75 @@ void Highlight_Code::Hi_In_CPP_Comment( unsigned& l, unsigned& p )
   {
     m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
   }
-  p--;
-  m_state = &ME::Hi_EndCPP_Comment;
-}
-
-void Highlight_Code::Hi_EndCPP_Comment( unsigned& l, unsigned& p )
-{
-  Trace trace( __PRETTY_FUNCTION__ );
-  m_fb.SetSyntaxStyle( l, p, HI_COMMENT );
   p=0; l++;
   m_state = &ME::Hi_In_None;
 }
 
-void Highlight_Code::Hi_In_SingleQuote( unsigned& l, unsigned& p )
+// In quote ended by m_quote, where \ escapes the next char
+void Highlight_Code::Hi_In_Quote( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
   m_fb.SetSyntaxStyle( l, p, HI_CONST );
   p++;
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
-    const unsigned LL = m_fb.LineLen( l );
+    const Line&    lr = m_fb.GetLine( l );
+    const unsigned LL = lr.len();
 
     bool slash_escaped = false;
     for( ; p<LL; p++ )
     {
       // c0 is ahead of c1: (c1,c0)
-      const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-      const char c0 =     m_fb.Get( l, p );
+      const uint8_t c1 = p ? lr.get( p-1 ) : 0;
+      const uint8_t c0 =     lr.get( p );
 
-      if( (c1==0    && c0=='\'')
-       || (c1!='\\' && c0=='\'')
-       || (c1=='\\' && c0=='\'' && slash_escaped) )
+      if( (c1==0    && c0==m_quote)
+       || (c1!='\\' && c0==m_quote)
+       || (c1=='\\' && c0==m_quote && slash_escaped) )
       {
         m_fb.SetSyntaxStyle( l, p, HI_CONST );
         p++;
         m_state = &ME::Hi_In_None;
       }
       else {
+        const bool var = m_syn.vars_in_quotes && (m_class[c0] & BC_VAR)
+                      && (c1!='\\' || slash_escaped);
+
         if( c1=='\\' && c0=='\\' ) slash_escaped = !slash_escaped;
         else                       slash_escaped = false;
 
-        m_fb.SetSyntaxStyle( l, p, HI_CONST );
+        m_fb.SetSyntaxStyle( l, p, var ? HI_DEFINE : HI_CONST );
       }
-      if( &ME::Hi_In_SingleQuote != m_state ) return;
+      if( &ME::Hi_In_Quote != m_state ) return;
     }
     p = 0;
   }
   m_state = 0;
 }
 
-void Highlight_Code::Hi_In_DoubleQuote( unsigned& l, unsigned& p )
+// In quote ended by m_quote, with no escapes
+void Highlight_Code::Hi_In_Raw_Quote( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
   m_fb.SetSyntaxStyle( l, p, HI_CONST );
   p++;
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
-    const unsigned LL = m_fb.LineLen( l );
+    const Line&    lr = m_fb.GetLine( l );
+    const unsigned LL = lr.len();
 
-    bool slash_escaped = false;
     for( ; p<LL; p++ )
     {
-      // c0 is ahead of c1: (c1,c0)
-      const char c1 = p ? m_fb.Get( l, p-1 ) : 0;
-      const char c0 =     m_fb.Get( l, p );
+      const uint8_t c0 = lr.get( p );
 
-      if( (c1==0    && c0=='\"')
-       || (c1!='\\' && c0=='\"')
-       || (c1=='\\' && c0=='\"' && slash_escaped) )
+      m_fb.SetSyntaxStyle( l, p, HI_CONST );
+
+      if( c0==m_quote )
       {
-        m_fb.SetSyntaxStyle( l, p, HI_CONST );
         p++;
         m_state = &ME::Hi_In_None;
+        return;
       }
-      else {
-        if( c1=='\\' && c0=='\\' ) slash_escaped = !slash_escaped;
-        else                       slash_escaped = false;
-
-        m_fb.SetSyntaxStyle( l, p, HI_CONST );
-      }
-      if( &ME::Hi_In_DoubleQuote != m_state ) return;
     }
     p = 0;
   }
@@ -333,15 +367,16 @@ void Highlight_Code::Hi_NumberBeg( unsigned& l, unsigned& p )
   Trace trace( __PRETTY_FUNCTION__ );
   m_fb.SetSyntaxStyle( l, p, HI_CONST );
 
-  const char c1 = m_fb.Get( l, p );
+  const Line&    lr = m_fb.GetLine( l );
+  const unsigned LL = lr.len();
+
+  const uint8_t c1 = lr.get( p );
   p++;
   m_state = &ME::Hi_NumberIn;
 
-  const unsigned LL = m_fb.LineLen( l );
-
   if( '0' == c1 && (p+1)<LL )
   {
-    const char c0 = m_fb.Get( l, p );
+    const uint8_t c0 = lr.get( p );
 
     if( 'x' == c0 || 'X' == c0 )
     {
@@ -352,20 +387,14 @@ void Highlight_Code::Hi_NumberBeg( unsigned& l, unsigned& p )
   }
 }
 
-// Need to add highlighting for:
-//   L = long
-//   U = unsigned
-//   UL = unsigned long
-//   ULL = unsigned long long
-//   F = float
-// at the end of numbers
 void Highlight_Code::Hi_NumberIn( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
+  const Line&    lr = m_fb.GetLine( l );
+  const unsigned LL = lr.len();
   if( LL <= p ) m_state = &ME::Hi_In_None;
   else {
-    const char c1 = m_fb.Get( l, p );
+    const uint8_t c1 = lr.get( p );
 
     if( '.'==c1 )
     {
@@ -380,18 +409,22 @@ void Highlight_Code::Hi_NumberIn( unsigned& l, unsigned& p )
       p++;
       if( p<LL )
       {
-        const char c0 = m_fb.Get( l, p );
+        const uint8_t c0 = lr.get( p );
         if( '+' == c0 || '-' == c0 ) {
           m_fb.SetSyntaxStyle( l, p, HI_CONST );
           p++;
         }
       }
     }
-    else if( isdigit(c1) )
+    else if( m_class[c1] & BC_DIGIT )
     {
       m_fb.SetSyntaxStyle( l, p, HI_CONST );
       p++;
     }
+    else if( m_syn.plain_numbers )
+    {
+      m_state = &ME::Hi_In_None;
+    }
     else if( c1=='L' || c1=='F' || c1=='U' )
     {
       m_state = &ME::Hi_NumberTypeSpec;
@@ -399,9 +432,9 @@ void Highlight_Code::Hi_NumberIn( unsigned& l, unsigned& p )
     else if( c1=='\'' && (p+1)<LL )
     {
       // ' is followed by another digit on line
-      const char c0 = m_fb.Get( l, p+1 );
+      const uint8_t c0 = lr.get( p+1 );
 
-      if( isdigit( c0 ) )
+      if( m_class[c0] & BC_DIGIT )
       {
         m_fb.SetSyntaxStyle( l, p  , HI_CONST );
         m_fb.SetSyntaxStyle( l, p+1, HI_CONST );
@@ -420,10 +453,11 @@ void Highlight_Code::Hi_NumberIn( unsigned& l, unsigned& p )
 void Highlight_Code::Hi_NumberHex( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
+  const Line&    lr = m_fb.GetLine( l );
+  const unsigned LL = lr.len();
   if( LL <= p ) m_state = &ME::Hi_In_None;
   else {
-    const char c1 = m_fb.Get( l, p );
+    const uint8_t c1 = lr.get( p );
     if( isxdigit(c1) )
     {
       m_fb.SetSyntaxStyle( l, p, HI_CONST );
@@ -438,11 +472,12 @@ void Highlight_Code::Hi_NumberHex( unsigned& l, unsigned& p )
 void Highlight_Code::Hi_NumberFraction( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
+  const Line&    lr = m_fb.GetLine( l );
+  const unsigned LL = lr.len();
   if( LL <= p ) m_state = &ME::Hi_In_None;
   else {
-    const char c1 = m_fb.Get( l, p );
-    if( isdigit(c1) )
+    const uint8_t c1 = lr.get( p );
+    if( m_class[c1] & BC_DIGIT )
     {
       m_fb.SetSyntaxStyle( l, p, HI_CONST );
       p++;
@@ -454,7 +489,7 @@ void Highlight_Code::Hi_NumberFraction( unsigned& l, unsigned& p )
       p++;
       if( p<LL )
       {
-        const char c0 = m_fb.Get( l, p );
+        const uint8_t c0 = lr.get( p );
         if( '+' == c0 || '-' == c0 ) {
           m_fb.SetSyntaxStyle( l, p, HI_CONST );
           p++;
@@ -470,11 +505,12 @@ void Highlight_Code::Hi_NumberFraction( unsigned& l, unsigned& p )
 void Highlight_Code::Hi_NumberExponent( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  const unsigned LL = m_fb.LineLen( l );
+  const Line&    lr = m_fb.GetLine( l );
+  const unsigned LL = lr.len();
   if( LL <= p ) m_state = &ME::Hi_In_None;
   else {
-    const char c1 = m_fb.Get( l, p );
-    if( isdigit(c1) )
+    const uint8_t c1 = lr.get( p );
+    if( m_class[c1] & BC_DIGIT )
     {
       m_fb.SetSyntaxStyle( l, p, HI_CONST );
       p++;
@@ -488,12 +524,12 @@ void Highlight_Code::Hi_NumberExponent( unsigned& l, unsigned& p )
 void Highlight_Code::Hi_NumberTypeSpec( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-
-  const unsigned LL = m_fb.LineLen( l );
+  const Line&    lr = m_fb.GetLine( l );
+  const unsigned LL = lr.len();
 
   if( p < LL )
   {
-    const char c0 = m_fb.Get( l, p );
+    const uint8_t c0 = lr.get( p );
 
     if( c0=='L' )
     {
@@ -511,11 +547,11 @@ void Highlight_Code::Hi_NumberTypeSpec( unsigned& l, unsigned& p )
     {
       m_fb.SetSyntaxStyle( l, p, HI_VARTYPE ); p++;
       if( p<LL ) {
-        const char c1 = m_fb.Get( l, p );
+        const uint8_t c1 = lr.get( p );
         if( c1=='L' ) { // UL
           m_fb.SetSyntaxStyle( l, p, HI_VARTYPE ); p++;
           if( p<LL ) {
-            const char c2 = m_fb.Get( l, p );
+            const uint8_t c2 = lr.get( p );
             if( c2=='L' ) { // ULL
               m_fb.SetSyntaxStyle( l, p, HI_VARTYPE ); p++;
             }
@@ -526,4 +562,3 @@ void Highlight_Code::Hi_NumberTypeSpec( unsigned& l, unsigned& p )
     }
   }
 }
-
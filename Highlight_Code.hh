@@ -26,24 +26,66 @@
 
 #include "Highlight_Base.hh"
 
+// Syntax of a language, declared as data so that one Highlight_Code
+// engine can highlight all of the languages that fit its rules.
+// The fields after keys are optional, and left out they give C rules.
+struct HiCodeSyntax
+{
+  HiCodeSyntax( const char* line_comment
+              , const char* block_beg
+              , const char* block_end
+              , char        define
+              , const char* quotes
+              , const char* raw_quotes
+              , HiKeyVal*   keys
+              , const char* vars           = 0
+              , bool        vars_in_quotes = false
+              , const char* controls       = 0
+              , char        line_cont      = 0
+              , bool        plain_numbers  = false )
+    : line_comment  ( line_comment   )
+    , block_beg     ( block_beg      )
+    , block_end     ( block_end      )
+    , define        ( define         )
+    , quotes        ( quotes         )
+    , raw_quotes    ( raw_quotes     )
+    , keys          ( keys           )
+    , vars          ( vars           )
+    , vars_in_quotes( vars_in_quotes )
+    , controls      ( controls       )
+    , line_cont     ( line_cont      )
+    , plain_numbers ( plain_numbers  )
+  {}
+  const char* line_comment; // Comment to end of line, like "//" or "#", or 0
+  const char* block_beg;    // Beginning of block comment, like "/*", or 0
+  const char* block_end;    // End of block comment, like "*/"
+  char        define;       // Define to end of line, like '#', or 0
+  const char* quotes;       // Quotes with \ escapes, like "'\""
+  const char* raw_quotes;   // Quotes without escapes, like "`", or 0
+  HiKeyVal*   keys;         // Key words
+  const char* vars;         // Variable chars, like "$", or 0. A line comment
+                            // right after one is not a comment, as in $#
+  bool        vars_in_quotes; // Variable chars are also shown in quotes
+  const char* controls;     // Control chars besides the C ones, like "@", or 0
+  char        line_cont;    // Line continuation char, like '\\', or 0
+  bool        plain_numbers;// Numbers have no L, F or U suffix or ' separator
+};
+
 class Highlight_Code : public Highlight_Base
 {
 public:
-  Highlight_Code( FileBuf& rfb );
+  Highlight_Code( FileBuf& rfb, const HiCodeSyntax& syn );
 
 private:
   void Run_Range( const CrsPos st, const unsigned fn );
 
-  void Hi_In_None( unsigned& l, unsigned& p );
-  void Hi_In_Define( unsigned& l, unsigned& p );
-  void Hi_BegC_Comment( unsigned& l, unsigned& p );
-  void Hi_In_C_Comment( unsigned& l, unsigned& p );
-  void Hi_EndC_Comment( unsigned& l, unsigned& p );
-  void Hi_BegCPP_Comment( unsigned& l, unsigned& p );
+  void Hi_In_None       ( unsigned& l, unsigned& p );
+  void Hi_In_Define     ( unsigned& l, unsigned& p );
+  void Hi_BegC_Comment  ( unsigned& l, unsigned& p );
+  void Hi_In_C_Comment  ( unsigned& l, unsigned& p );
   void Hi_In_CPP_Comment( unsigned& l, unsigned& p );
-  void Hi_EndCPP_Comment( unsigned& l, unsigned& p );
-  void Hi_In_SingleQuote( unsigned& l, unsigned& p );
-  void Hi_In_DoubleQuote( unsigned& l, unsigned& p );
+  void Hi_In_Quote      ( unsigned& l, unsigned& p );
+  void Hi_In_Raw_Quote  ( unsigned& l, unsigned& p );
   void Hi_NumberBeg     ( unsigned& l, unsigned& p );
   void Hi_NumberIn      ( unsigned& l, unsigned& p );
   void Hi_NumberHex     ( unsigned& l, unsigned& p );
@@ -54,10 +96,15 @@ private:
   typedef Highlight_Code ME;
   typedef void (ME::*HiStateFunc) ( unsigned&, unsigned& );
 
-  virtual void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn ) = 0;
-
-  HiStateFunc m_state;
+  const HiCodeSyntax& m_syn;
+  unsigned            m_lc_len;     // Length of m_syn.line_comment
+  unsigned            m_bb_len;     // Length of m_syn.block_beg
+  unsigned            m_be_len;     // Length of m_syn.block_end
+  uint8_t             m_class[256]; // Byte class of each char
+  uint8_t             m_style[256]; // Style of each char on its own
+  uint8_t             m_quote;      // Char ending the current quote
+  HiStateFunc         m_state;
+  unsigned            m_fn;         // Line at which Run_Range() stops
 };
 
 #endif
-
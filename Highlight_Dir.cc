@@ -28,6 +28,7 @@
 Highlight_Dir::Highlight_Dir( FileBuf& rfb )
   : Highlight_Base( rfb )
   , m_state( &ME::Hi_In_None )
+  , m_fn( 0 )
 {
 }
 
@@ -35,6 +36,7 @@ void Highlight_Dir::Run_Range( const CrsPos   st
                              , const unsigned fn )
 {
   m_state = &ME::Hi_In_None;
+  m_fn    = Min( fn, m_fb.NumLines() );
 
   unsigned l=st.crsLine;
   unsigned p=st.crsChar;
@@ -49,7 +51,7 @@ void Highlight_Dir::Hi_In_None( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const Line&    lr = m_fb.GetLine( l );
     const unsigned LL = m_fb.LineLen( l );
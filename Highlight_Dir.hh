@@ -42,6 +42,7 @@ private:
   typedef void (Highlight_Dir::*HiStateFunc) ( unsigned&, unsigned& );
 
   HiStateFunc m_state;
+  unsigned    m_fn; // Line at which Run_Range() stops
 };
 
 #endif
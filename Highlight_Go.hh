@@ -24,41 +24,12 @@
 #ifndef __HIGHLIGHT_GO_HH__
 #define __HIGHLIGHT_GO_HH__
 
-#include "Highlight_Base.hh"
+#include "Highlight_Code.hh"
 
-class Highlight_Go : public Highlight_Base
+class Highlight_Go : public Highlight_Code
 {
 public:
   Highlight_Go( FileBuf& rfb );
-
-private:
-  void Run_Range( const CrsPos st, const unsigned fn );
-
-  void Hi_In_None       ( unsigned& l, unsigned& p );
-  void Hi_In_Define     ( unsigned& l, unsigned& p );
-  void Hi_BegC_Comment  ( unsigned& l, unsigned& p );
-  void Hi_In_C_Comment  ( unsigned& l, unsigned& p );
-  void Hi_EndC_Comment  ( unsigned& l, unsigned& p );
-  void Hi_BegCPP_Comment( unsigned& l, unsigned& p );
-  void Hi_In_CPP_Comment( unsigned& l, unsigned& p );
-  void Hi_EndCPP_Comment( unsigned& l, unsigned& p );
-  void Hi_In_SingleQuote( unsigned& l, unsigned& p );
-  void Hi_In_DoubleQuote( unsigned& l, unsigned& p );
-  void Hi_In_Back__Quote( unsigned& l, unsigned& p );
-  void Hi_NumberBeg     ( unsigned& l, unsigned& p );
-  void Hi_NumberIn      ( unsigned& l, unsigned& p );
-  void Hi_NumberHex     ( unsigned& l, unsigned& p );
-  void Hi_NumberFraction( unsigned& l, unsigned& p );
-  void Hi_NumberExponent( unsigned& l, unsigned& p );
-  void Hi_NumberTypeSpec( unsigned& l, unsigned& p );
-
-  typedef Highlight_Go ME;
-  typedef void (ME::*HiStateFunc) ( unsigned&, unsigned& );
-
-  virtual void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn );
-
-  HiStateFunc m_state;
 };
 
 #endif
-
@@ -115,6 +115,7 @@ const char* Highlight_HTML::m_HTML_Tags[] =
 Highlight_HTML::Highlight_HTML( FileBuf& rfb )
   : Highlight_Base( rfb )
   , m_state( St_In_None )
+  , m_fn( 0 )
   , m_qtXSt( St_In_None )
   , m_ccXSt( St_JS_None )
   , m_numXSt( St_In_None )
@@ -130,6 +131,7 @@ Highlight_HTML::Highlight_HTML( FileBuf& rfb )
 void Highlight_HTML::Run_Range( const CrsPos st, const unsigned fn )
 {
   m_state = Run_Range_Get_Initial_State( st );
+  m_fn    = Min( fn, m_fb.NumLines() );
 
   m_l = st.crsLine;
   m_p = st.crsChar;
@@ -146,7 +148,14 @@ void Highlight_HTML::Run_Range( const CrsPos st, const unsigned fn )
     {
       CrsPos st = { st_l, st_p };
 
-      Find_Styles_Keys_In_Range( st, m_l+1 );
+      // A JS state can stop on line m_fn, which is past the range, and
+      // can be a long line FileBuf left out of highlighting:
+      unsigned fn_l = Min( m_l+1, m_fn );
+
+      if( st_l < fn_l
+       && m_fb.Get_Hi_Max_Line_Len() < m_fb.LineLen( fn_l-1 ) ) fn_l--;
+
+      Find_Styles_Keys_In_Range( st, fn_l );
     }
   }
 }
@@ -276,7 +285,7 @@ void Highlight_HTML::Hi_In_None()
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const unsigned LL = m_fb.LineLen( m_l );
     const Line&    lr = m_fb.GetLine( m_l );
@@ -340,7 +349,7 @@ void Highlight_HTML::Hi_XML_Comment()
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const unsigned LL = m_fb.LineLen( m_l );
     for( ; m_p<LL; m_p++ )
@@ -370,7 +379,7 @@ void Highlight_HTML::Hi_CloseTag()
 
   bool found_elem_name = false;
 
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const Line* lp = m_fb.GetLineP( m_l );
     const unsigned LL = m_fb.LineLen( m_l );
@@ -611,7 +620,7 @@ void Highlight_HTML::Hi_OpenTag_ElemName()
   m_OpenTag_was_style  = false;
   bool found_elem_name = false;
 
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const Line* lp = m_fb.GetLineP( m_l );
     const unsigned LL = m_fb.LineLen( m_l );
@@ -692,7 +701,7 @@ void Highlight_HTML::Hi_OpenTag_AttrName()
   bool found_attr_name = false;
   bool past__attr_name = false;
 
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const unsigned LL = m_fb.LineLen( m_l );
 
@@ -774,7 +783,7 @@ void Highlight_HTML::Hi_OpenTag_AttrName()
 
 void Highlight_HTML::Hi_OpenTag_AttrVal()
 {
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const unsigned LL = m_fb.LineLen( m_l );
 
@@ -831,7 +840,7 @@ void Highlight_HTML::Hi_OpenTag_AttrVal()
 void Highlight_HTML::Hi_SingleQuote()
 {
   bool exit = false;
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const unsigned LL = m_fb.LineLen( m_l );
 
@@ -867,7 +876,7 @@ void Highlight_HTML::Hi_SingleQuote()
 void Highlight_HTML::Hi_DoubleQuote()
 {
   bool exit = false;
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const unsigned LL = m_fb.LineLen( m_l );
 
@@ -934,7 +943,7 @@ bool JS_TwoControl( const char c1, const char c0 )
 
 void Highlight_HTML::Hi_JS_None()
 {
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const Line* lp = m_fb.GetLineP( m_l );
     const unsigned LL = m_fb.LineLen( m_l );
@@ -1057,7 +1066,7 @@ void Highlight_HTML::Hi_JS_Define()
 void Highlight_HTML::Hi_C_Comment()
 {
   bool exit = false;
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const unsigned LL = m_fb.LineLen( m_l );
 
@@ -1107,7 +1116,7 @@ bool CS_OneControl( const char c0 )
 
 void Highlight_HTML::Hi_CS_None()
 {
-  for( ; m_l<m_fb.NumLines(); m_l++ )
+  for( ; m_l<m_fn; m_l++ )
   {
     const Line* lp = m_fb.GetLineP( m_l );
     const unsigned LL = m_fb.LineLen( m_l );
@@ -109,6 +109,7 @@ private:
   const char* State_2_str( const Hi_State state );
 
   Hi_State m_state; // Current state
+  unsigned m_fn;    // Line at which Run_Range() stops
   Hi_State m_qtXSt; // Quote exit state
   Hi_State m_ccXSt; // C comment exit state
   Hi_State m_numXSt; // Number exit state
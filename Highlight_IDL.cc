@@ -94,17 +94,9 @@ static HiKeyVal HiPairs[] =
   { 0 }
 };
 
-Highlight_IDL::Highlight_IDL( FileBuf& rfb )
-  : Highlight_Code( rfb )
-{
-}
+static HiCodeSyntax Syntax( "//", "/*", "*/", '#', "\'\"", 0, HiPairs );
 
-void Highlight_IDL::
-     Find_Styles_Keys_In_Range( const CrsPos   st
-                              , const unsigned fn )
+Highlight_IDL::Highlight_IDL( FileBuf& rfb )
+  : Highlight_Code( rfb, Syntax )
 {
-  Trace trace( __PRETTY_FUNCTION__ );
-
-  Hi_FindKey_In_Range( HiPairs, st, fn );
 }
-
@@ -105,15 +105,9 @@ static HiKeyVal HiPairs[] =
   { 0 }
 };
 
-Highlight_JS::Highlight_JS( FileBuf& rfb )
-  : Highlight_Code( rfb )
-{
-}
+static HiCodeSyntax Syntax( "//", "/*", "*/", '#', "\'\"", 0, HiPairs );
 
-void Highlight_JS::
-     Find_Styles_Keys_In_Range( const CrsPos   st
-                              , const unsigned fn )
+Highlight_JS::Highlight_JS( FileBuf& rfb )
+  : Highlight_Code( rfb, Syntax )
 {
-  Hi_FindKey_In_Range( HiPairs, st, fn );
 }
-
@@ -30,9 +30,6 @@ class Highlight_JS : public Highlight_Code
 {
 public:
   Highlight_JS( FileBuf& rfb );
-
-private:
-  void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn );
 };
 
 #endif
@@ -99,15 +99,9 @@ static HiKeyVal HiPairs[] =
   { 0 }
 };
 
-Highlight_Java::Highlight_Java( FileBuf& rfb )
-  : Highlight_Code( rfb )
-{
-}
+static HiCodeSyntax Syntax( "//", "/*", "*/", '#', "\'\"", 0, HiPairs );
 
-void Highlight_Java::
-     Find_Styles_Keys_In_Range( const CrsPos   st
-                              , const unsigned fn )
+Highlight_Java::Highlight_Java( FileBuf& rfb )
+  : Highlight_Code( rfb, Syntax )
 {
-  Hi_FindKey_In_Range( HiPairs, st, fn );
 }
-
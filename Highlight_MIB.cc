@@ -35,6 +35,7 @@ extern MemLog<MEM_LOG_BUF_SIZE> Log;
 Highlight_MIB::Highlight_MIB( FileBuf& rfb )
   : Highlight_Base( rfb )
   , m_state( &ME::Hi_In_None )
+  , m_fn( 0 )
 {
 }
 
@@ -43,6 +44,7 @@ void Highlight_MIB::Run_Range( const CrsPos st, const unsigned fn )
   Trace trace( __PRETTY_FUNCTION__ );
 
   m_state = &ME::Hi_In_None;
+  m_fn    = Min( fn, m_fb.NumLines() );
 
   unsigned l=st.crsLine;
   unsigned p=st.crsChar;
@@ -74,7 +76,7 @@ static bool OneControl( const char c0 )
 void Highlight_MIB::Hi_In_None( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
     const Line&    lr = m_fb.GetLine( l );
@@ -140,7 +142,7 @@ void Highlight_MIB::Hi_SingleQuote( unsigned& l, unsigned& p )
 
   m_fb.SetSyntaxStyle( l, p, HI_CONST );
   p++;
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -178,7 +180,7 @@ void Highlight_MIB::Hi_DoubleQuote( unsigned& l, unsigned& p )
 
   m_fb.SetSyntaxStyle( l, p, HI_CONST );
   p++;
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -216,7 +218,7 @@ void Highlight_MIB::Hi_96_Quote( unsigned& l, unsigned& p )
 
   m_fb.SetSyntaxStyle( l, p, HI_CONST );
   p++;
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -51,6 +51,7 @@ private:
   virtual void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn );
 
   HiStateFunc m_state;
+  unsigned    m_fn; // Line at which Run_Range() stops
 };
 
 #endif
@@ -63,12 +63,14 @@ static HiKeyVal HiPairs[] =
 Highlight_ODB::Highlight_ODB( FileBuf& rfb )
   : Highlight_Base( rfb )
   , m_state( &ME::Hi_In_None )
+  , m_fn( 0 )
 {
 }
 
 void Highlight_ODB::Run_Range( const CrsPos st, const unsigned fn )
 {
   m_state = &ME::Hi_In_None;
+  m_fn    = Min( fn, m_fb.NumLines() );
   unsigned l=st.crsLine;
   unsigned p=st.crsChar;
 
@@ -82,7 +84,7 @@ void Highlight_ODB::Run_Range( const CrsPos st, const unsigned fn )
 void Highlight_ODB::Hi_In_None( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -50,6 +50,7 @@ private:
   void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn );
 
   HiStateFunc m_state;
+  unsigned    m_fn; // Line at which Run_Range() stops
 };
 
 #endif
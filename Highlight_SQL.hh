@@ -24,39 +24,12 @@
 #ifndef __HIGHLIGHT_SQL_HH__
 #define __HIGHLIGHT_SQL_HH__
 
-#include "Highlight_Base.hh"
+#include "Highlight_Code.hh"
 
-class Highlight_SQL : public Highlight_Base
+class Highlight_SQL : public Highlight_Code
 {
 public:
   Highlight_SQL( FileBuf& rfb );
-
-private:
-  void Run_Range( const CrsPos st, const unsigned fn );
-
-  void Hi_In_None( unsigned& l, unsigned& p );
-  void Hi_Beg_Comment( unsigned& l, unsigned& p );
-  void Hi_In__Comment( unsigned& l, unsigned& p );
-  void Hi_End_Comment( unsigned& l, unsigned& p );
-  void Hi_BegSingleQuote( unsigned& l, unsigned& p );
-  void Hi_In_SingleQuote( unsigned& l, unsigned& p );
-  void Hi_EndSingleQuote( unsigned& l, unsigned& p );
-  void Hi_BegDoubleQuote( unsigned& l, unsigned& p );
-  void Hi_In_DoubleQuote( unsigned& l, unsigned& p );
-  void Hi_EndDoubleQuote( unsigned& l, unsigned& p );
-  void Hi_NumberBeg     ( unsigned& l, unsigned& p );
-  void Hi_NumberIn      ( unsigned& l, unsigned& p );
-  void Hi_NumberHex     ( unsigned& l, unsigned& p );
-  void Hi_NumberFraction( unsigned& l, unsigned& p );
-  void Hi_NumberExponent( unsigned& l, unsigned& p );
-
-  typedef Highlight_SQL ME;
-  typedef void (ME::*HiStateFunc) ( unsigned&, unsigned& );
-
-  void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn );
-
-  HiStateFunc m_state;
 };
 
 #endif
-
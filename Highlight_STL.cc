@@ -58,15 +58,9 @@ static HiKeyVal HiPairs[] =
   { 0 }
 };
 
-Highlight_STL::Highlight_STL( FileBuf& rfb )
-  : Highlight_Code( rfb )
-{
-}
+static HiCodeSyntax Syntax( "//", "/*", "*/", '#', "\'\"", 0, HiPairs );
 
-void Highlight_STL::
-     Find_Styles_Keys_In_Range( const CrsPos   st
-                              , const unsigned fn )
+Highlight_STL::Highlight_STL( FileBuf& rfb )
+  : Highlight_Code( rfb, Syntax )
 {
-  Hi_FindKey_In_Range( HiPairs, st, fn );
 }
-
@@ -123,15 +123,9 @@ static HiKeyVal HiPairs[] =
   { 0 }
 };
 
-Highlight_TCL::Highlight_TCL( FileBuf& rfb )
-  : Highlight_Code( rfb )
-{
-}
+static HiCodeSyntax Syntax( "//", "/*", "*/", '#', "\'\"", 0, HiPairs );
 
-void Highlight_TCL::
-     Find_Styles_Keys_In_Range( const CrsPos   st
-                              , const unsigned fn )
+Highlight_TCL::Highlight_TCL( FileBuf& rfb )
+  : Highlight_Code( rfb, Syntax )
 {
-  Hi_FindKey_In_Range( HiPairs, st, fn );
 }
-
@@ -30,9 +30,6 @@ class Highlight_TCL : public Highlight_Code
 {
 public:
   Highlight_TCL( FileBuf& rfb );
-
-private:
-  void Find_Styles_Keys_In_Range( const CrsPos st, const unsigned fn );
 };
 
 #endif
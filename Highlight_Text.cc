@@ -28,6 +28,7 @@
 Highlight_Text::Highlight_Text( FileBuf& rfb )
   : Highlight_Base( rfb )
   , m_state( &ME::Hi_In_None )
+  , m_fn( 0 )
 {
 }
 
@@ -35,6 +36,7 @@ void Highlight_Text::Run_Range( const CrsPos   st
                               , const unsigned fn )
 {
   m_state = &ME::Hi_In_None;
+  m_fn    = Min( fn, m_fb.NumLines() );
 
   unsigned l=st.crsLine;
   unsigned p=st.crsChar;
@@ -48,7 +50,7 @@ void Highlight_Text::Run_Range( const CrsPos   st
 void Highlight_Text::Hi_In_None( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
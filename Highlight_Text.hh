@@ -41,6 +41,7 @@ private:
   typedef void (Highlight_Text::*HiStateFunc) ( unsigned&, unsigned& );
 
   HiStateFunc m_state;
+  unsigned    m_fn; // Line at which Run_Range() stops
 };
 
 #endif
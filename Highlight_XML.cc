@@ -39,6 +39,7 @@ static HiKeyVal HiPairs[] =
 Highlight_XML::Highlight_XML( FileBuf& rfb )
   : Highlight_Base( rfb )
   , m_state( &ME::Hi_In_None )
+  , m_fn( 0 )
   , m_qtXSt( &ME::Hi_In_None )
 {
 }
@@ -46,6 +47,7 @@ Highlight_XML::Highlight_XML( FileBuf& rfb )
 void Highlight_XML::Run_Range( const CrsPos st, const unsigned fn )
 {
   m_state = &ME::Hi_In_None;
+  m_fn    = Min( fn, m_fb.NumLines() );
 
   unsigned l=st.crsLine;
   unsigned p=st.crsChar;
@@ -60,7 +62,7 @@ void Highlight_XML::Run_Range( const CrsPos st, const unsigned fn )
 void Highlight_XML::Hi_In_None( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -130,7 +132,7 @@ void Highlight_XML::Hi_OpenTag_ElemName( unsigned& l, unsigned& p )
 
   bool found_elem_name = false;
 
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const int LL = m_fb.LineLen( l );
 
@@ -193,7 +195,7 @@ void Highlight_XML::Hi_OpenTag_AttrName( unsigned& l, unsigned& p )
   bool found_attr_name = false;
   bool past__attr_name = false;
 
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const int LL = m_fb.LineLen( l );
 
@@ -276,7 +278,7 @@ void Highlight_XML::Hi_OpenTag_AttrName( unsigned& l, unsigned& p )
 
 void Highlight_XML::Hi_OpenTag_AttrVal( unsigned& l, unsigned& p )
 {
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const int LL = m_fb.LineLen( l );
 
@@ -324,7 +326,7 @@ void Highlight_XML::Hi_OpenTag_AttrVal( unsigned& l, unsigned& p )
 
 void Highlight_XML::Hi_CloseTag( unsigned& l, unsigned& p )
 {
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const int LL = m_fb.LineLen( l );
 
@@ -363,7 +365,7 @@ void Highlight_XML::Hi_CloseTag( unsigned& l, unsigned& p )
 void Highlight_XML::Hi_Comment( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -393,7 +395,7 @@ void Highlight_XML::Hi_Comment( unsigned& l, unsigned& p )
 void Highlight_XML::Hi_In_SingleQuote( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -428,7 +430,7 @@ void Highlight_XML::Hi_In_SingleQuote( unsigned& l, unsigned& p )
 void Highlight_XML::Hi_In_DoubleQuote( unsigned& l, unsigned& p )
 {
   Trace trace( __PRETTY_FUNCTION__ );
-  for( ; l<m_fb.NumLines(); l++ )
+  for( ; l<m_fn; l++ )
   {
     const unsigned LL = m_fb.LineLen( l );
 
@@ -42,6 +42,7 @@ Key::Key()
   , dot_buf_index_n( 0 )
   , dot_buf_index_l( 0 )
   , map_buf_index( 0 )
+  , in_from_console( false )
 {
 }
 
@@ -51,6 +52,10 @@ char Key::In()
 
   char C = 0;
 
+  in_from_console = !get_from_map_buf
+                 && !get_from_dot_buf_n
+                 && !get_from_dot_buf_l;
+
   if     ( get_from_map_buf   ) C = In_MapBuf();
   else if( get_from_dot_buf_n ) C = In_DotBuf_n();
   else if( get_from_dot_buf_l ) C = In_DotBuf_l();
@@ -64,6 +69,31 @@ char Key::In()
   return C;
 }
 
+// If C, just returned by In(), was pasted, put C and the rest of
+// the paste into text, saving it the same as typed keys.
+bool Key::Get_Paste( const char C, Line& text )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  if( !in_from_console || !Console::In_Paste() ) return false;
+
+  text.clear();
+  text.push( C );
+
+  Console::Get_Paste( text );
+
+  for( unsigned k=1; k<text.len(); k++ )
+  {
+    const uint8_t P = text.get( k );
+
+    if( save_2_map_buf   ) map_buf.push( P );
+    if( save_2_dot_buf_n ) dot_buf_n.push( P );
+    if( save_2_dot_buf_l ) dot_buf_l.push( P );
+    if( save_2_vis_buf   ) vis_buf.push( P );
+  }
+  return true;
+}
+
 char Key::In_DotBuf_n()
 {
   Trace trace( __PRETTY_FUNCTION__ );
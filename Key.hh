@@ -32,6 +32,7 @@ public:
   Key();
 
   char In();
+  bool Get_Paste( const char C, Line& text );
 
   bool save_2_dot_buf_n; // Normal view
   bool save_2_dot_buf_l; // Line view
@@ -53,6 +54,7 @@ private:
   unsigned dot_buf_index_n; // Normal view
   unsigned dot_buf_index_l; // Line view
   unsigned map_buf_index;
+  bool     in_from_console; // Last key from In() came from Console
 };
 
 #endif
@@ -1,13 +1,10 @@
+#include <string.h>    // memcmp
 
 #include "Utilities.hh"
+#include "Hash.hh"
 #include "String.hh"
 #include "Line.hh"
 
-const unsigned m_primes[] = {  43, 101, 149, 193, 241, 293, 353, 409, 461
-                            , 521, 587, 641, 691, 757, 823, 881, 947 };
-
-const unsigned m_num_primes = sizeof( m_primes )/sizeof( unsigned );
-
 struct Line::Data
 {
   Data();
@@ -16,8 +13,8 @@ struct Line::Data
 
   String s;
 
-  bool     chksum_valid;
-  unsigned chksum;
+  bool               chksum_valid;
+  unsigned long long chksum;
 };
 
 Line::Data::Data()
@@ -45,55 +42,27 @@ Line::Data::Data( const unsigned len
   for( unsigned k=0; k<len; k++ ) s.push( fill );
 }
 
-int skip_white_beg( Line::Data& m, int start )
+// Returns the first char and length of m.s without
+// leading and trailing white space
+const char* trim( const Line::Data& m, unsigned& len )
 {
-  const unsigned LEN = m.s.len();
+  const char* s = m.s.c_str();
+  unsigned st = 0;
+  unsigned fn = m.s.len();
 
-  if( 0<LEN )
-  {
-    for( uint8_t C = m.s.get( start )
-       ; start<LEN && (' '==C || '\t'==C || '\r'==C); )
-    {
-      start++;
-      if( start<LEN ) C = m.s.get( start );
-    }
-  }
-  return start;
-}
+  while( st<fn && (' '==s[st]  || '\t'==s[st]  || '\r'==s[st]  ) ) st++;
+  while( st<fn && (' '==s[fn-1]|| '\t'==s[fn-1]|| '\r'==s[fn-1]) ) fn--;
 
-int skip_white_end( Line::Data& m
-                  , const int start
-                  ,       int finish )
-{
-  if( -1<finish )
-  {
-    for( uint8_t C = m.s.get( finish )
-       ; start<=finish && (' '==C || '\t'==C || '\r'==C); )
-    {
-      finish--;
-      if( start<=finish ) C = m.s.get( finish );
-    }
-  }
-  return finish;
+  len = fn - st;
+  return s + st;
 }
 
-int calc_chksum( Line::Data& m )
+unsigned long long calc_chksum( Line::Data& m )
 {
-  unsigned chk_sum = 0;
-
-  int start = 0;
-  int finish = 0<m.s.len() ? m.s.len()-1 : -1;
+  unsigned len = 0;
+  const char* s = trim( m, len );
 
-  start  = skip_white_beg( m, start );
-  finish = skip_white_end( m, start, finish );
-
-  for( int i=start; i<=finish; i++ )
-  {
-    chk_sum ^= m_primes[(i-start)%m_num_primes] ^ m.s.get( i );
-    chk_sum = ((chk_sum << 13)&0xFFFFE000)
-            | ((chk_sum >> 19)&0x00001FFF);
-  }
-  return chk_sum;
+  return Hash_64( s, len );
 }
 
 Line::Line()
@@ -253,6 +222,13 @@ bool Line::append( const Line& a )
   return true;
 }
 
+bool Line::append( const char* cp, const unsigned len )
+{
+  m.chksum_valid = false;
+
+  return m.s.append( cp, len );
+}
+
 // Return -1 if this is less    than a,
 // Return  1 if this is greater than a,
 // Return  0 if this is equal   to   a
@@ -286,6 +262,25 @@ bool Line::eq( const Line& a ) const
   return m.s.eq( a.m.s );
 }
 
+// Returns true if this is equal to a, ignoring
+// leading and trailing white space
+bool Line::eq_trim( const Line& a ) const
+{
+  unsigned len   = 0;
+  unsigned len_a = 0;
+  const char* s   = c_str_trim( len );
+  const char* s_a = a.c_str_trim( len_a );
+
+  return len == len_a && 0 == memcmp( s, s_a, len );
+}
+
+// Returns the line without leading and trailing white space.
+// Not NULL terminated, so len is the number of chars.
+const char* Line::c_str_trim( unsigned& len ) const
+{
+  return trim( m, len );
+}
+
 bool Line::ends_with( const uint8_t C )
 {
   if( 0 < m.s.len() )
@@ -295,7 +290,9 @@ bool Line::ends_with( const uint8_t C )
   return false;
 }
 
-unsigned Line::chksum() const
+// Hash of the line without leading and trailing white space.
+// Lines with equal chksum()'s should be compared with eq_trim().
+unsigned long long Line::chksum() const
 {
   if( !m.chksum_valid )
   {
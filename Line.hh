@@ -56,6 +56,7 @@ public:
   void    set( const unsigned p, const uint8_t C );
 
   const char* c_str( unsigned p ) const;
+  const char* c_str_trim( unsigned& len ) const;
   const String& toString() const;
 
   bool insert( const unsigned p, const uint8_t C );
@@ -69,15 +70,17 @@ public:
   bool pop();
 
   bool append( const Line& a );
+  bool append( const char* cp, const unsigned len );
 
   int  compareTo( const Line& a ) const;
   bool gt( const Line& a ) const;
   bool lt( const Line& a ) const;
   bool eq( const Line& a ) const;
+  bool eq_trim( const Line& a ) const;
 
   bool ends_with( const uint8_t C );
 
-  unsigned chksum() const;
+  unsigned long long chksum() const;
 
   struct Data;
 
@@ -2647,7 +2647,7 @@ void LineView::Update()
   Trace trace( __PRETTY_FUNCTION__ );
 
   m.fb.Find_Styles( m.topLine + WORKING_ROWS );
-  m.fb.Find_Regexs( m.topLine, WORKING_ROWS );
+  m.fb.Find_Regexs( m.topLine, WORKING_ROWS, m.leftChar, WorkingCols() );
 
   RepositionView();
   DisplayBanner( m );
@@ -0,0 +1,200 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#include <stdio.h>     // sprintf
+#include <string.h>    // memset
+
+#include "String.hh"
+#include "Utilities.hh"
+#include "Perf.hh"
+
+// Values below SUB_COUNT get their own bucket. Above that, each power
+// of two is split into SUB_COUNT buckets, so a bucket is at most 1/8
+// wider than the values in it, like a HDR histogram:
+static const unsigned SUB_BITS    = 3;
+static const unsigned SUB_COUNT   = 1 << SUB_BITS;
+static const unsigned NUM_BUCKETS = (32 - SUB_BITS + 1) * SUB_COUNT;
+
+struct Histogram
+{
+  unsigned counts[ NUM_BUCKETS ];
+  unsigned total;
+  unsigned max;
+  unsigned last;
+};
+
+static Histogram m_hist[ PERF_NUM_STAGES ];
+
+static const char* m_names[ PERF_NUM_STAGES ] =
+{
+  "Key to paint",
+  "Handle key",
+  "Find styles",
+  "Find regexs",
+  "Print view",
+  "Console update",
+  "Console flush",
+  "Diff",
+  "Bytes per frame",
+};
+
+// Earliest key not yet painted, and last key not yet handled:
+static double m_key_time    = 0;
+static double m_handle_time = 0;
+
+static unsigned Bucket( const unsigned v )
+{
+  if( v < SUB_COUNT ) return v;
+
+  unsigned e = SUB_BITS;
+  while( v >> (e+1) ) e++;
+
+  return (e - SUB_BITS + 1)*SUB_COUNT + ((v >> (e - SUB_BITS)) & (SUB_COUNT-1));
+}
+
+// Largest value in bucket b
+static unsigned Bucket_Max( const unsigned b )
+{
+  if( b < SUB_COUNT ) return b;
+
+  const unsigned e   = b/SUB_COUNT + SUB_BITS - 1;
+  const unsigned sub = b%SUB_COUNT;
+
+  return ((unsigned long long)(SUB_COUNT + sub + 1) << (e - SUB_BITS)) - 1;
+}
+
+static unsigned Percentile( const Histogram& h, const unsigned pct )
+{
+  const unsigned long long RANK = ((unsigned long long)h.total*pct + 99)/100;
+
+  unsigned long long count = 0;
+
+  for( unsigned b=0; b<NUM_BUCKETS; b++ )
+  {
+    count += h.counts[b];
+
+    if( RANK <= count ) return Min( Bucket_Max( b ), h.max );
+  }
+  return h.max;
+}
+
+void Perf::Add( const Perf_Stage s, const unsigned value )
+{
+  Histogram& h = m_hist[s];
+
+  h.counts[ Bucket( value ) ]++;
+  h.total++;
+  h.last = value;
+  if( h.max < value ) h.max = value;
+}
+
+void Perf::Add_Secs( const Perf_Stage s, const double secs )
+{
+  Add( s, 0 < secs ? unsigned( secs*1e6 + 0.5 ) : 0 );
+}
+
+// Called when a key is read from the console
+void Perf::Key_Arrived()
+{
+  const double now = GetTimeSeconds();
+
+  if( 0 == m_key_time ) m_key_time = now;
+
+  m_handle_time = now;
+}
+
+// Called when the next key is requested
+void Perf::Key_Done()
+{
+  if( 0 != m_handle_time )
+  {
+    Add_Secs( PERF_HANDLE_KEY, GetTimeSeconds() - m_handle_time );
+
+    m_handle_time = 0;
+  }
+}
+
+// Called before waiting for input. A key that did not cause
+// any output, like the first d of dd, is not counted:
+void Perf::Idle()
+{
+  m_key_time = 0;
+}
+
+// Called when output is written to the terminal
+void Perf::Painted( const unsigned bytes )
+{
+  Add( PERF_FRAME_BYTES, bytes );
+
+  if( 0 != m_key_time )
+  {
+    Add_Secs( PERF_KEY_2_PAINT, GetTimeSeconds() - m_key_time );
+
+    m_key_time = 0;
+  }
+}
+
+void Perf::Report( String& rpt )
+{
+  char buf[128];
+
+  sprintf( buf, "%-16s %8s %10s %10s %10s %10s\n"
+              , "Stage (ms)", "count", "p50", "p99", "max", "last" );
+  rpt += buf;
+
+  for( unsigned s=0; s<PERF_NUM_STAGES; s++ )
+  {
+    const Histogram& h = m_hist[s];
+
+    if( PERF_FRAME_BYTES == s )
+    {
+      sprintf( buf, "%-16s %8u %10u %10u %10u %10u\n"
+                  , m_names[s], h.total
+                  , Percentile( h, 50 ), Percentile( h, 99 ), h.max, h.last );
+    }
+    else {
+      sprintf( buf, "%-16s %8u %10.3f %10.3f %10.3f %10.3f\n"
+                  , m_names[s], h.total
+                  , Percentile( h, 50 )/1e3, Percentile( h, 99 )/1e3
+                  , h.max/1e3, h.last/1e3 );
+    }
+    rpt += buf;
+  }
+}
+
+void Perf::Clear()
+{
+  memset( m_hist, 0, sizeof(m_hist) );
+}
+
+Perf_Timer::Perf_Timer( const Perf_Stage s )
+  : m_stage( s )
+  , m_start( GetTimeSeconds() )
+{
+}
+
+Perf_Timer::~Perf_Timer()
+{
+  Perf::Add_Secs( m_stage, GetTimeSeconds() - m_start );
+}
+
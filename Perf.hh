@@ -0,0 +1,73 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __PERF_HH__
+#define __PERF_HH__
+
+enum Perf_Stage
+{
+  PERF_KEY_2_PAINT,  // Key arrival until its output is written
+  PERF_HANDLE_KEY,   // Key arrival until the next key is requested
+  PERF_FIND_STYLES,
+  PERF_FIND_REGEXS,
+  PERF_PRINT_VIEW,
+  PERF_CON_UPDATE,
+  PERF_CON_FLUSH,
+  PERF_DIFF,
+  PERF_FRAME_BYTES,  // Bytes written per flush, not a time
+  PERF_NUM_STAGES
+};
+
+class String;
+
+// Histograms of the time, in micro-seconds, spent in each stage
+// of getting a key to the screen.
+class Perf
+{
+public:
+  static void Add( const Perf_Stage s, const unsigned value );
+  static void Add_Secs( const Perf_Stage s, const double secs );
+
+  static void Key_Arrived();
+  static void Key_Done();
+  static void Idle();
+  static void Painted( const unsigned bytes );
+
+  static void Report( String& rpt );
+  static void Clear();
+};
+
+// Adds the time from construction to destruction to a stage
+class Perf_Timer
+{
+public:
+  Perf_Timer( const Perf_Stage s );
+  ~Perf_Timer();
+
+private:
+  const Perf_Stage m_stage;
+  const double     m_start;
+};
+
+#endif
+
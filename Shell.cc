@@ -38,8 +38,61 @@
 #include "Shell.hh"
 
 extern MemLog<MEM_LOG_BUF_SIZE> Log;
+extern const char* JOB_BUF_NAME;
 
-static const size_t BUF_SIZE = 1024;
+static const size_t BUF_SIZE = 64*1024;
+
+// Shell output is drawn at most once per frame:
+static const double FRAME_TIME = 0.016; // seconds
+
+// Job buffers keep at most this many lines by default,
+// so commands that never end, like tail -f, can run forever:
+static const unsigned JOB_MAX_LINES = 1000000;
+
+// Where output is in an escape sequence, at the end of a read:
+enum Esc_State
+{
+  ESC_NONE,  // Not in an escape sequence
+  ESC_START, // After ESC
+  ESC_CSI    // After ESC [
+};
+
+// A shell command, with its output going into its own buffer
+struct Job
+{
+  Job();
+
+  String   cmd;
+  FileBuf* pfb;
+  View*    view;
+  int      fd;
+  bool     fd_blocking;
+  pid_t    child_pid;
+  bool     running;      // true if command has not exited
+  bool     draw_pending; // true if output has not been drawn
+  double   drawn_time;   // time output was last drawn
+  double   start_time;
+  double   end_time;
+  int      exit_val;
+  Esc_State esc_state;
+};
+
+Job::Job()
+  : cmd()
+  , pfb( 0 )
+  , view( 0 )
+  , fd( 0 )
+  , fd_blocking( true )
+  , child_pid( 0 )
+  , running( false )
+  , draw_pending( false )
+  , drawn_time( 0 )
+  , start_time( 0 )
+  , end_time( 0 )
+  , exit_val( 0 )
+  , esc_state( ESC_NONE )
+{
+}
 
 struct Shell::Data
 {
@@ -50,16 +103,14 @@ struct Shell::Data
 
   Shell&   self;
   Vis&     vis;
-  View*    view;
-  FileBuf* pfb;
+  View*    view;     // Shell buffer view command was run from
+  FileBuf* pfb;      // Shell buffer
   String   cmd;
   String   cmd_copy;
   String   cmd_part;
-  int      fd;
-  bool     fd_blocking;
-  pid_t    child_pid;
-  bool     running;  // true if running a shell command
+  Job      jobs[MAX_JOBS];
   char     buffer[BUF_SIZE];
+  Line     chunk;
 
   const Line divider;
 };
@@ -72,10 +123,7 @@ Shell::Data::Data( Shell& parent
   , pfb( 0 )
   , cmd()
   , cmd_copy()
-  , fd( 0 )
-  , fd_blocking( true )
-  , child_pid( 0 )
-  , running( false )
+  , chunk()
   , divider( 40, '#')
 {
 }
@@ -112,9 +160,9 @@ bool Blocking_Cmd( Shell::Data& m )
   return blocking_cmd;
 }
 
-// On success, returns non-zero file descriptor and fills in child_pid.
+// On success, returns non-zero file descriptor and fills in job.child_pid.
 // On failure, returns zero.
-int Pipe_Fork_Exec( Shell::Data& m )
+int Pipe_Fork_Exec( Shell::Data& m, Job& job )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
@@ -123,9 +171,11 @@ int Pipe_Fork_Exec( Shell::Data& m )
 
   if( pipe( pfd ) < 0 ) ; // pipe() error, drop out
   else {
+    job.fd_blocking = true;
+
     if( !Blocking_Cmd( m ) )
     {
-      m.fd_blocking = 0 == fcntl( pfd[0], F_SETFL, O_NONBLOCK )
+      job.fd_blocking = 0 == fcntl( pfd[0], F_SETFL, O_NONBLOCK )
                     ? false : true;
     }
     const pid_t pid = fork();
@@ -134,7 +184,7 @@ int Pipe_Fork_Exec( Shell::Data& m )
     {
       close( pfd[1] ); // Close parent write end of pipe
       fd = pfd[0];
-      m.child_pid = pid;
+      job.child_pid = pid;
     }
     else //( 0 == pid ) // Child
     {
@@ -152,7 +202,7 @@ int Pipe_Fork_Exec( Shell::Data& m )
         // and stderr, which are tied to write end of pipe.
         close( pfd[1] );
       }
-      ExecShell( m.cmd.c_str() );
+      ExecShell( job.cmd.c_str() );
       // If we get here, execl() failed, so make child return with 127
       _exit( 127 );
     }
@@ -236,124 +286,242 @@ bool Get_Shell_Cmd( Shell::Data& m )
   return got_command;
 }
 
-void Print_Divider_Move_Cursor_2_Bottom( Shell::Data& m )
+void Print_Divider_Move_Cursor_2_Bottom( Shell::Data& m, Job& job )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  // Add ###################################### followed by empty line
-  m.pfb->PushLine( m.divider );
-  m.pfb->PushLine();
+  // Add ######################################
+  job.pfb->PushLine( m.divider );
 
   // Move cursor to bottom of file
-  const unsigned NUM_LINES = m.pfb->NumLines();
-  m.view->GoToCrsPos_NoWrite( NUM_LINES-1, 0 );
-  m.pfb->Update();
+  const unsigned NUM_LINES = job.pfb->NumLines();
+  job.view->GoToCrsPos_NoWrite( NUM_LINES-1, 0 );
+  job.pfb->Update();
+}
+
+// Returns the first job not running, or 0 if all are running
+Job* Free_Job( Shell::Data& m )
+{
+  for( unsigned k=0; k<MAX_JOBS; k++ )
+  {
+    if( !m.jobs[k].running ) return &m.jobs[k];
+  }
+  return 0;
 }
 
-// Returns true of ran command, else false
-void Run_Shell_Start( Shell::Data& m )
+// Clear the buffer of job, creating it if needed, and go to it
+void Job_Buffer_Start( Shell::Data& m, Job& job )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  // Add ######################################
+  char name[32];
+  sprintf( name, "%s%u", JOB_BUF_NAME, unsigned( &job - m.jobs + 1 ) );
+
+  if( 0 == job.pfb )
+  {
+    // pfb gets added to vis files in Add_FileBuf_2_Lists_Create_Views()
+    job.pfb = new(__FILE__,__LINE__) FileBuf( m.vis, name, false, FT_TEXT );
+    job.pfb->Set_Max_Lines( JOB_MAX_LINES );
+  }
+  while( job.pfb->NumLines() ) job.pfb->PopLine();
+
+  // Command, followed by ######################################
+  job.pfb->PushLine();
+  for( unsigned k=0; k<job.cmd.len(); k++ ) job.pfb->PushChar( job.cmd.get(k) );
+  job.pfb->PushLine( m.divider );
+  job.pfb->PushLine();
+
+  String fname( name );
+  m.vis.GoToBuffer_Fname( fname );
+
+  job.view = m.vis.CV();
+}
+
+void Run_Shell_Start( Shell::Data& m, Job& job )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  job.cmd = m.cmd;
+
+  // Add ###################################### followed by empty line
+  // to shell buffer, for the next command:
   m.pfb->PushLine( m.divider );
+  m.pfb->PushLine();
+  m.view->GoToCrsPos_NoWrite( m.pfb->NumLines()-1, 0 );
 
-  m.fd = Pipe_Fork_Exec( m );
-  if( 0 == m.fd )
+  job.fd = Pipe_Fork_Exec( m, job );
+  if( 0 == job.fd )
   {
     m.vis.Window_Message("\nPipe_Fork_Exec( %s ) failed\n\n", m.cmd.c_str() );
-
-    Print_Divider_Move_Cursor_2_Bottom( m );
   }
   else {
-    m.pfb->PushLine();
+    Job_Buffer_Start( m, job );
+
+    job.running      = true;
+    job.draw_pending = false;
+    job.esc_state    = ESC_NONE;
+    job.start_time   = GetTimeSeconds();
+    job.drawn_time   = job.start_time;
+
     // Move cursor to bottom of file
-    const unsigned NUM_LINES = m.pfb->NumLines();
-    m.view->GoToCrsPos_NoWrite( NUM_LINES-1, 0 );
-    m.running = true;
-    m.pfb->Update();
+    const unsigned NUM_LINES = job.pfb->NumLines();
+    job.view->GoToCrsPos_NoWrite( NUM_LINES-1, 0 );
+    job.pfb->Update();
   }
 }
 
-void Join_Print_Exit_Status( Shell::Data& m )
+void Join_Print_Exit_Status( Job& job )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  const int exit_val = CloseFd_WaitPID( m.fd, m.child_pid );
-  m.running = false;
+  job.exit_val = CloseFd_WaitPID( job.fd, job.child_pid );
+  job.end_time = GetTimeSeconds();
+  job.running = false;
+  job.draw_pending = false;
 
   char exit_msg[128];
-  sprintf( exit_msg, "Exit_Value=%i", exit_val );
+  sprintf( exit_msg, "Exit_Value=%i", job.exit_val );
 
   // Append exit_msg:
-  if( 0<m.pfb->LineLen( m.pfb->NumLines()-1 ) ) m.pfb->PushLine();
+  if( 0<job.pfb->LineLen( job.pfb->NumLines()-1 ) ) job.pfb->PushLine();
   const unsigned EXIT_MSG_LEN = strlen( exit_msg );
-  for( unsigned k=0; k<EXIT_MSG_LEN; k++ ) m.pfb->PushChar( exit_msg[k] );
+  for( unsigned k=0; k<EXIT_MSG_LEN; k++ ) job.pfb->PushChar( exit_msg[k] );
 }
 
-void Run_Blocking( Shell::Data& m )
+// Append LEN bytes of output in m.buffer to m.chunk, leaving out
+// CSI escape sequences, like colors, in one pass.
+// job.esc_state carries a sequence split across reads over to the next read.
+void Strip_Escape_Seqs( Shell::Data& m, Job& job, const unsigned LEN )
 {
-  Trace trace( __PRETTY_FUNCTION__ );
+  const char* const buf = m.buffer;
 
-  double T1 = GetTimeSeconds();
-  char C = 0;
-  // 1==success, 0==EOF, -1==Error. If not 1, drop out.
-  while( 0 < read( m.fd, &C, 1 ) )
+  for( unsigned p=0; p<LEN; )
   {
-    if( '\n' != C ) m.pfb->PushChar( C );
-    else {
-      m.pfb->PushLine();
-      double T2 = GetTimeSeconds();
-      if( 0.5 < (T2-T1) ) {
-        T1 = T2;
-        // Move cursor to bottom of file
-        const unsigned NUM_LINES = m.pfb->NumLines();
-        m.view->GoToCrsPos_NoWrite( NUM_LINES-1, 0 );
-        m.pfb->Update();
+    if( ESC_NONE == job.esc_state )
+    {
+      const char* esc = SCast<const char*>( memchr( buf+p, '\E', LEN-p ) );
+      const unsigned fn = esc ? esc-buf : LEN;
+
+      m.chunk.append( buf+p, fn-p );
+      p = fn;
+
+      if( esc ) { job.esc_state = ESC_START; p++; }
+    }
+    else if( ESC_START == job.esc_state )
+    {
+      if( '[' == buf[p] ) { job.esc_state = ESC_CSI; p++; }
+      else {
+        // Not a CSI sequence, so keep the ESC:
+        m.chunk.push( '\E' );
+        job.esc_state = ESC_NONE;
       }
     }
+    else { // ESC_CSI
+      const uint8_t C = buf[p];
+
+      // Parameter and intermediate bytes, followed by a final byte:
+      if     ( 0x40 <= C && C <= 0x7E ) { job.esc_state = ESC_NONE; p++; }
+      else if( 0x20 <= C && C <= 0x3F ) { p++; }
+      else job.esc_state = ESC_NONE; // Not a valid sequence, so keep C
+    }
   }
-  Join_Print_Exit_Status( m );
+}
+
+// Append LEN bytes of output in m.buffer to the end of the job
+// buffer, as whole lines instead of one char at a time.
+void Append_Output( Shell::Data& m, Job& job, const unsigned LEN )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
 
-  Print_Divider_Move_Cursor_2_Bottom( m );
+  m.chunk.clear();
+  Strip_Escape_Seqs( m, job, LEN );
+
+  const unsigned LAST_LINE = job.pfb->NumLines()-1;
+
+  CrsPos pos = { LAST_LINE, job.pfb->LineLen( LAST_LINE ) };
+
+  job.pfb->InsertText( pos, m.chunk );
+  job.pfb->Apply_Cap();
+
+  job.draw_pending = true;
 }
 
-void Run_Non_Blocking( Shell::Data& m )
+void Draw_Output( Job& job )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  const ssize_t bytes_read = read( m.fd, m.buffer, BUF_SIZE );
+  // Move cursor to bottom of file
+  const unsigned NUM_LINES = job.pfb->NumLines();
+  job.view->GoToCrsPos_NoWrite( NUM_LINES-1, 0 );
+  job.pfb->Update();
+
+  job.draw_pending = false;
+  job.drawn_time   = GetTimeSeconds();
+}
 
-  if( 0 < bytes_read )
+void Run_Blocking( Shell::Data& m, Job& job )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  // 0==EOF, -1==Error. If not interrupted, drop out.
+  for( ssize_t bytes_read = 0
+     ; 0 < (bytes_read = read( job.fd, m.buffer, BUF_SIZE ))
+    || (bytes_read < 0 && EINTR == errno); )
   {
-    for( size_t k=0; k<bytes_read; k++ )
+    if( 0 < bytes_read )
     {
-      const int C = m.buffer[k];
-
-      if( '\n' != C ) m.pfb->PushChar( C );
-      else {
-        m.pfb->PushLine();
+      Append_Output( m, job, bytes_read );
 
-        // Move cursor to bottom of file
-        const unsigned NUM_LINES = m.pfb->NumLines();
-        m.view->GoToCrsPos_NoWrite( NUM_LINES-1, 0 );
-        m.pfb->Update();
-      }
+      if( FRAME_TIME <= GetTimeSeconds() - job.drawn_time ) Draw_Output( job );
     }
   }
+  Join_Print_Exit_Status( job );
+
+  Print_Divider_Move_Cursor_2_Bottom( m, job );
+}
+
+// Reads one chunk of output from job.
+// Returns true if output was read, else false.
+bool Run_Non_Blocking( Shell::Data& m, Job& job )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const ssize_t bytes_read = read( job.fd, m.buffer, BUF_SIZE );
+
+  if( 0 < bytes_read )
+  {
+    Append_Output( m, job, bytes_read );
+
+    return true;
+  }
+  else if( bytes_read < 0 && (EAGAIN == errno || EINTR == errno) )
+  {
+    // No data currently available, but EOF not yet reached,
+    // so just return and try again later
+  }
   else {
-    if( bytes_read < 0 && EAGAIN == errno )
-    {
-      // No data currently available, but EOF not yet reached,
-      // so just return and try again later
-    }
-    else {
-      // 0==EOF, or -1==Error, either way, drop out
-      Join_Print_Exit_Status( m );
+    // 0==EOF, or -1==Error, either way, drop out
+    Join_Print_Exit_Status( job );
 
-      Print_Divider_Move_Cursor_2_Bottom( m );
-    }
+    Print_Divider_Move_Cursor_2_Bottom( m, job );
   }
+  return false;
+}
+
+void Report_Job( const unsigned k, const Job& job, String& rpt )
+{
+  const double end = job.running ? GetTimeSeconds() : job.end_time;
+
+  char status[32];
+  if( job.running ) sprintf( status, "running" );
+  else              sprintf( status, "exit %i", job.exit_val );
+
+  char buf[128];
+  sprintf( buf, "%3u  %-12s %9.1f  %s%u  "
+              , k+1, status, end - job.start_time, JOB_BUF_NAME, k+1 );
+  rpt += buf;
+  rpt += job.cmd;
+  rpt += "\n";
 }
 
 #endif
@@ -368,6 +536,8 @@ Shell::~Shell()
   MemMark(__FILE__,__LINE__); delete &m;
 }
 
+// Run the command at the bottom of the shell buffer as a job,
+// with its output going into the job buffer
 void Shell::Run()
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -378,13 +548,19 @@ void Shell::Run()
 
   bool ok = Get_Shell_Cmd( m );
 
-  if( ok )
+  Job* job = ok ? Free_Job( m ) : 0;
+
+  if( ok && 0 == job )
   {
-    Run_Shell_Start( m );
+    m.vis.CmdLineMessage("All %u jobs are running", MAX_JOBS );
+  }
+  else if( ok )
+  {
+    Run_Shell_Start( m, *job );
 
-    if( m.running && m.fd_blocking )
+    if( job->running && job->fd_blocking )
     {
-      Run_Blocking( m );
+      Run_Blocking( m, *job );
     }
   }
   else {
@@ -393,13 +569,105 @@ void Shell::Run()
 #endif
 }
 
-bool Shell::Running() const
+// Returns true if a job is running with its output going into pfb
+bool Shell::Running( const FileBuf* pfb ) const
+{
+  for( unsigned k=0; k<MAX_JOBS; k++ )
+  {
+    if( m.jobs[k].running && m.jobs[k].pfb == pfb ) return true;
+  }
+  return false;
+}
+
+// Returns true if pfb is the buffer of a job
+bool Shell::Is_Job_Buf( const FileBuf* pfb ) const
+{
+  for( unsigned k=0; k<MAX_JOBS; k++ )
+  {
+    if( 0 != pfb && m.jobs[k].pfb == pfb ) return true;
+  }
+  return false;
+}
+
+// Returns the fd output of running job is read from, else -1
+int Shell::Fd( const unsigned job ) const
+{
+  return job < MAX_JOBS && m.jobs[job].running ? m.jobs[job].fd : -1;
+}
+
+// Returns the earliest time output not yet drawn should be drawn, else 0
+double Shell::Draw_Time() const
 {
-  return m.running;
+  double draw = 0;
+
+  for( unsigned k=0; k<MAX_JOBS; k++ )
+  {
+    const Job& job = m.jobs[k];
+
+    if( job.running && job.draw_pending )
+    {
+      const double T = job.drawn_time + FRAME_TIME;
+
+      if( 0 == draw || T < draw ) draw = T;
+    }
+  }
+  return draw;
 }
 
+// Read output from all running jobs, taking turns one chunk at a time,
+// until no output is available, but for no more than a frame, so keys
+// typed while output is coming in are still handled.
+// Output of each job is drawn at most once per frame.
 void Shell::Update()
 {
-  Run_Non_Blocking( m );
+  Trace trace( __PRETTY_FUNCTION__ );
+
+#ifndef WIN32
+  const double T1 = GetTimeSeconds();
+
+  for( bool read_some = true
+     ; read_some && GetTimeSeconds() - T1 < FRAME_TIME; )
+  {
+    read_some = false;
+
+    for( unsigned k=0; k<MAX_JOBS; k++ )
+    {
+      if( m.jobs[k].running && Run_Non_Blocking( m, m.jobs[k] ) )
+      {
+        read_some = true;
+      }
+    }
+  }
+  const double T2 = GetTimeSeconds();
+
+  for( unsigned k=0; k<MAX_JOBS; k++ )
+  {
+    Job& job = m.jobs[k];
+
+    if( job.running && job.draw_pending
+     && FRAME_TIME <= T2 - job.drawn_time ) Draw_Output( job );
+  }
+#endif
+}
+
+// Append a line for each job to rpt
+void Shell::Jobs_Report( String& rpt ) const
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  rpt += "Job  Status        Time (s)  Buffer  Command\n";
+
+  unsigned num_jobs = 0;
+#ifndef WIN32
+  for( unsigned k=0; k<MAX_JOBS; k++ )
+  {
+    if( 0 != m.jobs[k].pfb )
+    {
+      Report_Job( k, m.jobs[k], rpt );
+      num_jobs++;
+    }
+  }
+#endif
+  if( 0 == num_jobs ) rpt += "No jobs have been run\n";
 }
 
@@ -25,6 +25,10 @@
 #define __SHELL_HH__
 
 class Vis;
+class FileBuf;
+class String;
+
+const unsigned MAX_JOBS = 8; // Most shell commands running at once
 
 class Shell
 {
@@ -33,8 +37,12 @@ public:
   ~Shell();
 
   void Run();
-  bool Running() const;
+  bool Running( const FileBuf* pfb ) const;
+  bool Is_Job_Buf( const FileBuf* pfb ) const;
+  int  Fd( const unsigned job ) const;
+  double Draw_Time() const;
   void Update();
+  void Jobs_Report( String& rpt ) const;
 
   struct Data;
 
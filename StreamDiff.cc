@@ -0,0 +1,174 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+// Prints the differences between two files as a unified diff, using
+// Stream_Diff, so files larger than memory can be diffed.  Run it from
+// the vis shell buffer to page through the hunks.
+// Build with: make vis-streamdiff
+// Run with:   vis-streamdiff [-u context] [-a algo] [-s] file_0 file_1
+// Exits with 0 if the files are the same, 1 if they differ, 2 on error.
+
+#include <errno.h>     // errno
+#include <stdio.h>     // printf, fprintf, fwrite
+#include <stdlib.h>    // atol
+#include <string.h>    // strcmp, strerror
+#include <sys/time.h>  // gettimeofday
+
+#include "Stream_Diff.hh"
+
+static double Secs()
+{
+  struct timeval tv;
+  gettimeofday( &tv, 0 );
+  return tv.tv_sec + tv.tv_usec*1e-6;
+}
+
+static int Usage( const char* prog )
+{
+  fprintf( stderr, "usage: %s [-u context] [-a myers|patience] [-s] file_0 file_1\n"
+                   "  -u  same lines shown around differences, default 3\n"
+                   "  -a  line diff algorithm, default patience\n"
+                   "  -s  print sizes and times to stderr\n", prog );
+  return 2;
+}
+
+// Prints a hunk range of LEN lines starting at line ST, like diff -u
+static void Print_Range( const char c, const unsigned ST, const unsigned LEN )
+{
+  if( 1 == LEN ) printf(" %c%u", c, ST+1 );
+  else           printf(" %c%u,%u", c, 0<LEN ? ST+1 : ST, LEN );
+}
+
+static void Print_Line( Stream_Diff& sd, const unsigned k, const unsigned ln
+                      , const char c )
+{
+  unsigned len = 0;
+  const char* line = sd.Line( k, ln, len );
+
+  putchar( c );
+  fwrite( line, 1, len, stdout );
+  putchar('\n');
+
+  if( ln+1 == sd.Num_Lines( k ) && sd.Missing_Newline( k ) )
+  {
+    printf("\\ No newline at end of file\n");
+  }
+}
+
+static void Print_Hunk( Stream_Diff& sd, const Stream_Hunk& h
+                      , unsigned& run )
+{
+  const Array_t<Same_Run>& runs = sd.Runs();
+
+  printf("@@");
+  Print_Range('-', h.st_0, h.fn_0 - h.st_0 );
+  Print_Range('+', h.st_1, h.fn_1 - h.st_1 );
+  printf(" @@\n");
+
+  unsigned ln_0 = h.st_0;
+  unsigned ln_1 = h.st_1;
+
+  while( ln_0 < h.fn_0 || ln_1 < h.fn_1 )
+  {
+    // Skip runs that end before ln_0:
+    while( run < runs.len() && runs[run].ln_s + runs[run].nlines <= ln_0 ) run++;
+
+    // Lines before the next same run differ:
+    const bool     HAVE_RUN = run < runs.len();
+    const unsigned RUN_0 = HAVE_RUN ? runs[run].ln_s : h.fn_0;
+    const unsigned RUN_1 = HAVE_RUN ? runs[run].ln_l : h.fn_1;
+
+    for( ; ln_0 < RUN_0 && ln_0 < h.fn_0; ln_0++ ) Print_Line( sd, 0, ln_0, '-');
+    for( ; ln_1 < RUN_1 && ln_1 < h.fn_1; ln_1++ ) Print_Line( sd, 1, ln_1, '+');
+
+    if( HAVE_RUN )
+    {
+      const unsigned RUN_FN_0 = runs[run].ln_s + runs[run].nlines;
+
+      for( ; ln_0 < RUN_FN_0 && ln_0 < h.fn_0; ln_0++, ln_1++ )
+      {
+        Print_Line( sd, 0, ln_0, ' ');
+      }
+    }
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  unsigned  context = 3;
+  Diff_Algo algo    = DA_PATIENCE;
+  bool      stats   = false;
+
+  int k = 1;
+  for( ; k<argc && '-' == argv[k][0]; k++ )
+  {
+    if     ( 0==strcmp( argv[k], "-s" ) ) stats = true;
+    else if( 0==strcmp( argv[k], "-u" ) && k+1<argc ) context = atol( argv[++k] );
+    else if( 0==strcmp( argv[k], "-a" ) && k+1<argc )
+    {
+      if( !Str_2_Diff_Algo( argv[++k], algo ) ) return Usage( argv[0] );
+    }
+    else return Usage( argv[0] );
+  }
+  if( k+2 != argc ) return Usage( argv[0] );
+
+  const char* path_0 = argv[k];
+  const char* path_1 = argv[k+1];
+
+  Stream_Diff sd;
+
+  const double t1 = Secs();
+
+  if( !sd.Open( path_0, path_1 ) )
+  {
+    fprintf( stderr, "%s: %s: %s\n", argv[0], sd.Failed_Path(), strerror( errno ) );
+    return 2;
+  }
+  const double t2 = Secs();
+
+  sd.Run( algo );
+
+  const double t3 = Secs();
+
+  Array_t<Stream_Hunk> hunks;
+  sd.Hunks( context, hunks );
+
+  if( hunks.len() )
+  {
+    printf("--- %s\n+++ %s\n", path_0, path_1 );
+  }
+  unsigned run = 0;
+  for( unsigned h=0; h<hunks.len(); h++ ) Print_Hunk( sd, hunks[h], run );
+
+  if( stats )
+  {
+    const double t4 = Secs();
+
+    fprintf( stderr, "lines %u %u, distinct %u, runs %u, hunks %u, memory %.1f MB\n"
+                     "open %.0f ms, diff %.0f ms, print %.0f ms\n"
+           , sd.Num_Lines( 0 ), sd.Num_Lines( 1 ), sd.Num_Ids()
+           , sd.Runs().len(), hunks.len(), sd.Mem_Used()/1e6
+           , (t2-t1)*1000, (t3-t2)*1000, (t4-t3)*1000 );
+  }
+  return hunks.len() ? 1 : 0;
+}
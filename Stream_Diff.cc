@@ -0,0 +1,513 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#include <errno.h>     // errno, EFBIG, EISDIR
+#include <limits.h>    // UINT_MAX
+#include <string.h>    // memchr
+#include <stdio.h>     // FILE, fopen, fread, fclose
+#include <stdlib.h>    // malloc, realloc, free
+#include <unistd.h>    // read, close
+#include <fcntl.h>     // open
+#include <sys/stat.h>  // fstat
+#if !defined(WIN32)
+#include <sys/mman.h>  // mmap, munmap, madvise
+#endif
+
+#include "Hash.hh"
+#include "Stream_Diff.hh"
+
+// Lines hashed at a time, so the hash table cache misses overlap:
+static const unsigned SCAN_BATCH = 16;
+
+// Bytes at the start of each file looked at to guess its line count:
+static const unsigned GUESS_BYTES = 1024*1024;
+
+// Gives out line ids by 96 bits of a 128-bit hash of each line.  Lines
+// are not compared byte by byte, which would mean reading back earlier
+// parts of the files.  For n distinct lines, the chance of two of them
+// getting the same id is about n*n/2^97, 1 in 10^11 for 10^9 lines.
+struct Stream_Diff::Hash_Ids
+{
+  struct Slot
+  {
+    unsigned long long hash;  // First 64 bits of line hash
+    unsigned           check; // Next 32 bits
+    unsigned           id;    // Line id + 1, 0 if empty
+  };
+  static const unsigned MAX_SLOTS = 1u << 31;
+
+  Array_t<Slot> slots; // Hash table, at most 3/4 full
+  unsigned      num_ids;
+
+  Hash_Ids()
+    : slots( 1024, Slot() )
+    , num_ids( 0 )
+  {}
+
+  unsigned Mask() const { return slots.len() - 1; }
+
+  // Makes room for num more ids, returning false if there is not room
+  bool Reserve( const unsigned num )
+  {
+    const unsigned long long NEED = 4ull*(num_ids + (unsigned long long)num)/3 + 1;
+
+    if( MAX_SLOTS < NEED ) return false;
+
+    while( slots.len() < NEED ) Grow();
+
+    return true;
+  }
+  unsigned Id( const unsigned long long h[2] );
+  void     Grow();
+};
+
+unsigned Stream_Diff::Hash_Ids::Id( const unsigned long long h[2] )
+{
+  const unsigned MASK  = Mask();
+  const unsigned CHECK = unsigned( h[1] );
+
+  for( unsigned k=unsigned( h[0] ) & MASK; ; k = (k + 1) & MASK )
+  {
+    Slot& slot = slots[k];
+
+    if( 0 == slot.id ) // New line
+    {
+      slot.hash  = h[0];
+      slot.check = CHECK;
+      slot.id    = ++num_ids;
+      return slot.id - 1;
+    }
+    if( slot.hash == h[0] && slot.check == CHECK ) return slot.id - 1;
+  }
+}
+
+// Doubles the size of the hash table
+void Stream_Diff::Hash_Ids::Grow()
+{
+  const Array_t<Slot> old( slots );
+
+  slots.clear();
+  slots.set_len( 2*old.len() );
+
+  const unsigned MASK = Mask();
+
+  for( unsigned j=0; j<old.len(); j++ )
+  {
+    if( old[j].id )
+    {
+      unsigned k = unsigned( old[j].hash ) & MASK;
+
+      while( slots[k].id ) k = (k + 1) & MASK;
+
+      slots[k] = old[j];
+    }
+  }
+}
+
+Stream_Diff::Stream_Diff()
+  : m_num_ids( 0 )
+  , m_runs()
+  , m_failed( 0 )
+{
+  for( unsigned k=0; k<2; k++ )
+  {
+    m_f[k].data    = 0;
+    m_f[k].size    = 0;
+    m_f[k].mapped  = false;
+    m_f[k].last_ln = ~0u;
+    m_f[k].last_fn = 0;
+  }
+}
+
+Stream_Diff::~Stream_Diff()
+{
+  Close();
+}
+
+bool Stream_Diff::Open( const char* path_0, const char* path_1 )
+{
+  Close();
+
+  // The hash table is only needed to give out ids, so it goes away
+  // before diffing:
+  Hash_Ids hash_ids;
+
+  bool ok = Map( m_f[0], path_0 ) && Scan( m_f[0], hash_ids );
+
+  if( !ok ) m_failed = path_0;
+  else {
+    ok = Map( m_f[1], path_1 ) && Scan( m_f[1], hash_ids );
+
+    if( !ok ) m_failed = path_1;
+  }
+
+  m_num_ids = hash_ids.num_ids;
+
+  if( !ok )
+  {
+    const int         err    = errno;
+    const char* const failed = m_failed;
+    Close();
+    errno    = err;
+    m_failed = failed;
+  }
+  return ok;
+}
+
+void Stream_Diff::Close()
+{
+  for( unsigned k=0; k<2; k++ )
+  {
+    File& f = m_f[k];
+
+    Unmap( f );
+    f.ids.clear();
+    f.marks.clear();
+    f.last_ln = ~0u;
+    f.last_fn = 0;
+  }
+  m_num_ids = 0;
+  m_runs.clear();
+  m_failed = 0;
+}
+
+void Stream_Diff::Run( const Diff_Algo algo )
+{
+  // Diff_Ids() wants the shorter file first:
+  const bool SWAP = Num_Lines( 1 ) < Num_Lines( 0 );
+
+  File& s = m_f[ SWAP ? 1 : 0 ];
+  File& l = m_f[ SWAP ? 0 : 1 ];
+
+  Diff_Ids( s.ids.get(0), s.ids.len()
+          , l.ids.get(0), l.ids.len(), m_num_ids, algo, m_runs );
+
+  if( SWAP )
+  {
+    for( unsigned k=0; k<m_runs.len(); k++ )
+    {
+      Same_Run& r = m_runs[k];
+      const unsigned ln_0 = r.ln_l;
+      r.ln_l = r.ln_s;
+      r.ln_s = ln_0;
+    }
+  }
+}
+
+void Stream_Diff::Hunks( const unsigned context
+                       , Array_t<Stream_Hunk>& hunks ) const
+{
+  hunks.clear();
+
+  const unsigned N_0 = Num_Lines( 0 );
+  const unsigned N_1 = Num_Lines( 1 );
+  const unsigned NUM_RUNS = m_runs.len();
+
+  // Ends of the last same run, and of the last difference in file 0:
+  unsigned p_0 = 0, p_1 = 0, d_0 = 0;
+
+  for( unsigned k=0; k<=NUM_RUNS; k++ )
+  {
+    // Start of the next same run, or the ends of the files:
+    const unsigned n_0 = k<NUM_RUNS ? m_runs[k].ln_s : N_0;
+    const unsigned n_1 = k<NUM_RUNS ? m_runs[k].ln_l : N_1;
+
+    if( p_0 < n_0 || p_1 < n_1 ) // Lines [p,n) differ
+    {
+      const unsigned LEN = hunks.len();
+
+      if( LEN && p_0 - d_0 <= 2*context )
+      {
+        hunks[LEN-1].fn_0 = n_0;
+        hunks[LEN-1].fn_1 = n_1;
+      }
+      else {
+        Stream_Hunk h = { p_0 < context ? 0 : p_0 - context, n_0
+                        , p_1 < context ? 0 : p_1 - context, n_1 };
+        hunks.push( h );
+      }
+      d_0 = n_0;
+    }
+    if( k<NUM_RUNS )
+    {
+      p_0 = n_0 + m_runs[k].nlines;
+      p_1 = n_1 + m_runs[k].nlines;
+    }
+  }
+  // Same lines after each hunk.  Hunks that were not joined are more
+  // than 2*context same lines apart, so these stay inside the same run:
+  for( unsigned k=0; k<hunks.len(); k++ )
+  {
+    Stream_Hunk& h = hunks[k];
+    h.fn_0 = N_0 - h.fn_0 < context ? N_0 : h.fn_0 + context;
+    h.fn_1 = N_1 - h.fn_1 < context ? N_1 : h.fn_1 + context;
+  }
+}
+
+const char* Stream_Diff::Line( const unsigned k, const unsigned ln
+                             , unsigned& len )
+{
+  File& f = m_f[k];
+
+  len = 0;
+  if( f.ids.len() <= ln ) return "";
+
+  unsigned long long st = f.last_fn;
+
+  // Unless ln follows the last line returned, start at the nearest mark
+  // before ln and skip lines.  last_ln starts at ~0u, so line 0 follows.
+  if( ln != f.last_ln + 1 )
+  {
+    st = f.marks[ ln/LINES_PER_MARK ];
+
+    for( unsigned j=ln%LINES_PER_MARK; 0<j; j-- )
+    {
+      const char* nl = static_cast<const char*>
+                       ( memchr( f.data + st, '\n', f.size - st ) );
+      st = nl - f.data + 1;
+    }
+  }
+  const char* line = f.data + st;
+  const char* nl = static_cast<const char*>( memchr( line, '\n', f.size - st ) );
+
+  len = nl ? nl - line : f.size - st;
+  f.last_ln = ln;
+  f.last_fn = st + len + (nl ? 1 : 0);
+
+  return line;
+}
+
+bool Stream_Diff::Missing_Newline( const unsigned k ) const
+{
+  const File& f = m_f[k];
+
+  return 0 < f.size && '\n' != f.data[ f.size-1 ];
+}
+
+unsigned long long Stream_Diff::Mem_Used() const
+{
+  unsigned long long bytes = m_runs.cap()*sizeof(Same_Run);
+
+  for( unsigned k=0; k<2; k++ )
+  {
+    bytes += m_f[k].ids  .cap()*sizeof(unsigned)
+           + m_f[k].marks.cap()*sizeof(unsigned long long);
+  }
+  return bytes;
+}
+
+#if !defined(WIN32)
+// Reads all of fd into malloc'ed memory at data, for inputs like pipes
+// that have no size and can not be mapped.  Empty inputs have no data.
+static bool Read_All( const int fd
+                    , const char*& data
+                    , unsigned long long& size )
+{
+  char* buf = 0;
+  unsigned long long cap = 0;
+  size = 0;
+
+  for( ;; )
+  {
+    if( size == cap )
+    {
+      const unsigned long long new_cap = cap ? 2*cap : 64*1024;
+      char* new_buf = static_cast<char*>( realloc( buf, new_cap ) );
+
+      if( !new_buf ) { free( buf ); return false; }
+      buf = new_buf;
+      cap = new_cap;
+    }
+    const ssize_t got = read( fd, buf + size, cap - size );
+
+    if( got < 0 )
+    {
+      if( EINTR == errno ) continue;
+      const int err = errno;
+      free( buf );
+      errno = err;
+      return false;
+    }
+    if( 0 == got ) break;
+
+    size += got;
+  }
+  if( 0 == size ) { free( buf ); buf = 0; }
+
+  data = buf;
+  return true;
+}
+#endif
+
+// Maps the regular file at path into f.data, or reads it where it can
+// not be mapped.  Empty files have no data.  Directories fail.
+bool Stream_Diff::Map( File& f, const char* path )
+{
+  bool ok = false;
+#if defined(WIN32)
+  FILE* fp = fopen( path, "rb" );
+  if( fp )
+  {
+    if( 0 == fseek( fp, 0, SEEK_END ) )
+    {
+      const long size = ftell( fp );
+      char* data = 0 < size ? static_cast<char*>( malloc( size ) ) : 0;
+
+      if( 0 == size ) ok = true;
+      else if( data )
+      {
+        rewind( fp );
+        if( size == long( fread( data, 1, size, fp ) ) )
+        {
+          f.data = data;
+          f.size = size;
+          ok = true;
+        }
+        else free( data );
+      }
+    }
+    fclose( fp );
+  }
+#else
+  const int fd = open( path, O_RDONLY );
+  if( 0 <= fd )
+  {
+    struct stat sbuf;
+    if( 0 == fstat( fd, &sbuf ) )
+    {
+      const unsigned long long size = sbuf.st_size;
+
+      if( S_ISDIR( sbuf.st_mode ) ) errno = EISDIR;
+      else if( !S_ISREG( sbuf.st_mode ) )
+      {
+        // Pipes and devices have no size, so read them:
+        ok = Read_All( fd, f.data, f.size );
+      }
+      else if( 0 == size ) ok = true;
+      else {
+        void* data = mmap( 0, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+        if( MAP_FAILED != data )
+        {
+          // Pages already scanned can be dropped:
+          madvise( data, size, MADV_SEQUENTIAL );
+          f.data   = static_cast<const char*>( data );
+          f.size   = size;
+          f.mapped = true;
+          ok = true;
+        }
+      }
+    }
+    const int err = errno;
+    close( fd );
+    errno = err;
+  }
+#endif
+  return ok;
+}
+
+// Guesses the number of lines in data from the lines in its first
+// GUESS_BYTES bytes
+static unsigned long long Guess_Lines( const char* data
+                                     , const unsigned long long size )
+{
+  const unsigned long long SAMPLE = size < GUESS_BYTES ? size : GUESS_BYTES;
+
+  unsigned long long lines = 1;
+  for( const char* p=data; p < data + SAMPLE; p++ )
+  {
+    const char* nl = static_cast<const char*>( memchr( p, '\n', data + SAMPLE - p ) );
+    if( !nl ) break;
+    lines++;
+    p = nl;
+  }
+  return (unsigned long long)( double( size )/SAMPLE*lines );
+}
+
+// Gives each line of f an id, and marks every LINES_PER_MARK'th line
+bool Stream_Diff::Scan( File& f, Hash_Ids& hash_ids )
+{
+  const char* p   = f.data;
+  const char* END = f.data + f.size;
+
+  // Growing the arrays as lines are added would copy them several
+  // times, and leave them up to twice as big as needed:
+  if( f.size )
+  {
+    const unsigned long long GUESS = Guess_Lines( f.data, f.size )*9/8;
+
+    if( GUESS < UINT_MAX )
+    {
+      f.ids.inc_cap( GUESS );
+      f.marks.inc_cap( GUESS/LINES_PER_MARK + 1 );
+
+      if( 0 == hash_ids.num_ids ) hash_ids.Reserve( GUESS );
+    }
+  }
+
+  unsigned long long hash[ SCAN_BATCH ][2];
+
+  while( p < END )
+  {
+    if( !hash_ids.Reserve( SCAN_BATCH ) ) { errno = EFBIG; return false; }
+
+    const unsigned MASK = hash_ids.Mask();
+
+    unsigned n = 0;
+    for( ; n<SCAN_BATCH && p < END; n++ )
+    {
+      const unsigned LN = f.ids.len() + n;
+
+      if( UINT_MAX == LN ) { errno = EFBIG; return false; }
+
+      if( 0 == LN%LINES_PER_MARK ) f.marks.push( p - f.data );
+
+      const char* nl = static_cast<const char*>( memchr( p, '\n', END - p ) );
+      const char* fn = nl ? nl + 1 : END;
+
+      // The newline is hashed too, so a last line without one
+      // differs from the same line with one:
+      Hash_128( p, fn - p, hash[n] );
+
+      __builtin_prefetch( hash_ids.slots.get( unsigned( hash[n][0] ) & MASK ) );
+
+      p = fn;
+    }
+    for( unsigned j=0; j<n; j++ ) f.ids.push( hash_ids.Id( hash[j] ) );
+  }
+  return true;
+}
+
+void Stream_Diff::Unmap( File& f )
+{
+  if( f.data )
+  {
+#if !defined(WIN32)
+    if( f.mapped ) munmap( const_cast<char*>( f.data ), f.size );
+    else
+#endif
+    free( const_cast<char*>( f.data ) );
+  }
+  f.data   = 0;
+  f.size   = 0;
+  f.mapped = false;
+}
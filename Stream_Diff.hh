@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+// VI-Simplified (vis) C++ Implementation                                     //
+// Copyright (c) 19 Oct 2026 Paul J. Gartside                                 //
+////////////////////////////////////////////////////////////////////////////////
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without  limitation //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef __STREAM_DIFF_HH__
+#define __STREAM_DIFF_HH__
+
+#include "Diff_Engine.hh"
+
+// Line diff of two files too big to load into FileBuf's.  The files are
+// mapped into memory instead of read, and each line is kept only as a
+// 4 byte id, plus the file offset of every LINES_PER_MARK'th line, so
+// the memory used depends on the number of lines, not their length.
+// Lines are compared by hash, so the files are read through once in
+// order, and line text is looked up again only for the lines shown.
+// Does not depend on FileBuf or the console.
+
+// Lines [st_0,fn_0) of file 0 and [st_1,fn_1) of file 1 shown together:
+// lines that differ, and up to context same lines before and after.
+struct Stream_Hunk
+{
+  unsigned st_0, fn_0;
+  unsigned st_1, fn_1;
+};
+
+class Stream_Diff
+{
+public:
+  Stream_Diff();
+  ~Stream_Diff();
+
+  // Maps the two files and gives each line an id, equal ids for equal
+  // lines.  Returns false, with errno set, if either can not be read.
+  bool Open( const char* path_0, const char* path_1 );
+  void Close();
+
+  // Path that the last Open() could not read, else 0
+  const char* Failed_Path() const { return m_failed; }
+
+  // Diffs the files opened.  In Runs(), ln_s is a line number in
+  // file 0, and ln_l is a line number in file 1.
+  void Run( const Diff_Algo algo );
+
+  const Array_t<Same_Run>& Runs() const { return m_runs; }
+
+  // Puts the differences of the last Run() in hunks, joining hunks
+  // less than 2*context same lines apart
+  void Hunks( const unsigned context, Array_t<Stream_Hunk>& hunks ) const;
+
+  // Returns line ln of file k, without its newline, and its length
+  // in len.  Reading lines in order is fastest.
+  const char* Line( const unsigned k, const unsigned ln, unsigned& len );
+
+  // True if the last line of file k does not end in a newline
+  bool Missing_Newline( const unsigned k ) const;
+
+  unsigned Num_Lines( const unsigned k ) const { return m_f[k].ids.len(); }
+  unsigned Num_Ids() const { return m_num_ids; }
+
+  // Bytes of memory allocated, not counting the mapped files
+  unsigned long long Mem_Used() const;
+
+private:
+  static const unsigned LINES_PER_MARK = 64;
+
+  struct File
+  {
+    const char*        data;
+    unsigned long long size;
+    bool               mapped;  // Else data was read into malloc'ed memory
+
+    Array_t<unsigned>           ids;
+    Array_t<unsigned long long> marks; // Offset of every LINES_PER_MARK'th line
+
+    unsigned           last_ln; // Line last returned by Line(),
+    unsigned long long last_fn; // and offset of the line after it
+  };
+
+  struct Hash_Ids;
+
+  bool Map ( File& f, const char* path );
+  bool Scan( File& f, Hash_Ids& hash_ids );
+  void Unmap( File& f );
+
+  File              m_f[2];
+  unsigned          m_num_ids;
+  Array_t<Same_Run> m_runs;
+  const char*       m_failed;
+};
+
+#endif
@@ -170,6 +170,18 @@ bool String::append( const String& a )
   return true;
 }
 
+// Append len bytes of cp, which may include 0's
+bool String::append( const char* cp, const unsigned len )
+{
+  if( cp )
+  {
+    m.s.append( cp, len );
+
+    return true;
+  }
+  return false;
+}
+
 String& String::operator+=( const char* cp )
 {
   append( cp );
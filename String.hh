@@ -59,6 +59,7 @@ public:
 
   bool    append( const char* cp );
   bool    append( const String& a );
+  bool    append( const char* cp, const unsigned len );
   String& operator+=( const char*  cp );
   String& operator+=( const String& a );
 
@@ -38,6 +38,7 @@ const char* ChangeType_Str( const ChangeType ct )
   else if( ct ==  Insert_Text ) str =  "Insert_Text";
   else if( ct ==  Remove_Text ) str =  "Remove_Text";
   else if( ct == Replace_Text ) str = "Replace_Text";
+  else if( ct == Insert_Block ) str = "Insert_Block";
 
   return str;
 }
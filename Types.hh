@@ -135,7 +135,8 @@ enum ChangeType
    Remove_Line,
    Insert_Text,
    Remove_Text,
-  Replace_Text
+  Replace_Text,
+  Insert_Block  // Text of one or more lines inserted at once
 };
 
 enum Encoding
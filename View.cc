@@ -33,6 +33,7 @@
 #include "Key.hh"
 #include "Vis.hh"
 #include "View.hh"
+#include "Perf.hh"
 
 extern MemLog<MEM_LOG_BUF_SIZE> Log;
 
@@ -372,37 +373,45 @@ void TilePos_2_nCols( View::Data& m )
   }
 }
 
+// Returns the Style of a char from its highlight byte, hi, and whether
+// it is in the visual area.  Styles for all 512 combinations are found
+// once, in the same order of precedence as the View::In*() checks.
+Style HiStyle_2_Style( const uint8_t hi, const bool visual )
+{
+  static Style table[2][256];
+  static bool  have_table = false;
+
+  if( !have_table )
+  {
+    for( unsigned v=0; v<2; v++ )
+    for( unsigned h=0; h<256; h++ )
+    {
+      Style s = v ? S_RV_NORMAL : S_NORMAL;
+
+      if     ( h & HI_STAR      ) s = v ? S_RV_STAR      : S_STAR;
+      else if( h & HI_STAR_IN_F ) s = v ? S_RV_STAR_IN_F : S_STAR_IN_F;
+      else if( h & HI_DEFINE    ) s = v ? S_RV_DEFINE    : S_DEFINE;
+      else if( h & HI_COMMENT   ) s = v ? S_RV_COMMENT   : S_COMMENT;
+      else if( h & HI_CONST     ) s = v ? S_RV_CONST     : S_CONST;
+      else if( h & HI_CONTROL   ) s = v ? S_RV_CONTROL   : S_CONTROL;
+      else if( h & HI_VARTYPE   ) s = v ? S_RV_VARTYPE   : S_VARTYPE;
+      else if( h & HI_NONASCII  ) s = v ? S_RV_NONASCII  : S_NONASCII;
+
+      table[v][h] = s;
+    }
+    have_table = true;
+  }
+  return table[ visual ? 1 : 0 ][ hi ];
+}
+
 Style Get_Style( View::Data& m
                , const unsigned line
                , const unsigned pos )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
-  Style s = S_NORMAL;
-
-  if( m.view.InVisualArea( line, pos ) )
-  {
-    s = S_RV_NORMAL;
-
-    if     ( m.view.InStar    ( line, pos ) ) s = S_RV_STAR;
-    else if( m.view.InStarInF ( line, pos ) ) s = S_RV_STAR_IN_F;
-    else if( m.view.InDefine  ( line, pos ) ) s = S_RV_DEFINE;
-    else if( m.view.InComment ( line, pos ) ) s = S_RV_COMMENT;
-    else if( m.view.InConst   ( line, pos ) ) s = S_RV_CONST;
-    else if( m.view.InControl ( line, pos ) ) s = S_RV_CONTROL;
-    else if( m.view.InVarType ( line, pos ) ) s = S_RV_VARTYPE;
-    else if( m.view.InNonAscii( line, pos ) ) s = S_RV_NONASCII;
-  }
-  else if( m.view.InStar    ( line, pos ) ) s = S_STAR;
-  else if( m.view.InStarInF ( line, pos ) ) s = S_STAR_IN_F;
-  else if( m.view.InDefine  ( line, pos ) ) s = S_DEFINE;
-  else if( m.view.InComment ( line, pos ) ) s = S_COMMENT;
-  else if( m.view.InConst   ( line, pos ) ) s = S_CONST;
-  else if( m.view.InControl ( line, pos ) ) s = S_CONTROL;
-  else if( m.view.InVarType ( line, pos ) ) s = S_VARTYPE;
-  else if( m.view.InNonAscii( line, pos ) ) s = S_NONASCII;
-
-  return s;
+  return HiStyle_2_Style( m.fb.GetStyle( line ).get( pos )
+                        , m.view.InVisualArea( line, pos ) );
 }
 
 void InsertAddChar( View::Data& m
@@ -455,6 +464,20 @@ void InsertAddReturn( View::Data& m )
   m.fb.Update();
 }
 
+// Insert all of pasted text at once, with one change and one redraw:
+void InsertPaste( View::Data& m, const Line& text )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  CrsPos pos = { m.view.CrsLine(), m.view.CrsChar() };
+
+  m.fb.InsertText( pos, text );
+
+  m.view.GoToCrsPos_NoWrite( pos.crsLine, pos.crsChar );
+
+  m.fb.Update();
+}
+
 void InsertBackspace_RmC( View::Data& m
                         , const unsigned OCL
                         , const unsigned OCP )
@@ -2555,10 +2578,9 @@ void Do_dd_BufferEditor( View::Data& m, const unsigned ONL )
 
     const char* fname = lp->c_str( 0 );
 
-    if( !m.vis.File_Is_Displayed( fname ) )
+    if( !m.vis.File_Is_Displayed( fname )
+     &&  m.vis.ReleaseFileName( fname ) )
     {
-      m.vis.ReleaseFileName( fname );
-
       Do_dd_Normal( m, ONL );
     }
   }
@@ -3659,8 +3681,15 @@ void View::Do_i()
     GoToCrsPos_Write( CrsLine(), LL );
   }
   unsigned count = 0;
+  Line paste;
   for( char c=m.key.In(); c != ESC; c=m.key.In() )
   {
+    if( m.key.Get_Paste( c, paste ) )
+    {
+      InsertPaste( m, paste );
+      count += paste.len();
+      continue;
+    }
     if( IsEndOfLineDelim( c ) )
     {
       InsertAddReturn(m);
@@ -4325,7 +4354,7 @@ void View::Update( const bool PRINT_CURSOR )
    && !m.key.get_from_dot_buf_l )
   {
     m.fb.Find_Styles( m.topLine + WorkingRows() );
-    m.fb.Find_Regexs( m.topLine, WorkingRows() );
+    m.fb.Find_Regexs( m.topLine, WorkingRows(), m.leftChar, WorkingCols() );
 
     RepositionView();
     Print_Borders();
@@ -4465,8 +4494,7 @@ void View::PrintCmdLine()
     col=11; // Strlen of "--REPLACE--"
     Console::SetS( Cmd__Line_Row(), Col_Win_2_GL( 0 ), "--REPLACE--", S_BANNER );
   }
-  else if( m.vis.Shell_Running()
-        && m.vis.FileNum2Buf(SHELL_FILE) == &m.fb )
+  else if( m.vis.Shell_Running( &m.fb ) )
   {
     col=11; // Strlen of "--RUNNING--"
     Console::SetS( Cmd__Line_Row(), Col_Win_2_GL( 0 ), "--RUNNING--", S_BANNER );
@@ -4491,6 +4519,8 @@ void View::PrintWorkingView()
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
+  Perf_Timer perf( PERF_PRINT_VIEW );
+
   const unsigned NUM_LINES = m.fb.NumLines();
   const unsigned WR        = WorkingRows();
   const unsigned WC        = WorkingCols();
@@ -46,6 +46,8 @@
 #include "LineView.hh"
 #include "Key.hh"
 #include "Shell.hh"
+#include "Perf.hh"
+#include "Highlight_Base.hh"
 #include "Vis.hh"
 
 const char* PROG_NAME;
@@ -70,6 +72,7 @@ const char*  MSG__BUF_NAME = "MESSAGE_BUFFER";
 const char* SHELL_BUF_NAME = "SHELL_BUFFER";
 const char* COLON_BUF_NAME = "COLON_BUFFER";
 const char* SLASH_BUF_NAME = "SLASH_BUFFER";
+const char*   JOB_BUF_NAME = "JOB_BUFFER_"; // Followed by job number
 
 void WARN( const char* msg )
 {
@@ -159,7 +162,13 @@ void Handle_Cmd( Vis::Data& m )
 
   const char CC = m.key.In();
 
-  if( ('1' <= CC && CC <= '9')
+  Line paste;
+  if( m.key.Get_Paste( CC, paste ) )
+  {
+    // Dont run pasted text as commands:
+    m.vis.CmdLineMessage("Pasted %u chars ignored outside of insert mode", paste.len() );
+  }
+  else if( ('1' <= CC && CC <= '9')
    || ('0' == CC && 0 < m.repeat_buf.len()) ) //< Dont override [1-9]0 movement
   {
     m.repeat_buf.push( CC );
@@ -3388,15 +3397,22 @@ void ReHighlight_CV( Vis::Data& m )
 
 void RunCommand( Vis::Data& m )
 {
-  if( !m.vis.Shell_Running() )
+  if( SHELL_FILE == m.file_hist[ m.win ][ 0 ] )
   {
-    if( SHELL_FILE == m.file_hist[ m.win ][ 0 ] )
-    {
-      m.shell.Run();
-    }
+    m.shell.Run();
   }
 }
 
+void HandleColon_jobs( Vis::Data& m )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  String rpt("\n");
+  m.shell.Jobs_Report( rpt );
+
+  m.vis.Window_Message( "%s", rpt.c_str() );
+}
+
 void HandleColon_detab( Vis::Data& m )
 {
   if( 6 < strlen( m.cbuf ) )
@@ -3466,6 +3482,25 @@ void HandleColon_strip_escape_seqs( Vis::Data& m )
   CV(m)->GetFB()->Strip_escape_seqs();
 }
 
+void HandleColon_perf( Vis::Data& m )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  String rpt("\n");
+  Perf::Report( rpt );
+
+  m.vis.Window_Message( "%s", rpt.c_str() );
+}
+
+void HandleColon_perf_clear( Vis::Data& m )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  Perf::Clear();
+
+  m.vis.CmdLineMessage("Performance statistics cleared");
+}
+
 bool Matches_BYTE( String S )
 {
   return 0==S.compareToIgnoreCase("byte")
@@ -3559,6 +3594,92 @@ void HandleColon_tab_size( Vis::Data& m )
   }
 }
 
+void HandleColon_hi_line_len( Vis::Data& m )
+{
+  if( strlen( m.cbuf ) <= 3 )
+  {
+    unsigned len = CV(m)->GetFB()->Get_Hi_Max_Line_Len();
+    m.vis.CmdLineMessage("Highlight line length is: %u", len );
+  }
+  else { // 3 < strlen( m.cbuf )
+    const unsigned len = atol( m.cbuf + 3 );
+
+    CV(m)->GetFB()->Set_Hi_Max_Line_Len( len );
+  }
+}
+
+// :diffalgo=myers or :diffalgo=patience sets the line diff algorithm
+void HandleColon_diff_algo( Vis::Data& m )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const unsigned PLEN = strlen("diffalgo=");
+
+  if( strlen( m.cbuf ) <= PLEN )
+  {
+    m.vis.CmdLineMessage("Diff algorithm is: %s", m.diff.Get_Algo() );
+  }
+  else if( !m.diff.Set_Algo( m.cbuf + PLEN ) )
+  {
+    m.vis.CmdLineMessage("Unknown diff algorithm: %s", m.cbuf + PLEN );
+  }
+  else if( m.vis.InDiffMode() )
+  {
+    m.diff.ReRun();
+  }
+}
+
+// :diffignore=space,blank,case, or any of them, sets what differences
+// between lines the diff ignores, and :diffignore=none ignores none
+void HandleColon_diff_ignore( Vis::Data& m )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const unsigned PLEN = strlen("diffignore=");
+
+  if( strlen( m.cbuf ) <= PLEN )
+  {
+    m.vis.CmdLineMessage("Diff ignores: %s", m.diff.Get_Ignore() );
+  }
+  else if( !m.diff.Set_Ignore( m.cbuf + PLEN ) )
+  {
+    m.vis.CmdLineMessage("Unknown diff ignore: %s", m.cbuf + PLEN );
+  }
+  else if( m.vis.InDiffMode() )
+  {
+    m.diff.ReRun();
+  }
+}
+
+// :maxlines=N or :maxbytes=N keeps only the last N lines or bytes
+// of a job buffer. 0 means no limit.
+void HandleColon_max( Vis::Data& m, const bool lines )
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const char*    name = lines ? "lines" : "bytes";
+  const unsigned PLEN = strlen("maxlines=");
+  FileBuf* pfb = CV(m)->GetFB();
+
+  if( !m.shell.Is_Job_Buf( pfb ) )
+  {
+    m.vis.CmdLineMessage("Max %s can only be set for job buffers", name );
+  }
+  else if( strlen( m.cbuf ) <= PLEN )
+  {
+    const unsigned max = lines ? pfb->Get_Max_Lines() : pfb->Get_Max_Bytes();
+    m.vis.CmdLineMessage("Max %s is: %u", name, max );
+  }
+  else { // PLEN < strlen( m.cbuf )
+    const unsigned max = atol( m.cbuf + PLEN );
+
+    if( lines ) pfb->Set_Max_Lines( max );
+    else        pfb->Set_Max_Bytes( max );
+
+    pfb->Update();
+  }
+}
+
 void HandleColon_e( Vis::Data& m )
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -3606,9 +3727,10 @@ void HandleColon_w( Vis::Data& m )
   if(   0 == m.cbuf[1] // :w
    || ('q'== m.cbuf[1] && 0 == m.cbuf[2]) ) // :wq
   {
-    if( pV == m.views[m.win][ SHELL_FILE ] )
+    if( pV == m.views[m.win][ SHELL_FILE ]
+     || m.shell.Is_Job_Buf( pV->GetFB() ) )
     {
-      // Dont allow SHELL_BUFFER to be saved with :w.
+      // Dont allow SHELL_BUFFER or job buffers to be saved with :w.
       // Require :w filename.
       pV->PrintCursor();
     }
@@ -3689,6 +3811,8 @@ void Handle_Colon_Cmd( Vis::Data& m )
   else if( strcmp( m.cbuf,"qa"  )==0 ) QuitAll(m);
   else if( strcmp( m.cbuf,"help")==0 ) Help(m);
   else if( strcmp( m.cbuf,"diff")==0 ) Diff_Files_Displayed(m);
+  else if( strncmp(m.cbuf,"diffalgo=",9)==0) HandleColon_diff_algo(m);
+  else if( strncmp(m.cbuf,"diffignore=",11)==0) HandleColon_diff_ignore(m);
   else if( strcmp( m.cbuf,"rediff")==0) ReDiff(m);
   else if( strcmp( m.cbuf,"nodiff")==0)m.vis.NoDiff();
   else if( strcmp( m.cbuf,"n"   )==0 ) GoToNextBuffer(m);
@@ -3707,6 +3831,7 @@ void Handle_Colon_Cmd( Vis::Data& m )
   else if( strcmp( m.cbuf,"sh"  )==0
         || strcmp( m.cbuf,"shell")==0) { GoToShellBuffer(m); }
   else if( strcmp( m.cbuf,"run" )==0 ) { RunCommand(m); }
+  else if( strcmp( m.cbuf,"jobs")==0 ) { HandleColon_jobs(m); }
   else if( strncmp(m.cbuf,"re",2)==0 ) { Console::Refresh(); }
   else if( strcmp( m.cbuf,"map" )==0 )    MapStart(m);
   else if( strcmp( m.cbuf,"showmap")==0)  MapShow(m);
@@ -3722,9 +3847,14 @@ void Handle_Colon_Cmd( Vis::Data& m )
   else if( strcmp( m.cbuf,"commentall")==0)  HandleColon_commentAll(m);
   else if( strcmp( m.cbuf,"uncommentall")==0)HandleColon_uncommentAll(m);
   else if( strcmp( m.cbuf,"strip")==0)    HandleColon_strip_escape_seqs(m);
+  else if( strcmp( m.cbuf,"perf")==0)     HandleColon_perf(m);
+  else if( strcmp( m.cbuf,"perfclear")==0)HandleColon_perf_clear(m);
   else if( strncmp(m.cbuf,"dec=",4)==0 )  HandleColon_decoding(m);
   else if( strncmp(m.cbuf,"enc=",4)==0 )  HandleColon_encoding(m);
   else if( strncmp(m.cbuf,"ts=",3)==0 )   HandleColon_tab_size(m);
+  else if( strncmp(m.cbuf,"hl=",3)==0 )   HandleColon_hi_line_len(m);
+  else if( strncmp(m.cbuf,"maxlines=",9)==0 ) HandleColon_max(m, true);
+  else if( strncmp(m.cbuf,"maxbytes=",9)==0 ) HandleColon_max(m, false);
   else if( 'e' == m.cbuf[0] )             HandleColon_e(m);
   else if( 'w' == m.cbuf[0] )             HandleColon_w(m);
   else if( 'b' == m.cbuf[0] )             HandleColon_b(m);
@@ -5631,7 +5761,9 @@ void Window_Message( Vis::Data& m, const char* const msg )
   View* pV = m.views[m.win][MSG_FILE];
   pV->Clear_Context();
 
-  GoToMsgBuffer(m);
+  // Already in Message Buffer, so just show the new message:
+  if( MSG_FILE == m.file_hist[m.win][0] ) pV->Update();
+  else                                    GoToMsgBuffer(m);
 }
 
 Vis::Vis()
@@ -5710,6 +5842,9 @@ void Vis::Run()
   {
     Handle_Cmd( m );
 
+    // Re-align the diff hunk around any lines the command inserted or deleted:
+    if( InDiffMode() ) m.diff.ReAlign();
+
     // Handle focus time and sorting buffer editor:
     View* cv = CV();
     if( cv != m.cv_old )
@@ -5797,9 +5932,19 @@ void Vis::NoDiff()
   UpdateViews( false );
 }
 
-bool Vis::Shell_Running() const
+bool Vis::Shell_Running( const FileBuf* pfb ) const
+{
+  return m.shell.Running( pfb );
+}
+
+int Vis::Shell_Fd( const unsigned job ) const
+{
+  return m.shell.Fd( job );
+}
+
+double Vis::Shell_Draw_Time() const
 {
-  return m.shell.Running();
+  return m.shell.Draw_Time();
 }
 
 bool Vis::GetSortByTime() const
@@ -5935,7 +6080,8 @@ void Vis::Add_FileBuf_2_Lists_Create_Views( FileBuf* pfb, const char* fname )
    && strcmp( fname,  MSG__BUF_NAME )
    && strcmp( fname, SHELL_BUF_NAME )
    && strcmp( fname, COLON_BUF_NAME )
-   && strcmp( fname, SLASH_BUF_NAME ) )
+   && strcmp( fname, SLASH_BUF_NAME )
+   && strncmp( fname, JOB_BUF_NAME, strlen( JOB_BUF_NAME ) ) )
   {
     NotHaveFileAddFile( pfb->GetDirName() );
   }
@@ -6082,6 +6228,44 @@ bool Vis::Update_Change_Statuses()
   return updated_change_sts;
 }
 
+// Called when waiting for user input.  Finds styles and regexs beyond
+// what is displayed, so that paging through a file does not stall on
+// lines not yet highlighted.  Does one small slice of work, so input
+// can be checked between slices.
+// Returns true if a slice of work was done, else false.
+bool Vis::Idle_Look_Ahead()
+{
+  Trace trace( __PRETTY_FUNCTION__ );
+
+  const unsigned STYLE_LINES = 200; // Max lines highlighted per slice
+  const unsigned REGEX_LINES = 100; // Max lines searched per slice
+  const unsigned LOOK_PAGES  = 10;  // Pages looked at above and below view
+
+  // First, look ahead of and behind the displayed views:
+  for( unsigned w=0; w<m.num_wins; w++ )
+  {
+    View* const    pV  = GetView_Win( m, w );
+    FileBuf* const pfb = pV->GetFB();
+
+    const unsigned TOP  = pV->GetInDiff() ? m.diff.GetTopLine( pV )
+                                          : pV->GetTopLine();
+    const unsigned SPAN = LOOK_PAGES * pV->WorkingRows();
+    const unsigned ST   = SPAN < TOP ? TOP-SPAN : 0;
+    const unsigned FN   = TOP + pV->WorkingRows() + SPAN;
+
+    if( pfb->Find_Styles_Idle( FN, STYLE_LINES )
+     || pfb->Find_Regexs_Idle( ST, FN-ST, REGEX_LINES ) ) return true;
+  }
+  // Then, highlight the rest of the displayed files:
+  for( unsigned w=0; w<m.num_wins; w++ )
+  {
+    FileBuf* const pfb = GetView_Win( m, w )->GetFB();
+
+    if( pfb->Find_Styles_Idle( pfb->NumLines(), STYLE_LINES ) ) return true;
+  }
+  return false;
+}
+
 void Vis::PrintCursor()
 {
   Trace trace( __PRETTY_FUNCTION__ );
@@ -6152,15 +6336,25 @@ bool Vis::File_Is_Displayed( const String& full_fname )
   return false;
 }
 
-void Vis::ReleaseFileName( const String& full_fname )
+// Returns true if full_fname was released.
+// A job buffer is not released, because its job keeps writing to it.
+bool Vis::ReleaseFileName( const String& full_fname )
 {
   Trace trace( __PRETTY_FUNCTION__ );
 
   unsigned file_num = 0;
   if( FName_2_FNum( m, full_fname, file_num ) )
   {
-    ::ReleaseFileNum( m, file_num );
+    if( m.shell.Is_Job_Buf( m.views[0][ file_num ]->GetFB() ) )
+    {
+      CmdLineMessage("Can not release job buffer: %s", full_fname.c_str() );
+    }
+    else {
+      ::ReleaseFileNum( m, file_num );
+      return true;
+    }
   }
+  return false;
 }
 
 bool GetFullFileNameRelative2CurrFile( Vis::Data& m, String& fname )
@@ -6464,6 +6658,7 @@ int main( int argc, char* argv[] )
 
     Trace  ::Cleanup();
     Console::Cleanup();
+    Highlight_Base::Cleanup();
   }
   MemClean();
   Log.Dump();
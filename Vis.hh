@@ -50,7 +50,9 @@ public:
   void        NoDiff();
   bool        InDiffMode() const;
   bool        RunningDot() const;
-  bool        Shell_Running() const;
+  bool        Shell_Running( const FileBuf* pfb ) const;
+  int         Shell_Fd( const unsigned job ) const;
+  double      Shell_Draw_Time() const;
   bool        GetSortByTime() const;
   void        Update_Shell();
   FileBuf*    GetFileBuf( const unsigned index ) const;
@@ -67,11 +69,12 @@ public:
   void UpdateViews( const bool show_search );
   bool Update_Status_Lines();
   bool Update_Change_Statuses();
+  bool Idle_Look_Ahead();
   void PrintCursor();
   bool HaveFile( const char* path_name, unsigned* file_index=0 );
   bool NotHaveFileAddFile( const String& pname );
   bool File_Is_Displayed( const String& full_fname );
-  void ReleaseFileName( const String& full_fname );
+  bool ReleaseFileName( const String& full_fname );
   bool GoToBuffer_Fname( String& fname );
   void Handle_f();
   void L_Handle_f();
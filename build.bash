@@ -13,7 +13,7 @@ DEBUG= #-g
 OS=LINUX
 DEFINES= #-DUSE_REGEX
 CXXFLAGS="-c -O ${DEBUG} -D${OS} ${DEFINES}"
-LIBS=-lm
+LIBS="-lm -lpthread"
 LIB_PATHS=
 
 DOT_O_DIR=OBJS/$OS
@@ -22,14 +22,14 @@ PP_DIR=PP/$OS
 
 CLASS_DIR=classes_fx
 
-FILES='ChangeHist Console_Unix Cover_Array Diff FileBuf
-       Highlight_Base Highlight_Bash Highlight_BufferEditor
+FILES='ChangeHist Console_Unix Cover_Array Diff Diff_Engine Dir_Cmp
+       FileBuf Hash Highlight_Base Highlight_Bash Highlight_BufferEditor
        Highlight_CPP Highlight_Code Highlight_Dir Highlight_Go
        Highlight_HTML Highlight_IDL Highlight_JS Highlight_Java
        Highlight_Make Highlight_MIB Highlight_CMake Highlight_ODB
        Highlight_Python Highlight_SQL Highlight_STL Highlight_Swift
        Highlight_TCL Highlight_Text Highlight_XML Key Line LineView
-       MemCheck MemLog Shell String Types Utilities View Vis'
+       MemCheck MemLog Perf Shell String Types Utilities View Vis'
 
 DOT_O_FILES=
 